@@ -0,0 +1,101 @@
+#include "../src/assembly.h"
+#include "../src/parallel.h"
+
+/** @file
+*	A benchmark for the incremental assembly on a large source.
+*   It generates a source of N instruction and data lines, then edits one line of it at a time, the way a source is saved under --watch.
+*   Every version is assembled from scratch and incrementally, with the line cache of the version before it, and both are timed.
+*   The time of the incremental assembly includes loading and saving the cache.
+*/
+
+#define BENCH_SOURCE_NAME "bench_incremental"
+#define BENCH_SOURCE_PATH "bench_incremental.as"
+#define BENCH_AM_PATH "bench_incremental.am"
+#define BENCH_CACHE_PATH "bench_incremental.cache"
+#define BENCH_DEFAULT_LINES 20000
+#define BENCH_DEFAULT_EDITS 40
+#define BENCH_LINE_LENGTH 64
+
+/* The lines are made from these formats, the index of a line in the thousands and its thousands, so few lines have the same text, like the lines of
+*  a real source. They have no labels and mostly long operands, the lines whose preparation costs the most against the merge, which the cache doesn't save. */
+static char* bench_formats[] = {
+    ".data %d,-2,3,4,5,-6,7,8,9,10,11,12,-13,14,15,%d", ".string \"the quick brown fox %d jumps over the lazy dog %d\"", ".data %d,-9,15,7,-3,22,100,-200,300,-400,%d",
+    "mov #%d, r7", "cmp r1, #%d", "add #%d, r3", "sub r1, r4"
+};
+
+static unsigned long bench_random_state = 1;
+
+static int bench_random(int max)
+{
+    bench_random_state = bench_random_state * 1103515245UL + 12345UL;
+    return (int)((bench_random_state >> 16) % (unsigned long)max);
+}
+
+static void make_line(int index, char* line)
+{
+    sprintf(line, bench_formats[bench_random(sizeof(bench_formats) / sizeof(bench_formats[0]))], index % 1000, index / 1000);
+}
+
+static void write_source(char* lines, int count)
+{
+    FILE* out = fopen(BENCH_SOURCE_PATH, MODE_WRITE);
+    int i;
+
+    for (i = 0; i < count; i++)
+        fprintf(out, "%s\n", lines + i * BENCH_LINE_LENGTH);
+    fclose(out);
+}
+
+static double assemble(bool is_incremental)
+{
+    Assembly* assembly = assembly_new(BENCH_SOURCE_NAME, 1, 0);
+    double begin;
+
+    /* The outputs are held and dropped with the store, the files sink only keeps the line cache on. */
+    assembly_defer_outputs(assembly, output_sink_get_files());
+    assembly_set_incremental(assembly, is_incremental);
+
+    begin = parallel_get_time();
+    assembly_run(assembly);
+    begin = parallel_get_time() - begin;
+
+    assembly_destroy(&assembly);
+    return begin;
+}
+
+int main(int argc, char** argv)
+{
+    int count = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_LINES, edits = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_EDITS, i;
+    double full_seconds = 0, incremental_seconds = 0;
+    char* lines;
+
+    if (count < 1 || edits < 1) {
+        printf("Usage: ./bench_incremental [lines] [edits]\n");
+        return 1;
+    }
+
+    lines = (char*)xcalloc(count, BENCH_LINE_LENGTH);
+    for (i = 0; i < count; i++)
+        make_line(i, lines + i * BENCH_LINE_LENGTH);
+
+    /* The first version makes the cache. */
+    remove(BENCH_CACHE_PATH);
+    write_source(lines, count);
+    assemble(TRUE);
+
+    for (i = 0; i < edits; i++) {
+        make_line(count + i, lines + bench_random(count) * BENCH_LINE_LENGTH);
+        write_source(lines, count);
+
+        full_seconds += assemble(FALSE);
+        incremental_seconds += assemble(TRUE);
+    }
+
+    printf("%d lines, %d versions: full %.2f ms/run, incremental %.2f ms/run\n", count, edits, full_seconds * 1000 / edits, incremental_seconds * 1000 / edits);
+
+    remove(BENCH_SOURCE_PATH);
+    remove(BENCH_AM_PATH);
+    remove(BENCH_CACHE_PATH);
+    free(lines);
+    return 0;
+}
@@ -0,0 +1,192 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/file_store.h"
+#include "../src/uring_io.h"
+#include "../src/parallel.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+/** @file
+*	A benchmark for the file I/O of a batch of many small sources.
+*   It reads and writes N files one at a time on the stdio path the stores use, then in batches on io_uring, the way the reader and the writer of a batch do.
+*   The files are in the page cache, so it measures the cost of the system calls rather than of the disk.
+*/
+
+#define BENCH_DEFAULT_FILES 5000
+#define BENCH_DEFAULT_SIZE 600
+#define BENCH_BATCH 64
+#define BENCH_PATH_LENGTH 64
+#define BENCH_LINE "MAIN: mov r3 ,LENGTH\n"
+
+static char** make_paths(char* dir, int count, char* extension)
+{
+    char** paths = (char**)xcalloc(count, sizeof(char*));
+    int i;
+
+    for (i = 0; i < count; i++) {
+        paths[i] = (char*)xcalloc(BENCH_PATH_LENGTH + strlen(dir), sizeof(char));
+        sprintf(paths[i], "%s/f%d%s", dir, i, extension);
+    }
+
+    return paths;
+}
+
+/* Both writers create the outputs, truncating the files of the other one would cost more. */
+static void remove_files(char** paths, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        remove(paths[i]);
+}
+
+static void free_paths(char** paths, int count)
+{
+    int i;
+
+    remove_files(paths, count);
+    for (i = 0; i < count; i++)
+        free(paths[i]);
+    free(paths);
+}
+
+static void report(char* name, int count, size_t size, double seconds)
+{
+    printf("%-16s %6d files %9.1f ms %10.0f files/s %8.1f MB/s\n", name, count, seconds * 1000, count / seconds,
+           (double)size * count / seconds / (1024 * 1024));
+}
+
+/* The reader without io_uring, every source is loaded by its own store. */
+static bool bench_stdio_read(char** paths, int count)
+{
+    FileStore* store;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        store = file_store_new(FALSE, output_sink_get_files());
+        if (!file_store_load(store, paths[i]))
+            return FALSE;
+        file_store_destroy(&store);
+    }
+
+    return TRUE;
+}
+
+/* The writer without io_uring, the same calls as the flush of a store. */
+static bool bench_stdio_write(char** paths, int count, char* data, size_t size)
+{
+    FILE* out;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (!(out = open_file(paths[i], MODE_WRITE)))
+            return FALSE;
+        fwrite(data, sizeof(char), size, out);
+        if (fclose(out) != 0)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static bool bench_uring_read(UringIO* uring, char** paths, int count, char* expected, size_t size)
+{
+    FileBuffer files[BENCH_BATCH];
+    bool is_read = TRUE;
+    int i, j, chunk;
+
+    for (i = 0; i < count; i += chunk) {
+        chunk = (count - i < BENCH_BATCH) ? count - i : BENCH_BATCH;
+        for (j = 0; j < chunk; j++)
+            files[j].path = paths[i + j];
+
+        if (uring_io_read_files(uring, files, chunk) != chunk)
+            is_read = FALSE;
+
+        for (j = 0; j < chunk; j++) {
+            if (files[j].is_done && (files[j].size != size || memcmp(files[j].data, expected, size) != 0))
+                is_read = FALSE;
+            if (files[j].is_done)
+                free(files[j].data);
+        }
+    }
+
+    return is_read;
+}
+
+static bool bench_uring_write(UringIO* uring, char** paths, int count, char* data, size_t size)
+{
+    FileBuffer files[BENCH_BATCH];
+    bool is_written = TRUE;
+    int i, j, chunk;
+
+    for (i = 0; i < count; i += chunk) {
+        chunk = (count - i < BENCH_BATCH) ? count - i : BENCH_BATCH;
+        for (j = 0; j < chunk; j++) {
+            files[j].path = paths[i + j];
+            files[j].data = data;
+            files[j].size = size;
+        }
+
+        if (uring_io_write_files(uring, files, chunk) != chunk)
+            is_written = FALSE;
+    }
+
+    return is_written;
+}
+
+int main(int argc, char** argv)
+{
+    int count = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_FILES;
+    size_t size = (argc > 2) ? (size_t)atoi(argv[2]) : BENCH_DEFAULT_SIZE, i;
+    char dir[] = "/tmp/bench_io_XXXXXX";
+    char** sources, **outputs;
+    char* data;
+    UringIO* uring;
+    double begin;
+    bool is_ok;
+
+    if (count <= 0 || !mkdtemp(dir)) {
+        printf("Usage: ./bench_io [files] [size]\n");
+        return 1;
+    }
+
+    data = (char*)xcalloc(size + 1, sizeof(char));
+    for (i = 0; i < size; i++)
+        data[i] = BENCH_LINE[i % strlen(BENCH_LINE)];
+
+    sources = make_paths(dir, count, SRC_ASSEMBLER_FILE_EXTENSTION);
+    outputs = make_paths(dir, count, PRE_ASSEMBLER_FILE_EXTENSTION);
+    bench_stdio_write(sources, count, data, size);
+
+    begin = parallel_get_time();
+    is_ok = bench_stdio_read(sources, count);
+    report(is_ok ? "stdio read" : "stdio read FAIL", count, size, parallel_get_time() - begin);
+
+    begin = parallel_get_time();
+    is_ok = bench_stdio_write(outputs, count, data, size);
+    report(is_ok ? "stdio write" : "stdio write FAIL", count, size, parallel_get_time() - begin);
+
+    if ((uring = uring_io_new())) {
+        begin = parallel_get_time();
+        is_ok = bench_uring_read(uring, sources, count, data, size);
+        report(is_ok ? "io_uring read" : "io_uring read FAIL", count, size, parallel_get_time() - begin);
+
+        remove_files(outputs, count);
+        begin = parallel_get_time();
+        is_ok = bench_uring_write(uring, outputs, count, data, size);
+        report(is_ok ? "io_uring write" : "io_uring write FAIL", count, size, parallel_get_time() - begin);
+
+        uring_io_destroy(&uring);
+    }
+    else {
+        printf("io_uring isn't available\n");
+    }
+
+    free_paths(sources, count);
+    free_paths(outputs, count);
+    rmdir(dir);
+    free(data);
+
+    return 0;
+}
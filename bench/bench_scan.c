@@ -0,0 +1,117 @@
+#include "../src/char_scanner.h"
+#include "../src/line_iterator.h"
+#include <time.h>
+#include <ctype.h>
+
+/** @file
+*	A microbenchmark for the LineIterator scanning routines.
+*   It compares the character at a time loops the LineIterator used before the char_scanner, against the char_scanner.
+*/
+
+#define BENCH_ITERATIONS 200000
+#define BENCH_LINE_PADDING 64
+
+/* A mix of the line shapes the passes tokenize, some padded with blanks like generated sources usually are. */
+static char* bench_lines[] = {
+    "MAIN: mov r3 ,LENGTH",
+    "LOOP: jmp L1(#-1,r6)",
+    "        prn #-5",
+    "bne W(r4,r5)",
+    "LENGTH: .data 6,-9,15, 22, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16",
+    "STR: .string \"abcdefghijklmnopqrstuvwxyz\"",
+    "                                                      END: stop",
+    "; A comment line that is long enough to span a few vector registers."
+};
+
+#define BENCH_LINES_COUNT (sizeof(bench_lines) / sizeof(bench_lines[0]))
+
+/* The loops below are the LineIterator's original, char at a time, implementation. */
+
+static char* legacy_skip_blanks(char* str)
+{
+    LineIterator it;
+
+    line_iterator_put_line(&it, str);
+    while (isspace(line_iterator_peek(&it)))
+        line_iterator_advance(&it);
+    return it.current;
+}
+
+static bool legacy_match_any(LineIterator* it, char* seps)
+{
+    while (*seps) {
+        if (line_iterator_peek(it) == *seps)
+            return TRUE;
+        seps++;
+    }
+
+    return line_iterator_peek(it) == *seps;
+}
+
+static char* legacy_find_any(char* str, char* seps)
+{
+    LineIterator it;
+
+    line_iterator_put_line(&it, str);
+    while (!line_iterator_is_end(&it) && !legacy_match_any(&it, seps))
+        line_iterator_advance(&it);
+    return it.current;
+}
+
+/* Walks every word of every line, the same way line_iterator_next_word () does, and returns a checksum so the work can't be optimized away. */
+static unsigned long bench_scan_lines(char** lines, bool use_legacy)
+{
+    unsigned long checksum = 0;
+    char* current;
+    size_t i;
+
+    for (i = 0; i < BENCH_LINES_COUNT; i++) {
+        current = lines[i];
+
+        while (*current) {
+            current = use_legacy ? legacy_skip_blanks(current) : char_scanner_skip_blanks(current);
+            current = use_legacy ? legacy_find_any(current, ",() ") : char_scanner_find_any(current, ",() ");
+            checksum += (unsigned long)(current - lines[i]);
+
+            if (*current)
+                current++;
+        }
+    }
+
+    return checksum;
+}
+
+static void bench_report(char* name, char** lines, bool use_legacy, unsigned long expected)
+{
+    clock_t start = clock();
+    unsigned long checksum = 0;
+    long i;
+
+    for (i = 0; i < BENCH_ITERATIONS; i++)
+        checksum += bench_scan_lines(lines, use_legacy);
+
+    printf("%-8s %8.3f sec %s\n", name, (double)(clock() - start) / CLOCKS_PER_SEC, (checksum == expected) ? "" : "(checksum mismatch !)");
+}
+
+int main()
+{
+    char* lines[BENCH_LINES_COUNT];
+    unsigned long expected;
+    size_t i;
+
+    /* Copy the lines to the heap, with blanks in front of them, the same way get_line () hands them to the passes. */
+    for (i = 0; i < BENCH_LINES_COUNT; i++) {
+        lines[i] = (char*)xcalloc(strlen(bench_lines[i]) + BENCH_LINE_PADDING + 1, sizeof(char));
+        memset(lines[i], SPACE_CHAR, BENCH_LINE_PADDING * (i % 2));
+        strcat(lines[i], bench_lines[i]);
+    }
+
+    expected = bench_scan_lines(lines, TRUE) * BENCH_ITERATIONS;
+    bench_report("legacy", lines, TRUE, expected);
+    bench_report("scanner", lines, FALSE, expected);
+
+    for (i = 0; i < BENCH_LINES_COUNT; i++)
+        free(lines[i]);
+
+    return 0;
+}
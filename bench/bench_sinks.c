@@ -0,0 +1,82 @@
+#include "../src/assembly.h"
+#include "../src/parallel.h"
+
+/** @file
+*	A benchmark for the cost of the outputs of an assembly.
+*   It assembles a source N times writing the outputs to the disk, then keeping them in a memory sink, then discarding them in the null sink.
+*   The null sink measures the assembly and the encoding of the outputs alone, the difference to the other sinks is the cost of where they end up.
+*/
+
+#define BENCH_DEFAULT_RUNS 200
+#define BENCH_DEFAULT_JOBS 1
+#define BENCH_OUTPUTS_COUNT 4
+
+static char* bench_outputs[BENCH_OUTPUTS_COUNT] = { PRE_ASSEMBLER_FILE_EXTENSTION, OBJECT_ASSEMBLER_FILE_EXTENSTION, ENTRY_ASSEMBLER_FILE_EXTENSTION, EXTERN_ASSEMBLER_FILE_EXTENSTION };
+
+static void remove_outputs(char* name)
+{
+    char* path;
+    int i;
+
+    for (i = 0; i < BENCH_OUTPUTS_COUNT; i++) {
+        path = get_outfile_name(name, bench_outputs[i]);
+        remove(path);
+        free(path);
+    }
+}
+
+/* Assembles the source the given amount of times, a NULL sink writes the outputs to the disk as they are made, the same as the command line. */
+static bool bench_sink(char* name, int runs, int jobs, OutputSink* sink)
+{
+    Assembly* assembly;
+    bool is_ok = TRUE;
+    int i;
+
+    for (i = 0; i < runs; i++) {
+        assembly = assembly_new(name, jobs, 0);
+        if (sink)
+            assembly_defer_outputs(assembly, sink);
+
+        if (!assembly_run(assembly) || !assembly_write_outputs(assembly))
+            is_ok = FALSE;
+        assembly_destroy(&assembly);
+    }
+
+    return is_ok;
+}
+
+static void report(char* name, bool is_ok, int runs, double seconds)
+{
+    printf("%-8s%s %6d runs %9.1f ms %8.1f us/run\n", name, is_ok ? "" : " FAIL", runs, seconds * 1000, seconds * 1000000 / runs);
+}
+
+int main(int argc, char** argv)
+{
+    int runs = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_RUNS, jobs = (argc > 3) ? atoi(argv[3]) : BENCH_DEFAULT_JOBS;
+    OutputSink* memory;
+    double begin;
+    bool is_ok;
+
+    if (argc < 2 || runs < 1 || jobs < 1) {
+        printf("Usage: ./bench_sinks <source.as> [runs] [jobs]\n");
+        return 1;
+    }
+
+    begin = parallel_get_time();
+    is_ok = bench_sink(argv[1], runs, jobs, NULL);
+    report("files", is_ok, runs, parallel_get_time() - begin);
+    remove_outputs(argv[1]);
+
+    /* A single memory sink holds the outputs of all the runs, the way an embedder would collect them. */
+    memory = output_sink_new_memory();
+    begin = parallel_get_time();
+    is_ok = bench_sink(argv[1], runs, jobs, memory);
+    report("memory", is_ok, runs, parallel_get_time() - begin);
+    output_sink_destroy(&memory);
+
+    begin = parallel_get_time();
+    is_ok = bench_sink(argv[1], runs, jobs, output_sink_get_null());
+    report("null", is_ok, runs, parallel_get_time() - begin);
+
+    return 0;
+}
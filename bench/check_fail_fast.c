@@ -0,0 +1,91 @@
+#include "../src/assembly.h"
+#include "../src/line_cache.h"
+
+/** @file
+*	A check of the errors limit on a source that the first pass splits into chunks.
+*   The source has an error on its first line and many valid lines after it. Once the limit is reached the merge stops, so the chunks
+*   must stop preparing lines too. The lines a run prepared are the ones it writes to the line cache, so the cache shows how far the chunks went.
+*/
+
+#define CHECK_SOURCE_PATH "check_fail_fast.as"
+#define CHECK_AM_PATH "check_fail_fast.am"
+#define CHECK_CACHE_PATH "check_fail_fast.cache"
+#define CHECK_LINES_COUNT 20000
+#define CHECK_LINE_LENGTH 32
+
+static void make_line(int index, char* line)
+{
+    sprintf(line, "L%d: sub r1, r4", index);
+}
+
+static void write_source(void)
+{
+    FILE* out = fopen(CHECK_SOURCE_PATH, MODE_WRITE);
+    char line[CHECK_LINE_LENGTH];
+    int i;
+
+    fprintf(out, "mov r1\n");
+    for (i = 0; i < CHECK_LINES_COUNT; i++) {
+        make_line(i, line);
+        fprintf(out, "%s\n", line);
+    }
+    fclose(out);
+}
+
+/* Assembles the source with a fresh cache, returns the amount of its valid lines that were prepared. */
+static int prepared_lines(int jobs, int max_errors, int* errors_count)
+{
+    Assembly* assembly = assembly_new(CHECK_SOURCE_PATH, jobs, max_errors);
+    LineCache* cache = line_cache_new();
+    char line[CHECK_LINE_LENGTH];
+    int i, count = 0;
+
+    remove(CHECK_CACHE_PATH);
+    assembly_defer_outputs(assembly, output_sink_get_files());
+    assembly_set_incremental(assembly, TRUE);
+    assembly_run(assembly);
+    *errors_count = debug_list_get_errors_count(assembly_get_debug_list(assembly));
+    assembly_destroy(&assembly);
+
+    /* A run that prepared no valid line writes no cache. */
+    if (line_cache_load(cache, CHECK_CACHE_PATH)) {
+        for (i = 0; i < CHECK_LINES_COUNT; i++) {
+            make_line(i, line);
+            if (line_cache_find(cache, line))
+                count++;
+        }
+    }
+
+    line_cache_destroy(&cache);
+    return count;
+}
+
+static bool check_jobs(int jobs, int limit)
+{
+    int full_errors, limited_errors, full = prepared_lines(jobs, 0, &full_errors), limited = prepared_lines(jobs, 1, &limited_errors);
+    bool is_ok = (full == CHECK_LINES_COUNT && limited <= limit && limited_errors == 1) ? TRUE : FALSE;
+
+    printf("--jobs %d: %5d of %d lines prepared without a limit (%d errors), %5d with --max-errors 1 (%d errors) %s\n",
+           jobs, full, CHECK_LINES_COUNT, full_errors, limited, limited_errors, is_ok ? "ok" : "FAILED");
+    return is_ok;
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    write_source();
+
+    /* The chunk of the error stops right after it. The chunks after it stop once they see it, how many lines they prepared before depends on
+    *  when their threads started, so only the lines of the first chunk are sure to be skipped. */
+    if (!check_jobs(1, 0))
+        failures++;
+    if (!check_jobs(4, CHECK_LINES_COUNT - CHECK_LINES_COUNT / 4))
+        failures++;
+
+    remove(CHECK_SOURCE_PATH);
+    remove(CHECK_AM_PATH);
+    remove(CHECK_CACHE_PATH);
+    printf("%s\n", failures ? "FAILED" : "the chunks stop at the errors limit");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,278 @@
+#include "../src/assembly.h"
+#include "../src/first_pass.h"
+#include <time.h>
+
+/** @file
+*	A check of the incremental assembly against the full assembly.
+*   A source is edited one line at a time (a line is removed, copied, moved or replaced by another line), and every version is assembled
+*   both from scratch and incrementally, with the line cache of the version before it. The two must report the same diagnostics and make the same outputs.
+*   Both are timed, the time of the incremental assembly includes loading and saving the cache.
+*   A source is padded with FIRST_PASS_MIN_CACHED_LINES declarations of unused externals, the first pass ignores the cache for a smaller source.
+*   The padding doesn't change the outputs, and only the lines of the source are edited.
+*/
+
+#define CHECK_SOURCE_PATH "check_incremental.as"
+#define CHECK_CACHE_PATH "check_incremental.cache"
+#define CHECK_DEFAULT_EDITS 200
+#define CHECK_EDIT_KINDS 4
+#define CHECK_OUTPUTS_COUNT 4
+#define CHECK_PADDING_FORMAT ".extern CheckPadding%d"
+#define CHECK_PADDING_LENGTH 32
+
+static char* check_outputs[CHECK_OUTPUTS_COUNT] = { ".am", OBJECT_ASSEMBLER_FILE_EXTENSTION, ENTRY_ASSEMBLER_FILE_EXTENSTION, EXTERN_ASSEMBLER_FILE_EXTENSTION };
+
+static unsigned long check_random_state = 1;
+
+static int check_random(int max)
+{
+    check_random_state = check_random_state * 1103515245UL + 12345UL;
+    return (int)((check_random_state >> 16) % (unsigned long)max);
+}
+
+typedef struct
+{
+    char** lines; /* Owned copies. */
+    int count;
+    int capacity;
+} sourceLines;
+
+typedef struct
+{
+    bool succeeded;
+    char* diagnostics;
+    long diagnostics_size;
+    FileBuffer outputs[CHECK_OUTPUTS_COUNT]; /* Copies, 'data' is NULL if the output wasn't made. */
+} assemblyResult;
+
+static void lines_insert(sourceLines* source, int index, char* text)
+{
+    if (source->count + 1 >= source->capacity) {
+        source->capacity *= 2;
+        source->lines = (char**)xrealloc(source->lines, source->capacity * sizeof(char*));
+    }
+
+    memmove(source->lines + index + 1, source->lines + index, (source->count - index) * sizeof(char*));
+    source->lines[index] = get_copy_string(text);
+    source->count++;
+}
+
+static void lines_remove(sourceLines* source, int index)
+{
+    free(source->lines[index]);
+    memmove(source->lines + index, source->lines + index + 1, (source->count - index - 1) * sizeof(char*));
+    source->count--;
+}
+
+static bool lines_read(char* path, sourceLines* source)
+{
+    FILE* in = fopen(path, MODE_READ);
+    char line[SOURCE_LINE_MAX_LENGTH * 4];
+
+    if (!in)
+        return FALSE;
+
+    source->count = 0;
+    source->capacity = INIT_PHY_SZ;
+    source->lines = (char**)xcalloc(source->capacity, sizeof(char*));
+
+    while (fgets(line, sizeof(line), in)) {
+        line[strcspn(line, "\n")] = '\0';
+        lines_insert(source, source->count, line);
+    }
+
+    fclose(in);
+    return TRUE;
+}
+
+static void lines_write(char* path, sourceLines* source)
+{
+    FILE* out = fopen(path, MODE_WRITE);
+    int i;
+
+    for (i = 0; i < source->count; i++)
+        fprintf(out, "%s\n", source->lines[i]);
+    fclose(out);
+}
+
+static void lines_free(sourceLines* source)
+{
+    while (source->count > 0)
+        lines_remove(source, source->count - 1);
+    free(source->lines);
+}
+
+/* Pads the source, the padding alone has the lines the cache is used for whatever the pre-assembler removes from the source. Returns the amount of lines that were added. */
+static int lines_pad(sourceLines* source)
+{
+    char line[CHECK_PADDING_LENGTH];
+    int padding;
+
+    for (padding = 0; padding < FIRST_PASS_MIN_CACHED_LINES; padding++) {
+        sprintf(line, CHECK_PADDING_FORMAT, padding);
+        lines_insert(source, source->count, line);
+    }
+
+    return padding;
+}
+
+/* A single edit, the way a line is usually changed in an editor. The 'padding' lines at the end are left as they are. */
+static void edit_lines(sourceLines* source, int padding)
+{
+    int count = source->count - padding, from = check_random(count), to = check_random(count);
+    char* text;
+
+    switch (check_random(CHECK_EDIT_KINDS)) {
+    case 0: /* Remove a line, but keep at least one. */
+        if (count > 1)
+            lines_remove(source, from);
+        break;
+    case 1: /* Copy a line. */
+        lines_insert(source, to, source->lines[from]);
+        break;
+    case 2: /* Move a line. */
+        text = get_copy_string(source->lines[from]);
+        lines_remove(source, from);
+        lines_insert(source, to % count, text);
+        free(text);
+        break;
+    default: /* Replace a line by another one. */
+        text = get_copy_string(source->lines[from]);
+        lines_remove(source, to);
+        lines_insert(source, to, text);
+        free(text);
+        break;
+    }
+}
+
+static double assemble(bool is_incremental, assemblyResult* result)
+{
+    Assembly* assembly = assembly_new(CHECK_SOURCE_PATH, 1, 0);
+    FILE* diagnostics = tmpfile();
+    FileBuffer file;
+    char* path;
+    clock_t start;
+    int i;
+
+    /* The outputs are held and dropped with the store, the files sink only keeps the line cache on. */
+    assembly_defer_outputs(assembly, output_sink_get_files());
+    assembly_set_incremental(assembly, is_incremental);
+
+    start = clock();
+    result->succeeded = assembly_run(assembly);
+    start = clock() - start;
+
+    debug_list_flush(assembly_get_debug_list(assembly), diagnostics, DIAG_FORMAT_TEXT);
+    result->diagnostics_size = ftell(diagnostics);
+    result->diagnostics = (char*)xcalloc(result->diagnostics_size + 1, sizeof(char));
+    rewind(diagnostics);
+    result->diagnostics_size = (long)fread(result->diagnostics, sizeof(char), result->diagnostics_size, diagnostics);
+    fclose(diagnostics);
+
+    for (i = 0; i < CHECK_OUTPUTS_COUNT; i++) {
+        path = get_outfile_name(CHECK_SOURCE_PATH, check_outputs[i]);
+        result->outputs[i].data = NULL;
+        result->outputs[i].size = 0;
+        if (file_store_get_file(assembly_get_file_store(assembly), path, &file)) {
+            result->outputs[i].data = (char*)xmalloc(file.size + 1);
+            memcpy(result->outputs[i].data, file.data, file.size);
+            result->outputs[i].size = file.size;
+        }
+        free(path);
+    }
+
+    assembly_destroy(&assembly);
+    return (double)start / CLOCKS_PER_SEC;
+}
+
+static bool results_match(assemblyResult* full, assemblyResult* incremental)
+{
+    int i;
+
+    if (full->succeeded != incremental->succeeded || full->diagnostics_size != incremental->diagnostics_size ||
+        memcmp(full->diagnostics, incremental->diagnostics, full->diagnostics_size) != 0)
+        return FALSE;
+
+    for (i = 0; i < CHECK_OUTPUTS_COUNT; i++) {
+        if ((full->outputs[i].data == NULL) != (incremental->outputs[i].data == NULL) || full->outputs[i].size != incremental->outputs[i].size ||
+            (full->outputs[i].data && memcmp(full->outputs[i].data, incremental->outputs[i].data, full->outputs[i].size) != 0))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void result_free(assemblyResult* result)
+{
+    int i;
+
+    free(result->diagnostics);
+    for (i = 0; i < CHECK_OUTPUTS_COUNT; i++)
+        free(result->outputs[i].data);
+}
+
+static bool check_source(char* path, int edits)
+{
+    sourceLines source;
+    assemblyResult full, incremental;
+    double full_seconds = 0, incremental_seconds = 0;
+    int i, mismatches = 0, succeeded = 0, padding;
+
+    if (!lines_read(path, &source) || source.count == 0) {
+        printf("%-40s can't be read\n", path);
+        return FALSE;
+    }
+
+    padding = lines_pad(&source);
+
+    /* The first version starts without a cache. */
+    remove(CHECK_CACHE_PATH);
+    lines_write(CHECK_SOURCE_PATH, &source);
+    assemble(TRUE, &incremental);
+    result_free(&incremental);
+
+    for (i = 0; i < edits; i++) {
+        edit_lines(&source, padding);
+        lines_write(CHECK_SOURCE_PATH, &source);
+
+        full_seconds += assemble(FALSE, &full);
+        incremental_seconds += assemble(TRUE, &incremental);
+
+        if (!results_match(&full, &incremental))
+            mismatches++;
+        if (full.succeeded)
+            succeeded++;
+
+        result_free(&full);
+        result_free(&incremental);
+    }
+
+    printf("%-40s %4d versions (%d assembled) full %.3fs incremental %.3fs %s\n", path, edits, succeeded, full_seconds, incremental_seconds, mismatches ? "MISMATCH" : "ok");
+
+    lines_free(&source);
+    return mismatches == 0;
+}
+
+int main(int argc, char** argv)
+{
+    int i, edits = CHECK_DEFAULT_EDITS, failures = 0, first = 1;
+    char* end = NULL;
+
+    if (argc > 1 && strtol(argv[1], &end, 10) > 0 && *end == '\0') {
+        edits = (int)strtol(argv[1], NULL, 10);
+        first = 2;
+    }
+
+    if (first >= argc) {
+        printf("Usage: ./check_incremental [edits] <sources...>\n");
+        return 1;
+    }
+
+    for (i = first; i < argc; i++)
+        if (!check_source(argv[i], edits))
+            failures++;
+
+    remove(CHECK_SOURCE_PATH);
+    remove(CHECK_CACHE_PATH);
+    printf("%s\n", failures ? "FAILED" : "every version matches");
+    return failures ? 1 : 0;
+}
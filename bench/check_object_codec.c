@@ -0,0 +1,137 @@
+#include "../src/assembly.h"
+#include "../src/second_pass.h"
+#include "../src/object_codec.h"
+
+/** @file
+*	A round trip check of the compact object encoding.
+*   Every image is written both as a text object and as a compact object, and the compact object must decode to the same bytes as the text object.
+*   The images are a set of generated patterns (empty, all zeros, runs around the shortest repeated run, alternating words, random words and full images)
+*   and the sources on the command line. Every truncated compact object must be rejected by the decoder.
+*/
+
+/* The second pass writes the object of the pre-assembled file, next to it. */
+#define CHECK_PATH "check_object.am"
+#define CHECK_OBJECT_PATH "check_object.object"
+#define CHECK_PATTERNS 9
+#define CHECK_WORD_BITS 14
+
+static unsigned long check_random_state = 1;
+
+static unsigned int check_random_word()
+{
+    check_random_state = check_random_state * 1103515245UL + 12345UL;
+    return (unsigned int)((check_random_state >> 16) & ((1 << CHECK_WORD_BITS) - 1));
+}
+
+/* The words of a pattern, 'count' is up to RAM_MEMORY_SZ. */
+static unsigned int pattern_word(int pattern, int index)
+{
+    switch (pattern) {
+    case 0: return 0;
+    case 1: return (unsigned int)((index / 2) % 2); /* Runs of 2, one below the shortest repeated run. */
+    case 2: return (unsigned int)((index / 3) % 2); /* Runs of exactly the shortest repeated run. */
+    case 3: return (index % 2) ? 0x2AAA : 0x1555;
+    case 4: return (index < 10 || index % 50 == 0) ? check_random_word() : 0; /* A zero initialised table with a few values. */
+    default: return check_random_word();
+    }
+}
+
+static void fill_pattern(memoryBuffer* memory, int pattern, int inst_count, int data_count)
+{
+    int i;
+
+    for (i = 0; i < inst_count; i++)
+        img_memory_push_word(memory_buffer_get_inst_img(memory), pattern_word(pattern, i));
+    for (i = 0; i < data_count; i++)
+        img_memory_push_word(memory_buffer_get_data_img(memory), pattern_word(pattern, i));
+}
+
+/* Writes the text object of an image the way the second pass does, into a store that holds it in memory. */
+static bool get_text_object(memoryBuffer* memory, FileStore* store, FileBuffer* text)
+{
+    debugList* dbg_list = debug_list_new_list();
+    bool is_written = generate_object_file(memory, CHECK_PATH, store, dbg_list);
+
+    debug_list_destroy(&dbg_list);
+    return is_written && file_store_get_file(store, CHECK_OBJECT_PATH, text);
+}
+
+static bool check_image(char* name, memoryBuffer* memory)
+{
+    FileStore* store = file_store_new(TRUE, output_sink_get_null());
+    size_t size = object_codec_get_compact_size(memory), decoded_size, i;
+    char* compact = (char*)xmalloc(size + 1), *decoded;
+    bool is_ok = FALSE;
+    FileBuffer text;
+
+    object_codec_encode_compact(memory, compact);
+
+    if (get_text_object(memory, store, &text) && object_codec_decode_compact(compact, size, &decoded, &decoded_size)) {
+        is_ok = (decoded_size == text.size && memcmp(decoded, text.data, text.size) == 0) ? TRUE : FALSE;
+        free(decoded);
+    }
+
+    /* A compact object that is cut short is never a valid object. */
+    for (i = 0; i < size && is_ok; i++) {
+        if (object_codec_decode_compact(compact, i, &decoded, &decoded_size)) {
+            free(decoded);
+            is_ok = FALSE;
+        }
+    }
+
+    printf("%-28s %6lu text bytes %6lu compact bytes %s\n", name, (unsigned long)text.size, (unsigned long)size, is_ok ? "ok" : "MISMATCH");
+
+    free(compact);
+    file_store_destroy(&store);
+    return is_ok;
+}
+
+static bool check_pattern(int pattern, int inst_count, int data_count)
+{
+    memoryBuffer* memory = memory_buffer_get_new();
+    char name[64];
+    bool is_ok;
+
+    sprintf(name, "pattern %d (%d+%d words)", pattern, inst_count, data_count);
+    fill_pattern(memory, pattern, inst_count, data_count);
+    is_ok = check_image(name, memory);
+    memory_buffer_destroy(&memory);
+
+    return is_ok;
+}
+
+static bool check_source(char* path)
+{
+    Assembly* assembly = assembly_new(path, 1, 0);
+    bool is_ok;
+
+    assembly_defer_outputs(assembly, output_sink_get_null());
+    if (!assembly_run(assembly)) {
+        printf("%-28s doesn't assemble\n", path);
+        assembly_destroy(&assembly);
+        return FALSE;
+    }
+
+    is_ok = check_image(path, assembly_get_memory(assembly));
+    assembly_destroy(&assembly);
+
+    return is_ok;
+}
+
+int main(int argc, char** argv)
+{
+    int sizes[][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 2, 2 }, { 3, 3 }, { 40, 200 }, { RAM_MEMORY_SZ, RAM_MEMORY_SZ } };
+    int i, j, failures = 0;
+
+    for (i = 0; i < CHECK_PATTERNS; i++)
+        for (j = 0; j < (int)(sizeof(sizes) / sizeof(sizes[0])); j++)
+            if (!check_pattern(i, sizes[j][0], sizes[j][1]))
+                failures++;
+
+    for (i = 1; i < argc; i++)
+        if (!check_source(argv[i]))
+            failures++;
+
+    printf("%s\n", failures ? "FAILED" : "all round trips match");
+    return failures ? 1 : 0;
+}
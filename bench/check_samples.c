@@ -0,0 +1,137 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/assembly.h"
+#include <ctype.h>
+#include <unistd.h>
+
+/** @file
+*	A check of the sample programs under the 'tests' folder against their expected outputs.
+*   A sample is a folder that holds a source named after the folder in upper case (i.e 'test_macros/TEST_MACROS.as'), the files it includes
+*   and the outputs the assembler is expected to make for it. Every output that is there must be made with the same bytes, and no other output may be made.
+*   A sample that is expected to fail keeps its diagnostics in 'output/diagnostics.txt', as the assembler prints them.
+*   The sources are assembled in their folder, so the diagnostics and the included files are the same as on the command line.
+*/
+
+#define CHECK_OUTPUTS_COUNT 4
+#define CHECK_DIAGNOSTICS_PATH "output/diagnostics.txt"
+#define CHECK_PATH_MAX_LENGTH 4096
+
+static char* check_outputs[CHECK_OUTPUTS_COUNT] = { PRE_ASSEMBLER_FILE_EXTENSTION, OBJECT_ASSEMBLER_FILE_EXTENSTION, ENTRY_ASSEMBLER_FILE_EXTENSTION, EXTERN_ASSEMBLER_FILE_EXTENSTION };
+
+/* Reads a whole file, NULL if it isn't there. */
+static char* read_expected(char* path, long* size)
+{
+    FILE* in = fopen(path, MODE_READ);
+    char* data;
+
+    if (!in)
+        return NULL;
+
+    fseek(in, 0, SEEK_END);
+    *size = ftell(in);
+    rewind(in);
+
+    data = (char*)xcalloc(*size + 1, sizeof(char));
+    *size = (long)fread(data, sizeof(char), *size, in);
+    fclose(in);
+
+    return data;
+}
+
+/* Compares an output of the assembly with the expected file, both may be missing. */
+static bool output_matches(char* expected_path, char* data, size_t size)
+{
+    long expected_size = 0;
+    char* expected = read_expected(expected_path, &expected_size);
+    bool is_matching = (expected == NULL) == (data == NULL) && (!expected || ((size_t)expected_size == size && memcmp(expected, data, size) == 0));
+
+    if (!is_matching)
+        printf("    %s %s\n", expected_path, expected ? (data ? "differs" : "wasn't made") : "wasn't expected");
+
+    free(expected);
+    return is_matching;
+}
+
+/* The name of the source of a sample folder, the last part of its path in upper case. */
+static char* sample_name(char* folder)
+{
+    char* name, * end = folder + strlen(folder), * start;
+    int i;
+
+    while (end > folder && end[-1] == PATH_SEPARATOR_CHAR)
+        end--;
+    for (start = end; start > folder && start[-1] != PATH_SEPARATOR_CHAR; start--);
+
+    name = (char*)xcalloc(end - start + strlen(SRC_ASSEMBLER_FILE_EXTENSTION) + 1, sizeof(char));
+    for (i = 0; start + i < end; i++)
+        name[i] = (char)toupper((unsigned char)start[i]);
+    strcpy(name + i, SRC_ASSEMBLER_FILE_EXTENSTION);
+
+    return name;
+}
+
+static bool check_sample(char* folder)
+{
+    char* name = sample_name(folder), * path, * diagnostics = NULL;
+    FILE* diagnostics_out = NULL;
+    size_t diagnostics_size = 0;
+    Assembly* assembly;
+    FileBuffer file;
+    bool is_matching = TRUE;
+    int i;
+
+    if (chdir(folder) != 0) {
+        printf("%-40s can't be opened\n", folder);
+        free(name);
+        return FALSE;
+    }
+
+    assembly = assembly_new(name, 1, 0);
+    assembly_defer_outputs(assembly, output_sink_get_null());
+    assembly_run(assembly);
+
+    for (i = 0; i < CHECK_OUTPUTS_COUNT; i++) {
+        path = get_outfile_name(name, check_outputs[i]);
+        if (file_store_get_file(assembly_get_file_store(assembly), path, &file))
+            is_matching = output_matches(path, file.data, file.size) && is_matching;
+        else
+            is_matching = output_matches(path, NULL, 0) && is_matching;
+        free(path);
+    }
+
+    /* Only a sample that keeps its diagnostics has them checked, the others are checked by their outputs. */
+    if (access(CHECK_DIAGNOSTICS_PATH, F_OK) == 0) {
+        diagnostics_out = open_memstream(&diagnostics, &diagnostics_size);
+        debug_list_flush(assembly_get_debug_list(assembly), diagnostics_out, DIAG_FORMAT_TEXT);
+        fclose(diagnostics_out);
+        is_matching = output_matches(CHECK_DIAGNOSTICS_PATH, diagnostics, diagnostics_size) && is_matching;
+        free(diagnostics);
+    }
+
+    printf("%-40s %s\n", folder, is_matching ? "ok" : "MISMATCH");
+
+    assembly_destroy(&assembly);
+    free(name);
+    return is_matching;
+}
+
+int main(int argc, char** argv)
+{
+    char start[CHECK_PATH_MAX_LENGTH];
+    int i, failures = 0;
+
+    if (argc < 2 || !getcwd(start, sizeof(start))) {
+        printf("Usage: ./check_samples <sample folders...>\n");
+        return 1;
+    }
+
+    for (i = 1; i < argc; i++) {
+        if (!check_sample(argv[i]))
+            failures++;
+        if (chdir(start) != 0)
+            return 1;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "every sample matches");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+#include "../src/assembly.h"
+#include "../src/parallel.h"
+
+/** @file
+*	A stress test for the reentrancy of the assembler core, meant to be built with ThreadSanitizer.
+*   It assembles one copy of a source on its own, then assembles N copies of it at once on N threads,
+*   and checks that every copy produced the same output files and the same amount of diagnostics as the single run.
+*/
+
+#define STRESS_DEFAULT_COPIES 8
+#define STRESS_DEFAULT_JOBS 2
+#define STRESS_NAME_LENGTH 32
+#define STRESS_OUTPUTS_COUNT 4
+
+static char* stress_outputs[STRESS_OUTPUTS_COUNT] = { PRE_ASSEMBLER_FILE_EXTENSTION, ".object", ENTRY_ASSEMBLER_FILE_EXTENSTION, EXTERN_ASSEMBLER_FILE_EXTENSTION };
+
+typedef struct
+{
+    char name[STRESS_NAME_LENGTH];
+    int jobs;
+    bool succeeded;
+    int diagnostics_count;
+} stressCopy;
+
+/* Reads a whole file, returns NULL if it doesn't exist. */
+static char* read_whole_file(char* path, long* size)
+{
+    FILE* in = fopen(path, MODE_READ);
+    char* text;
+
+    if (!in)
+        return NULL;
+
+    fseek(in, 0, SEEK_END);
+    *size = ftell(in);
+    rewind(in);
+
+    text = (char*)xcalloc(*size + 1, sizeof(char));
+    *size = (long)fread(text, sizeof(char), *size, in);
+    fclose(in);
+
+    return text;
+}
+
+static void write_whole_file(char* path, char* text, long size)
+{
+    FILE* out = fopen(path, MODE_WRITE);
+
+    fwrite(text, sizeof(char), size, out);
+    fclose(out);
+}
+
+static void assemble_copy(void* item)
+{
+    stressCopy* copy = (stressCopy*)item;
+    Assembly* assembly = assembly_new(copy->name, copy->jobs, 0);
+
+    copy->succeeded = assembly_run(assembly);
+    copy->diagnostics_count = debug_list_get_count(assembly_get_debug_list(assembly));
+    assembly_destroy(&assembly);
+}
+
+/* Compares an output file of a copy with the output of the single run, both may be missing. */
+static bool is_same_output(char* name, char* extension, char* expected, long expected_size)
+{
+    char* path = get_outfile_name(name, extension), *actual;
+    long size = 0;
+    bool is_same;
+
+    actual = read_whole_file(path, &size);
+    is_same = (!actual && !expected) || (actual && expected && size == expected_size && memcmp(actual, expected, size) == 0);
+
+    remove(path);
+    free(actual);
+    free(path);
+
+    return is_same;
+}
+
+int main(int argc, char** argv)
+{
+    stressCopy* copies;
+    stressCopy reference;
+    char* source, *path, *expected[STRESS_OUTPUTS_COUNT];
+    long source_size = 0, expected_size[STRESS_OUTPUTS_COUNT];
+    int count = (argc > 2) ? atoi(argv[2]) : STRESS_DEFAULT_COPIES, jobs = (argc > 3) ? atoi(argv[3]) : STRESS_DEFAULT_JOBS;
+    int i, j, mismatches = 0;
+
+    if (argc < 2 || count < 1 || jobs < 1) {
+        printf("Usage: ./stress_assemble <source.as> [copies] [jobs]\n");
+        return 1;
+    }
+
+    if (!(source = read_whole_file(argv[1], &source_size))) {
+        printf("Error: Could not open %s !\n", argv[1]);
+        return 1;
+    }
+
+    copies = (stressCopy*)xcalloc(count, sizeof(stressCopy));
+    for (i = 0; i < count; i++) {
+        sprintf(copies[i].name, "stress_%d", i);
+        copies[i].jobs = jobs;
+        path = get_outfile_name(copies[i].name, SRC_ASSEMBLER_FILE_EXTENSTION);
+        write_whole_file(path, source, source_size);
+        free(path);
+    }
+
+    /* The single run, its outputs are what every copy must produce. */
+    reference = copies[0];
+    reference.jobs = 1;
+    assemble_copy(&reference);
+    for (j = 0; j < STRESS_OUTPUTS_COUNT; j++) {
+        path = get_outfile_name(reference.name, stress_outputs[j]);
+        expected_size[j] = 0;
+        expected[j] = read_whole_file(path, &expected_size[j]);
+        remove(path);
+        free(path);
+    }
+
+    parallel_run_tasks(copies, count, sizeof(stressCopy), assemble_copy);
+
+    for (i = 0; i < count; i++) {
+        if (copies[i].succeeded != reference.succeeded || copies[i].diagnostics_count != reference.diagnostics_count) {
+            printf("%s: %d diagnostics, expected %d\n", copies[i].name, copies[i].diagnostics_count, reference.diagnostics_count);
+            mismatches++;
+        }
+
+        for (j = 0; j < STRESS_OUTPUTS_COUNT; j++) {
+            if (!is_same_output(copies[i].name, stress_outputs[j], expected[j], expected_size[j])) {
+                printf("%s%s differs from the single run\n", copies[i].name, stress_outputs[j]);
+                mismatches++;
+            }
+        }
+
+        path = get_outfile_name(copies[i].name, SRC_ASSEMBLER_FILE_EXTENSTION);
+        remove(path);
+        free(path);
+    }
+
+    printf("%d copies of %s, %s\n", count, argv[1], mismatches ? "MISMATCH" : "all match the single run");
+
+    for (j = 0; j < STRESS_OUTPUTS_COUNT; j++)
+        free(expected[j]);
+    free(copies);
+    free(source);
+
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+#include "asm14.h"
+#include "assembly.h"
+
+#define ASM14_DEFAULT_NAME "input"
+
+/* The image of the result keeps a word in an unsigned short, a word format wider than 16 bits fails the build. */
+typedef char asm14_word_fits_image[(WORD_FORMAT_BITS <= 16) ? 1 : -1];
+
+void asm14_options_init(asm14_options* options)
+{
+	options->name = ASM14_DEFAULT_NAME;
+	options->max_errors = 0;
+	options->jobs = 1;
+	options->include_resolver = NULL;
+	options->include_context = NULL;
+}
+
+/* A FileResolver, asks the resolver of the options for an included file. */
+static const char* resolve_include(void* context, char* path, size_t* size)
+{
+	const asm14_options* options = (const asm14_options*)context;
+
+	return options->include_resolver(options->include_context, path, size);
+}
+
+/* Copies the symbols of a type, in the order of the symbol table, the same order as the output files. */
+static asm14_symbol* copy_symbols(SymbolTable* table, symbolType type, int* count)
+{
+	SymbolTableNode* node;
+	asm14_symbol* symbols;
+	Symbol* sym;
+	int i = 0;
+
+	*count = 0;
+	for (node = symbol_table_get_head(table); node; node = symbol_node_get_next(node))
+		if (symbol_get_type(symbol_node_get_sym(node)) == type)
+			(*count)++;
+
+	if (*count == 0)
+		return NULL;
+
+	symbols = (asm14_symbol*)xcalloc(*count, sizeof(asm14_symbol));
+	for (node = symbol_table_get_head(table); node; node = symbol_node_get_next(node)) {
+		sym = symbol_node_get_sym(node);
+		if (symbol_get_type(sym) != type)
+			continue;
+
+		symbols[i].name = get_copy_string(symbol_get_name(sym));
+		symbols[i].address = symbol_get_counter(sym);
+		i++;
+	}
+
+	return symbols;
+}
+
+/* The image as the object file lists it, the instructions and then the data. */
+static unsigned short* copy_image(memoryBuffer* memory, int* instructions_count, int* data_count)
+{
+	imageMemory* inst = memory_buffer_get_inst_img(memory), * data = memory_buffer_get_data_img(memory);
+	unsigned short* image;
+	int i;
+
+	*instructions_count = img_memory_get_counter(inst);
+	*data_count = img_memory_get_counter(data);
+	image = (unsigned short*)xcalloc(*instructions_count + *data_count + 1, sizeof(unsigned short));
+
+	for (i = 0; i < *instructions_count; i++)
+		image[i] = (unsigned short)img_memory_get_word(inst, i);
+	for (i = 0; i < *data_count; i++)
+		image[*instructions_count + i] = (unsigned short)img_memory_get_word(data, i);
+
+	return image;
+}
+
+static asm14_diagnostic* copy_diagnostics(debugList* dbg_list, int* count)
+{
+	asm14_diagnostic* diagnostics;
+	errorContext* node;
+	char message[ERROR_MESSAGE_MAX_LENGTH];
+	int i;
+
+	if ((*count = debug_list_get_count(dbg_list)) == 0)
+		return NULL;
+
+	diagnostics = (asm14_diagnostic*)xcalloc(*count, sizeof(asm14_diagnostic));
+	for (i = 0; i < *count; i++) {
+		node = debug_list_get_node(dbg_list, i);
+		diagnostics[i].file = get_copy_string(error_context_get_file(node));
+		diagnostics[i].line = error_context_get_line_num(node);
+		diagnostics[i].column = error_context_get_column(node);
+		diagnostics[i].code = (int)error_context_get_code(node);
+		diagnostics[i].is_warning = is_warning_code(error_context_get_code(node)) ? 1 : 0;
+		diagnostics[i].message = get_copy_string(format_error_message(error_context_get_code(node), message));
+		diagnostics[i].source = get_copy_string(error_context_get_line(node));
+	}
+
+	return diagnostics;
+}
+
+int asm14_assemble(const char* src, size_t len, const asm14_options* options, asm14_result* result)
+{
+	asm14_options defaults;
+	Assembly* assembly;
+	char* source;
+
+	if (!options) {
+		asm14_options_init(&defaults);
+		options = &defaults;
+	}
+
+	memset(result, 0, sizeof(asm14_result));
+	assembly = assembly_new((char*)(options->name ? options->name : ASM14_DEFAULT_NAME), options->jobs, options->max_errors);
+
+	/* The outputs are held by the store and dropped with it, and the store is sealed so the source and the files it includes are never
+	*  opened from the disk. */
+	assembly_defer_outputs(assembly, output_sink_get_null());
+	file_store_seal(assembly_get_file_store(assembly), options->include_resolver ? resolve_include : NULL, (void*)options);
+	source = (char*)xmalloc(len + 1);
+	memcpy(source, src, len);
+	file_store_put(assembly_get_file_store(assembly), assembly_get_src_path(assembly), source, len);
+
+	if (assembly_run(assembly)) {
+		result->succeeded = 1;
+		result->image = copy_image(assembly_get_memory(assembly), &result->instructions_count, &result->data_count);
+		result->entries = copy_symbols(assembly_get_symbol_table(assembly), SYM_ENTRY, &result->entries_count);
+		result->externals = copy_symbols(assembly_get_symbol_table(assembly), SYM_EXTERN, &result->externals_count);
+	}
+
+	result->diagnostics = copy_diagnostics(assembly_get_debug_list(assembly), &result->diagnostics_count);
+	assembly_destroy(&assembly);
+
+	return result->succeeded;
+}
+
+static void free_symbols(asm14_symbol* symbols, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		free(symbols[i].name);
+	free(symbols);
+}
+
+void asm14_result_free(asm14_result* result)
+{
+	int i;
+
+	for (i = 0; i < result->diagnostics_count; i++) {
+		free(result->diagnostics[i].file);
+		free(result->diagnostics[i].message);
+		free(result->diagnostics[i].source);
+	}
+
+	free(result->diagnostics);
+	free_symbols(result->entries, result->entries_count);
+	free_symbols(result->externals, result->externals_count);
+	free(result->image);
+	memset(result, 0, sizeof(asm14_result));
+}
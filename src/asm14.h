@@ -0,0 +1,98 @@
+#ifndef ASM14_H
+#define ASM14_H
+
+/** @file
+*	This header declares the embeddable interface of the assembler, it assembles a source that is held in memory into a result in memory.
+*   No file is read or written and nothing is printed, the diagnostics are returned in the result, the files the source includes are asked
+*   from a resolver the caller gives. The calls don't share any state,
+*   so several sources may be assembled at once on different threads. The header doesn't depend on the other headers of the assembler,
+*   a program links 'libasm14.a' (and pthread) and includes only this header.
+*/
+
+#include <stddef.h>
+
+/**
+* @brief A function that returns the contents of a file the source includes with '.include "path"'.
+* @param context - The include_context of the options.
+* @param path - The path of the file, relative to the directory of the name of the source.
+* @param len - Receives the length of the contents.
+* @return The contents, they still belong to the caller and are copied before the assembly goes on. NULL if there is no such file.
+*/
+typedef const char* (*asm14_include_resolver)(void* context, const char* path, size_t* len);
+
+/**
+* @brief The options of an assembly, asm14_options_init sets the defaults.
+*/
+typedef struct
+{
+	const char* name; /* The name of the source in the diagnostics, without the '.as' extension. */
+	int max_errors; /* The errors limit of the source, 0 for no limit. */
+	int jobs; /* The maximal amount of threads the passes may use. */
+	asm14_include_resolver include_resolver; /* NULL if the source can't include files, an '.include' is then reported as not available. */
+	void* include_context; /* Passed to the resolver. */
+} asm14_options;
+
+/**
+* @brief A symbol of the entries or the externals.
+*/
+typedef struct
+{
+	char* name;
+	int address; /* The same address as in the '.entry' and '.external' files. */
+} asm14_symbol;
+
+/**
+* @brief A single diagnostic, an error or a warning.
+*/
+typedef struct
+{
+	char* file;
+	long line; /* 0 if the diagnostic refers to the whole source. */
+	int column; /* 1 based, 0 if the diagnostic refers to the whole line. */
+	int code; /* The same code as in the json diagnostics of the command line. */
+	int is_warning; /* Warnings don't fail the assembly. */
+	char* message;
+	char* source; /* The line the diagnostic refers to. */
+} asm14_diagnostic;
+
+/**
+* @brief The result of an assembly, all its memory belongs to the caller and is freed by asm14_result_free.
+*/
+typedef struct
+{
+	int succeeded;
+	unsigned short* image; /* The 14 bit words of the instructions followed by the data, the first word is at address 100. */
+	int instructions_count;
+	int data_count;
+	asm14_symbol* entries;
+	int entries_count;
+	asm14_symbol* externals;
+	int externals_count;
+	asm14_diagnostic* diagnostics; /* In the order of the command line output. */
+	int diagnostics_count;
+} asm14_result;
+
+/**
+* @brief This function sets the default options, the name "input", no errors limit, a single thread and no included files.
+* @param options - The options to set.
+*/
+void asm14_options_init(asm14_options* options);
+
+/**
+* @brief This function assembles a source, the same as the command line does for a '.as' file.
+* The image, the entries and the externals are only filled if the source was assembled, the diagnostics are always filled.
+* @param src - The source, it doesn't have to be terminated.
+* @param len - The length of the source in bytes.
+* @param options - The options, NULL for the defaults.
+* @param result - Receives the result, it must be freed with asm14_result_free.
+* @return 1 if the source was assembled, 0 otherwise.
+*/
+int asm14_assemble(const char* src, size_t len, const asm14_options* options, asm14_result* result);
+
+/**
+* @brief This function frees the memory of a result and empties it.
+* @param result - The result.
+*/
+void asm14_result_free(asm14_result* result);
+
+#endif
@@ -0,0 +1,186 @@
+#include "assembly.h"
+#include "pre_assembler.h"
+#include "first_pass.h"
+#include "second_pass.h"
+#include "symbol_table.h"
+#include "memory.h"
+#include "file_store.h"
+#include "line_cache.h"
+
+struct assembly
+{
+	char* src_path;
+	SymbolTable* sym_table;
+	memoryBuffer* mem_buffer;
+	debugList* dbg_list;
+	FileStore* store; /* Every file the passes read and write. */
+	int jobs;
+	ObjectFormat object_format;
+	bool is_incremental; /* The first pass takes the lines that didn't change from the line cache of the source. */
+	bool succeeded;
+};
+
+Assembly* assembly_new(char* file_name, int jobs, int max_errors)
+{
+	Assembly* assembly = (Assembly*)xmalloc(sizeof(Assembly));
+
+	assembly->src_path = get_outfile_name(file_name, SRC_ASSEMBLER_FILE_EXTENSTION);
+	assembly->sym_table = symbol_table_new_table();
+	assembly->mem_buffer = memory_buffer_get_new();
+	assembly->dbg_list = debug_list_new_list();
+	assembly->store = file_store_new(FALSE, output_sink_get_files());
+	assembly->jobs = (jobs > 0) ? jobs : 1;
+	assembly->object_format = OBJECT_FORMAT_TEXT;
+	assembly->is_incremental = FALSE;
+	assembly->succeeded = FALSE;
+	debug_list_set_max_errors(assembly->dbg_list, max_errors);
+
+	return assembly;
+}
+
+void assembly_defer_outputs(Assembly* assembly, OutputSink* sink)
+{
+	file_store_destroy(&assembly->store);
+	assembly->store = file_store_new(TRUE, sink);
+}
+
+void assembly_set_object_format(Assembly* assembly, ObjectFormat format)
+{
+	assembly->object_format = format;
+}
+
+void assembly_set_incremental(Assembly* assembly, bool is_incremental)
+{
+	assembly->is_incremental = is_incremental;
+}
+
+bool assembly_load_source(Assembly* assembly)
+{
+	return file_store_load(assembly->store, assembly->src_path);
+}
+
+bool assembly_load_source_stream(Assembly* assembly, FILE* in)
+{
+	return file_store_load_stream(assembly->store, assembly->src_path, in);
+}
+
+bool assembly_run(Assembly* assembly)
+{
+	char* pre_assembler_path = get_outfile_name(assembly->src_path, PRE_ASSEMBLER_FILE_EXTENSTION), * cache_path = NULL;
+	LineCache* cache = NULL;
+
+	/* A cache that can't be loaded only means that every line is prepared. The cache is a file next to the source, so it's only kept when
+	*  the assembly works on the disk, not for the outputs that go to another sink. */
+	if (assembly->is_incremental && file_store_is_on_disk(assembly->store)) {
+		cache_path = get_outfile_name(assembly->src_path, LINE_CACHE_FILE_EXTENSTION);
+		cache = line_cache_new();
+		line_cache_load(cache, cache_path);
+	}
+
+	/* Every stage returns FALSE on failure, the stages after it are skipped. */
+	assembly->succeeded = start_pre_assembler(assembly->src_path, assembly->jobs, assembly->store, assembly->dbg_list) &&
+	                      do_first_pass(pre_assembler_path, assembly->mem_buffer, assembly->sym_table, assembly->jobs, cache, assembly->store, assembly->dbg_list) &&
+	                      initiate_second_pass(pre_assembler_path, assembly->sym_table, assembly->mem_buffer, assembly->object_format, assembly->store, assembly->dbg_list);
+
+	/* The cache is private to the assembler, it's written to the disk whatever the sink of the outputs is. A run that recorded nothing keeps the old cache. */
+	if (cache) {
+		if (line_cache_get_recorded_count(cache) > 0)
+			line_cache_save(cache, cache_path);
+		line_cache_destroy(&cache);
+		free(cache_path);
+	}
+
+	free(pre_assembler_path);
+	return assembly->succeeded;
+}
+
+bool assembly_write_outputs(Assembly* assembly)
+{
+	return assembly_finish_outputs(assembly, NULL, 0);
+}
+
+bool assembly_finish_outputs(Assembly* assembly, FileBuffer* written, int count)
+{
+	/* The '.am' file is written even when the assembly failed, the same as when the outputs are not deferred. */
+	if (!file_store_flush(assembly->store, written, count, assembly->dbg_list))
+		assembly->succeeded = FALSE;
+
+	return assembly->succeeded;
+}
+
+bool assembly_write_outputs_stream(Assembly* assembly, FILE* out, bool is_framed)
+{
+	char* extensions[] = { OBJECT_ASSEMBLER_FILE_EXTENSTION, ENTRY_ASSEMBLER_FILE_EXTENSTION, EXTERN_ASSEMBLER_FILE_EXTENSTION };
+	int i, count = is_framed ? (int)(sizeof(extensions) / sizeof(extensions[0])) : 1;
+	bool is_written = TRUE;
+	FileBuffer file;
+	char* path;
+
+	if (assembly->object_format == OBJECT_FORMAT_COMPACT)
+		extensions[0] = COMPACT_OBJECT_ASSEMBLER_FILE_EXTENSTION;
+
+	for (i = 0; i < count; i++) {
+		path = get_outfile_name(assembly->src_path, extensions[i]);
+
+		/* The entries and the externals are only made when there are any. */
+		if (file_store_get_file(assembly->store, path, &file)) {
+			if (is_framed)
+				fprintf(out, "%s %lu\n", extensions[i], (unsigned long)file.size);
+			if (fwrite(file.data, sizeof(char), file.size, out) != file.size || ferror(out)) {
+				debug_list_register_file_node(assembly->dbg_list, path, ERROR_CODE_FILE_WRITE);
+				is_written = FALSE;
+			}
+		}
+
+		free(path);
+	}
+
+	if (is_written && fflush(out) != 0) {
+		debug_list_register_file_node(assembly->dbg_list, assembly->src_path, ERROR_CODE_FILE_WRITE);
+		is_written = FALSE;
+	}
+	if (!is_written)
+		assembly->succeeded = FALSE;
+
+	return is_written;
+}
+
+FileStore* assembly_get_file_store(Assembly* assembly)
+{
+	return assembly->store;
+}
+
+bool assembly_succeeded(Assembly* assembly)
+{
+	return assembly->succeeded;
+}
+
+char* assembly_get_src_path(Assembly* assembly)
+{
+	return assembly->src_path;
+}
+
+SymbolTable* assembly_get_symbol_table(Assembly* assembly)
+{
+	return assembly->sym_table;
+}
+
+memoryBuffer* assembly_get_memory(Assembly* assembly)
+{
+	return assembly->mem_buffer;
+}
+
+debugList* assembly_get_debug_list(Assembly* assembly)
+{
+	return assembly->dbg_list;
+}
+
+void assembly_destroy(Assembly** assembly)
+{
+	symbol_table_destroy(&(*assembly)->sym_table);
+	memory_buffer_destroy(&(*assembly)->mem_buffer);
+	debug_list_destroy(&(*assembly)->dbg_list);
+	file_store_destroy(&(*assembly)->store);
+	free((*assembly)->src_path);
+	free(*assembly);
+}
@@ -0,0 +1,151 @@
+#ifndef ASSEMBLY_H
+#define ASSEMBLY_H
+
+/** @file
+*	This header declares the assembly of a single source file, from the pre-assembler to the output files.
+*   All the state of the file lives in its assembly, nothing is shared with other assemblies and nothing is printed,
+*   so several files may be assembled at once on different threads. The diagnostics are collected in the debug list of the assembly.
+*/
+
+#include "utils.h"
+#include "debug.h"
+#include "file_store.h"
+#include "symbol_table.h"
+#include "memory.h"
+#include "object_codec.h"
+
+/**
+* @brief A forward declaration of the assembly of a file, declaration in the '.c' file.
+*/
+typedef struct assembly Assembly;
+
+/**
+* @brief This function creates a new assembly.
+* @param file_name - The name of the source, with or without the '.as' extension.
+* @param jobs - The maximal amount of threads the passes may use.
+* @param max_errors - The errors limit of the file, 0 for no limit.
+* @return A new assembly.
+*/
+Assembly* assembly_new(char* file_name, int jobs, int max_errors);
+
+/**
+* @brief This function keeps the outputs of the assembly in memory until assembly_write_outputs, instead of writing them as they are made.
+* It must be called before assembly_run.
+* @param assembly - The assembly.
+* @param sink - The sink assembly_write_outputs writes the outputs to, i.e output_sink_get_files for the disk. The assembly doesn't own it.
+*/
+void assembly_defer_outputs(Assembly* assembly, OutputSink* sink);
+
+/**
+* @brief This function sets the encoding of the object file, the text '.object' by default or the compact '.cobject'. It must be called before assembly_run.
+* @param assembly - The assembly.
+* @param format - The encoding.
+*/
+void assembly_set_object_format(Assembly* assembly, ObjectFormat format);
+
+/**
+* @brief This function makes the assembly incremental, the first pass keeps how it prepared every line in a line cache next to the source ('.cache'),
+* and the next run only prepares the lines that are not in it. The outputs are the same as without the cache. It must be called before assembly_run.
+* @param assembly - The assembly.
+* @param is_incremental - TRUE to use the line cache, FALSE to prepare every line (the default). The cache is only used when the outputs go to the files.
+*/
+void assembly_set_incremental(Assembly* assembly, bool is_incremental);
+
+/**
+* @brief This function reads the source into memory ahead of assembly_run, i.e on another thread while other files are assembled.
+* @param assembly - The assembly.
+* @return TRUE if the source was read, FALSE if it couldn't be read, it's reported by assembly_run then.
+*/
+bool assembly_load_source(Assembly* assembly);
+
+/**
+* @brief This function reads the source from a stream instead of the disk, i.e the standard input. It must be called before assembly_run.
+* @param assembly - The assembly.
+* @param in - The stream, it's read until its end.
+* @return TRUE if the stream was read, FALSE otherwise.
+*/
+bool assembly_load_source_stream(Assembly* assembly, FILE* in);
+
+/**
+* @brief This function assembles the file, it may be called once.
+* @param assembly - The assembly.
+* @return TRUE if the file was assembled and all its output files were written, FALSE otherwise.
+*/
+bool assembly_run(Assembly* assembly);
+
+/**
+* @brief This function writes the outputs that were deferred by assembly_defer_outputs to their sink, and frees the files the assembly holds.
+* @param assembly - The assembly.
+* @return TRUE if the outputs were written (or there were none to write), FALSE otherwise.
+*/
+bool assembly_write_outputs(Assembly* assembly);
+
+/**
+* @brief This function writes the outputs that were deferred to a stream instead of the disk, the '.am' file is dropped.
+* Without framing only the object (in the encoding of assembly_set_object_format) is written. With framing the object, the entries and the externals that were made are written one after the other,
+* each after a header line of its extension and its size in bytes, i.e ".entry 24".
+* @param assembly - The assembly, it must have succeeded.
+* @param out - The stream.
+* @param is_framed - TRUE to write all the outputs in frames, FALSE to write only the object.
+* @return TRUE if the outputs were written, FALSE otherwise.
+*/
+bool assembly_write_outputs_stream(Assembly* assembly, FILE* out, bool is_framed);
+
+/**
+* @brief This function finishes the outputs that were deferred, some of them may have been written already by the caller.
+* @param assembly - The assembly.
+* @param written - Outputs of the file store that the caller wrote, the rest are written here.
+* @param count - The amount of outputs in 'written'.
+* @return TRUE if the outputs were written (or there were none to write), FALSE otherwise.
+*/
+bool assembly_finish_outputs(Assembly* assembly, FileBuffer* written, int count);
+
+/**
+* @brief This function returns the file store of the assembly, i.e to read the source or write the outputs of many files in one batch.
+* @param assembly - The assembly.
+* @return The store, owned by the assembly.
+*/
+FileStore* assembly_get_file_store(Assembly* assembly);
+
+/**
+* @brief This function returns the result of assembly_run, and of assembly_write_outputs if the outputs were deferred.
+* @param assembly - The assembly.
+* @return TRUE if the file was assembled, FALSE if it failed or wasn't run yet.
+*/
+bool assembly_succeeded(Assembly* assembly);
+
+/**
+* @brief This function returns the path of the source.
+* @param assembly - The assembly.
+* @return The path, owned by the assembly.
+*/
+char* assembly_get_src_path(Assembly* assembly);
+
+/**
+* @brief This function returns the symbols of the file, i.e for its entries and externals.
+* @param assembly - The assembly.
+* @return The symbol table, owned by the assembly.
+*/
+SymbolTable* assembly_get_symbol_table(Assembly* assembly);
+
+/**
+* @brief This function returns the instruction and the data images of the file.
+* @param assembly - The assembly.
+* @return The memory buffer, owned by the assembly.
+*/
+memoryBuffer* assembly_get_memory(Assembly* assembly);
+
+/**
+* @brief This function returns the diagnostics of the file.
+* @param assembly - The assembly.
+* @return The debug list, owned by the assembly.
+*/
+debugList* assembly_get_debug_list(Assembly* assembly);
+
+/**
+* @brief This function frees an assembly.
+* @param assembly - The assembly to free.
+*/
+void assembly_destroy(Assembly** assembly);
+
+#endif
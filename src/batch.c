@@ -0,0 +1,403 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "batch.h"
+#include "parallel.h"
+#include "uring_io.h"
+#include <pthread.h>
+#include <sys/stat.h>
+
+/* The amount of files per worker the reader may load ahead, and the writer may be behind. */
+#define BATCH_PREFETCH_PER_WORKER 2
+#define BATCH_WRITE_QUEUE_PER_WORKER 2
+/* The '.am', '.object', '.entry' and '.external' files of a source. */
+#define BATCH_OUTPUTS_PER_FILE 4
+
+typedef enum { FILE_PENDING, FILE_LOADING, FILE_LOADED, FILE_ASSEMBLING, FILE_WRITING, FILE_DONE } BatchFileState;
+
+struct batch
+{
+	int count;
+	Assembly** assemblies;
+	BatchFileState* states;
+	Scheduler* scheduler;
+	pthread_mutex_t lock; /* Guards the states and the queues. */
+	pthread_cond_t changed; /* Signaled whenever a state or a queue changes. */
+	int prefetched; /* The files that were loaded and not taken by a worker yet. */
+	int prefetch_depth;
+	int* write_queue; /* A ring of the files that wait for the writer. */
+	int write_head;
+	int write_count;
+	int write_depth;
+	int written;
+	pthread_t reader;
+	pthread_t writer;
+	bool is_reader_started;
+	bool is_writer_started;
+	UringIO* reader_uring; /* The rings of the reader and the writer, NULL for the stdio path. */
+	UringIO* writer_uring;
+	OutputSink* sink; /* Where the outputs of the files are written. */
+	int* loading; /* The files the reader loads at once. */
+	FileBuffer* sources;
+	int* writing; /* The files the writer writes at once. */
+	FileBuffer* outputs;
+	int* outputs_counts; /* The amount of outputs of every file the writer writes. */
+	SchedulerWorkerStats reader_stats;
+	SchedulerWorkerStats writer_stats;
+	double start_time;
+};
+
+/* The size of a source, the larger files of a batch are started first. A missing file is reported when it's opened. */
+static long get_source_size(char* path)
+{
+	struct stat st;
+
+	return (stat(path, &st) == 0) ? (long)st.st_size : 0;
+}
+
+Batch* batch_new(char** files, int count, int jobs, int max_errors)
+{
+	Batch* batch = (Batch*)xmalloc(sizeof(Batch));
+	long* sizes = (long*)xcalloc(count, sizeof(long));
+	char* src_path;
+	int i, workers;
+
+	for (i = 0; i < count; i++) {
+		src_path = get_outfile_name(files[i], SRC_ASSEMBLER_FILE_EXTENSTION);
+		sizes[i] = get_source_size(src_path);
+		free(src_path);
+	}
+
+	batch->scheduler = scheduler_new(sizes, count, jobs);
+	workers = scheduler_get_workers_count(batch->scheduler);
+	free(sizes);
+
+	batch->count = count;
+	batch->assemblies = (Assembly**)xcalloc(count, sizeof(Assembly*));
+	batch->states = (BatchFileState*)xcalloc(count, sizeof(BatchFileState));
+	batch->prefetched = 0;
+	batch->prefetch_depth = BATCH_PREFETCH_PER_WORKER * workers;
+	batch->write_depth = BATCH_WRITE_QUEUE_PER_WORKER * workers;
+	batch->write_queue = (int*)xcalloc(batch->write_depth, sizeof(int));
+	batch->write_head = batch->write_count = batch->written = 0;
+	batch->is_reader_started = batch->is_writer_started = FALSE;
+	batch->reader_uring = batch->writer_uring = NULL;
+	batch->sink = output_sink_get_files();
+	batch->loading = (int*)xcalloc(batch->prefetch_depth, sizeof(int));
+	batch->sources = (FileBuffer*)xcalloc(batch->prefetch_depth, sizeof(FileBuffer));
+	batch->writing = (int*)xcalloc(batch->write_depth, sizeof(int));
+	batch->outputs_counts = (int*)xcalloc(batch->write_depth, sizeof(int));
+	batch->outputs = (FileBuffer*)xcalloc(batch->write_depth * BATCH_OUTPUTS_PER_FILE, sizeof(FileBuffer));
+	memset(&batch->reader_stats, 0, sizeof(SchedulerWorkerStats));
+	memset(&batch->writer_stats, 0, sizeof(SchedulerWorkerStats));
+	batch->start_time = 0;
+	pthread_mutex_init(&batch->lock, NULL);
+	pthread_cond_init(&batch->changed, NULL);
+
+	/* The threads are split between the files that run at once, a lone file gets all of them. */
+	for (i = 0; i < count; i++) {
+		batch->assemblies[i] = assembly_new(files[i], jobs / workers, max_errors);
+		batch->states[i] = FILE_PENDING;
+	}
+
+	return batch;
+}
+
+bool batch_enable_uring(Batch* batch)
+{
+	batch->reader_uring = uring_io_new();
+	batch->writer_uring = uring_io_new();
+
+	if (!batch->reader_uring || !batch->writer_uring) {
+		if (batch->reader_uring)
+			uring_io_destroy(&batch->reader_uring);
+		if (batch->writer_uring)
+			uring_io_destroy(&batch->writer_uring);
+		batch->reader_uring = batch->writer_uring = NULL;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+bool batch_is_uring_enabled(Batch* batch)
+{
+	return batch->reader_uring ? TRUE : FALSE;
+}
+
+void batch_set_output_sink(Batch* batch, OutputSink* sink)
+{
+	batch->sink = sink;
+}
+
+void batch_set_object_format(Batch* batch, ObjectFormat format)
+{
+	int i;
+
+	for (i = 0; i < batch->count; i++)
+		assembly_set_object_format(batch->assemblies[i], format);
+}
+
+void batch_set_incremental(Batch* batch, bool is_incremental)
+{
+	int i;
+
+	for (i = 0; i < batch->count; i++)
+		assembly_set_incremental(batch->assemblies[i], is_incremental);
+}
+
+/* Loads the sources of several files, in one batch on io_uring. A source the ring couldn't read is read with stdio, and reported by the assembly if it fails again. */
+static void batch_load_sources(Batch* batch, int count)
+{
+	Assembly* assembly;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		batch->sources[i].path = assembly_get_src_path(batch->assemblies[batch->loading[i]]);
+		batch->sources[i].is_done = FALSE;
+	}
+
+	if (batch->reader_uring)
+		uring_io_read_files(batch->reader_uring, batch->sources, count);
+
+	for (i = 0; i < count; i++) {
+		assembly = batch->assemblies[batch->loading[i]];
+		if (batch->sources[i].is_done)
+			file_store_put(assembly_get_file_store(assembly), batch->sources[i].path, batch->sources[i].data, batch->sources[i].size);
+		else
+			assembly_load_source(assembly);
+	}
+}
+
+/* The reader stage, loads the sources in the order the workers start them, at most 'prefetch_depth' ahead of them.
+*  On io_uring all the files there is room for are loaded at once, on stdio one at a time so the workers get them sooner. */
+static void* batch_reader_main(void* arg)
+{
+	Batch* batch = (Batch*)arg;
+	double begin;
+	int position = 0, index, count, limit, i;
+
+	while (position < batch->count) {
+		pthread_mutex_lock(&batch->lock);
+		while (batch->prefetched >= batch->prefetch_depth)
+			pthread_cond_wait(&batch->changed, &batch->lock);
+
+		/* A worker that stole a file already reads it on its own. */
+		limit = batch->reader_uring ? batch->prefetch_depth - batch->prefetched : 1;
+		for (count = 0; position < batch->count && count < limit; position++) {
+			index = scheduler_get_item_at(batch->scheduler, position);
+			if (batch->states[index] != FILE_PENDING)
+				continue;
+
+			batch->states[index] = FILE_LOADING;
+			batch->loading[count++] = index;
+		}
+		pthread_mutex_unlock(&batch->lock);
+
+		begin = parallel_get_time();
+		batch_load_sources(batch, count);
+		batch->reader_stats.busy_seconds += parallel_get_time() - begin;
+		batch->reader_stats.items += count;
+
+		pthread_mutex_lock(&batch->lock);
+		for (i = 0; i < count; i++)
+			batch->states[batch->loading[i]] = FILE_LOADED;
+		batch->prefetched += count;
+		pthread_cond_broadcast(&batch->changed);
+		pthread_mutex_unlock(&batch->lock);
+	}
+
+	return NULL;
+}
+
+/* Writes the outputs of several files, in one batch on io_uring. The outputs the ring couldn't write are written with stdio by the assemblies.
+*  The ring only writes to the disk, the outputs for another sink are handed to it by the assemblies. */
+static void batch_write_outputs(Batch* batch, int count)
+{
+	Assembly* assembly;
+	int i, total = 0;
+
+	if (!batch->writer_uring || !output_sink_is_files(batch->sink)) {
+		for (i = 0; i < count; i++)
+			assembly_write_outputs(batch->assemblies[batch->writing[i]]);
+		return;
+	}
+
+	/* The outputs of every file follow those of the file before it. */
+	for (i = 0; i < count; i++) {
+		assembly = batch->assemblies[batch->writing[i]];
+		batch->outputs_counts[i] = file_store_get_outputs(assembly_get_file_store(assembly), batch->outputs + total, BATCH_OUTPUTS_PER_FILE);
+		total += batch->outputs_counts[i];
+	}
+
+	uring_io_write_files(batch->writer_uring, batch->outputs, total);
+
+	for (i = 0, total = 0; i < count; i++) {
+		assembly_finish_outputs(batch->assemblies[batch->writing[i]], batch->outputs + total, batch->outputs_counts[i]);
+		total += batch->outputs_counts[i];
+	}
+}
+
+/* The writer stage, writes the outputs of the files in the order they were assembled, all the files that wait for it at once. */
+static void* batch_writer_main(void* arg)
+{
+	Batch* batch = (Batch*)arg;
+	double begin;
+	int count, i;
+
+	pthread_mutex_lock(&batch->lock);
+	while (batch->written < batch->count) {
+		while (batch->write_count == 0)
+			pthread_cond_wait(&batch->changed, &batch->lock);
+
+		for (count = 0; batch->write_count > 0 && (count == 0 || batch->writer_uring); count++) {
+			batch->writing[count] = batch->write_queue[batch->write_head];
+			batch->write_head = (batch->write_head + 1) % batch->write_depth;
+			batch->write_count--;
+		}
+		pthread_cond_broadcast(&batch->changed);
+		pthread_mutex_unlock(&batch->lock);
+
+		begin = parallel_get_time();
+		batch_write_outputs(batch, count);
+		batch->writer_stats.busy_seconds += parallel_get_time() - begin;
+		batch->writer_stats.items += count;
+
+		pthread_mutex_lock(&batch->lock);
+		for (i = 0; i < count; i++)
+			batch->states[batch->writing[i]] = FILE_DONE;
+		batch->written += count;
+		pthread_cond_broadcast(&batch->changed);
+	}
+	pthread_mutex_unlock(&batch->lock);
+
+	return NULL;
+}
+
+/* A SchedulerTask, the assembly stage. */
+static void batch_assemble_task(void* context, int index)
+{
+	Batch* batch = (Batch*)context;
+
+	pthread_mutex_lock(&batch->lock);
+	while (batch->states[index] == FILE_LOADING)
+		pthread_cond_wait(&batch->changed, &batch->lock);
+
+	if (batch->states[index] == FILE_LOADED) {
+		batch->prefetched--;
+		pthread_cond_broadcast(&batch->changed);
+	}
+	batch->states[index] = FILE_ASSEMBLING;
+	pthread_mutex_unlock(&batch->lock);
+
+	/* A source that wasn't loaded is read from the disk by the pre-assembler. */
+	assembly_run(batch->assemblies[index]);
+
+	if (!batch->is_writer_started) {
+		assembly_write_outputs(batch->assemblies[index]);
+
+		pthread_mutex_lock(&batch->lock);
+		batch->states[index] = FILE_DONE;
+		batch->written++;
+		pthread_cond_broadcast(&batch->changed);
+		pthread_mutex_unlock(&batch->lock);
+		return;
+	}
+
+	/* The worker waits while the writer is too far behind, the outputs of the queued files are held in memory. */
+	pthread_mutex_lock(&batch->lock);
+	while (batch->write_count >= batch->write_depth)
+		pthread_cond_wait(&batch->changed, &batch->lock);
+
+	batch->write_queue[(batch->write_head + batch->write_count) % batch->write_depth] = index;
+	batch->write_count++;
+	batch->states[index] = FILE_WRITING;
+	pthread_cond_broadcast(&batch->changed);
+	pthread_mutex_unlock(&batch->lock);
+}
+
+void batch_start(Batch* batch)
+{
+	int i;
+
+	batch->start_time = parallel_get_time();
+
+	/* Without a writer the workers write the outputs on their own, as they are made when they go to the disk. */
+	batch->is_writer_started = (pthread_create(&batch->writer, NULL, batch_writer_main, batch) == 0) ? TRUE : FALSE;
+	if (batch->is_writer_started || !output_sink_is_files(batch->sink)) {
+		for (i = 0; i < batch->count; i++)
+			assembly_defer_outputs(batch->assemblies[i], batch->sink);
+	}
+
+	/* Without a reader the workers read the sources on their own. */
+	batch->is_reader_started = (pthread_create(&batch->reader, NULL, batch_reader_main, batch) == 0) ? TRUE : FALSE;
+
+	scheduler_start(batch->scheduler, batch_assemble_task, batch);
+}
+
+Assembly* batch_wait(Batch* batch, int index)
+{
+	Assembly* assembly;
+
+	pthread_mutex_lock(&batch->lock);
+	while (batch->states[index] != FILE_DONE)
+		pthread_cond_wait(&batch->changed, &batch->lock);
+
+	assembly = batch->assemblies[index];
+	batch->assemblies[index] = NULL;
+	pthread_mutex_unlock(&batch->lock);
+
+	return assembly;
+}
+
+void batch_join(Batch* batch)
+{
+	double total;
+
+	scheduler_join(batch->scheduler);
+
+	if (batch->is_reader_started)
+		pthread_join(batch->reader, NULL);
+	if (batch->is_writer_started)
+		pthread_join(batch->writer, NULL);
+
+	total = parallel_get_time() - batch->start_time;
+	batch->reader_stats.total_seconds = total;
+	batch->writer_stats.total_seconds = total;
+}
+
+Scheduler* batch_get_scheduler(Batch* batch)
+{
+	return batch->scheduler;
+}
+
+void batch_get_stage_stats(Batch* batch, SchedulerWorkerStats* reader, SchedulerWorkerStats* writer)
+{
+	*reader = batch->reader_stats;
+	*writer = batch->writer_stats;
+}
+
+void batch_destroy(Batch** batch)
+{
+	int i;
+
+	for (i = 0; i < (*batch)->count; i++)
+		if ((*batch)->assemblies[i])
+			assembly_destroy(&(*batch)->assemblies[i]);
+
+	scheduler_destroy(&(*batch)->scheduler);
+	pthread_mutex_destroy(&(*batch)->lock);
+	pthread_cond_destroy(&(*batch)->changed);
+	if ((*batch)->reader_uring)
+		uring_io_destroy(&(*batch)->reader_uring);
+	if ((*batch)->writer_uring)
+		uring_io_destroy(&(*batch)->writer_uring);
+	free((*batch)->loading);
+	free((*batch)->sources);
+	free((*batch)->writing);
+	free((*batch)->outputs);
+	free((*batch)->outputs_counts);
+	free((*batch)->write_queue);
+	free((*batch)->states);
+	free((*batch)->assemblies);
+	free(*batch);
+}
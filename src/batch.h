@@ -0,0 +1,106 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+/** @file
+*	This header declares the batch pipeline, it assembles several files with the reading and the writing overlapped with the assembly.
+*   A reader stage loads the upcoming sources into memory, the scheduler's workers assemble them, and a writer stage writes
+*   the outputs of the files that were assembled. The stages are connected by bounded queues, so only a few files are held in memory at once.
+*/
+
+#include "utils.h"
+#include "assembly.h"
+#include "scheduler.h"
+
+/**
+* @brief A forward declaration of the batch, declaration in the '.c' file.
+*/
+typedef struct batch Batch;
+
+/**
+* @brief This function creates a new batch.
+* @param files - The names of the sources.
+* @param count - The amount of sources.
+* @param jobs - The maximal amount of threads to assemble on, they are split between the files that are assembled at once.
+* @param max_errors - The errors limit of every file, 0 for no limit.
+* @return A new batch.
+*/
+Batch* batch_new(char** files, int count, int jobs, int max_errors);
+
+/**
+* @brief This function makes the reader and the writer read and write many files at once on io_uring, instead of one at a time with stdio.
+* It must be called before batch_start.
+* @param batch - The batch.
+* @return TRUE if io_uring is used, FALSE if it isn't available and the batch keeps the stdio path.
+*/
+bool batch_enable_uring(Batch* batch);
+
+/**
+* @brief This function returns whether the batch reads and writes on io_uring.
+* @param batch - The batch.
+* @return TRUE if batch_enable_uring succeeded.
+*/
+bool batch_is_uring_enabled(Batch* batch);
+
+/**
+* @brief This function sets the sink the outputs of the files are written to, the files sink by default. It must be called before batch_start.
+* @param batch - The batch.
+* @param sink - The sink, the batch doesn't own it. The outputs are only written on io_uring to the files sink.
+*/
+void batch_set_output_sink(Batch* batch, OutputSink* sink);
+
+/**
+* @brief This function sets the encoding of the object files of all the files. It must be called before batch_start.
+* @param batch - The batch.
+* @param format - The encoding.
+*/
+void batch_set_object_format(Batch* batch, ObjectFormat format);
+
+/**
+* @brief This function makes the assemblies of all the files incremental, see assembly_set_incremental. It must be called before batch_start.
+* @param batch - The batch.
+* @param is_incremental - TRUE to use the line caches.
+*/
+void batch_set_incremental(Batch* batch, bool is_incremental);
+
+/**
+* @brief This function starts the stages, it returns once they are started.
+* @param batch - The batch.
+*/
+void batch_start(Batch* batch);
+
+/**
+* @brief This function waits until a file is assembled and its outputs are written, so the files can be reported in the order of the batch.
+* @param batch - The batch.
+* @param index - The index of the file.
+* @return The assembly of the file, the caller owns it.
+*/
+Assembly* batch_wait(Batch* batch, int index);
+
+/**
+* @brief This function waits for all the stages to finish.
+* @param batch - The batch.
+*/
+void batch_join(Batch* batch);
+
+/**
+* @brief This function returns the scheduler of the assembly stage, i.e for the stats of its workers.
+* @param batch - The batch.
+* @return The scheduler, owned by the batch.
+*/
+Scheduler* batch_get_scheduler(Batch* batch);
+
+/**
+* @brief This function returns what the reader and the writer stages did, it's valid after batch_join.
+* @param batch - The batch.
+* @param reader - Receives the stats of the reader.
+* @param writer - Receives the stats of the writer.
+*/
+void batch_get_stage_stats(Batch* batch, SchedulerWorkerStats* reader, SchedulerWorkerStats* writer);
+
+/**
+* @brief This function frees a batch, it must be joined first.
+* @param batch - The batch to free.
+*/
+void batch_destroy(Batch** batch);
+
+#endif
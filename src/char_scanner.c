@@ -0,0 +1,38 @@
+#include "char_scanner.h"
+#include <string.h>
+#include <ctype.h>
+
+char* char_scanner_skip_blanks(char* str)
+{
+    while (isspace((unsigned char)*str))
+        str++;
+    return str;
+}
+
+char* char_scanner_find_any(char* str, char* seps)
+{
+    return str + strcspn(str, seps);
+}
+
+char* char_scanner_find_char(char* str, char ch)
+{
+    char* loc = strchr(str, ch);
+
+    return loc ? loc : str + strlen(str);
+}
+
+char* char_scanner_find_word(char* str, char* word)
+{
+    size_t length = strlen(word);
+
+    if (length == 0)
+        return str;
+
+    /* Only the candidates that start with the first char of the word are compared. */
+    for (str = char_scanner_find_char(str, *word); *str; str = char_scanner_find_char(str + 1, *word)) {
+        if (strncmp(str, word, length) == 0)
+            return str;
+    }
+
+    return NULL;
+}
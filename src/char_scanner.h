@@ -0,0 +1,43 @@
+#ifndef CHAR_SCANNER_H
+#define CHAR_SCANNER_H
+
+/** @file
+*	This header declares the character scanning routines used by the LineIterator and the lexer.
+*   Every routine scans a '\0' terminated line and returns a pointer into it, the scan never moves past the terminator.
+*   The scans are built on the string functions of the C library, which examine several bytes at a time where the target allows it.
+*/
+
+#include "utils.h"
+
+/**
+* @brief This function finds the first char that is not a blank, i.e the first char for which isspace () is false.
+* @param str - The line.
+* @return A pointer to the first non blank char, or to the '\0' if the rest of the line is blank.
+*/
+char* char_scanner_skip_blanks(char* str);
+
+/**
+* @brief This function finds the first char that matches any of the seperators.
+* @param str - The line.
+* @param seps - The seperators.
+* @return A pointer to the first seperator, or to the '\0' if none was found.
+*/
+char* char_scanner_find_any(char* str, char* seps);
+
+/**
+* @brief This function finds the first occurrence of a char.
+* @param str - The line.
+* @param ch - The char.
+* @return A pointer to the first occurrence of 'ch', or to the '\0' if it wasn't found.
+*/
+char* char_scanner_find_char(char* str, char ch);
+
+/**
+* @brief This function finds the first occurrence of a word in a line.
+* @param str - The line.
+* @param word - The word.
+* @return A pointer to the first occurrence of 'word', NULL if it wasn't found.
+*/
+char* char_scanner_find_word(char* str, char* word);
+
+#endif
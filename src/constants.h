@@ -4,6 +4,8 @@
 /** @file
 */
 
+#include "word_format.h"
+
 #define SOURCE_LINE_MAX_LENGTH 81
 #define LABEL_MAX_LENGTH 31
 #define DECIMAL_ADDRESS_BASE 100
@@ -17,14 +19,6 @@
 #define INIT_PHY_SZ 4
 #define INIT_LOG_SZ 0
 
-#define SINGLE_ORDER_SIZE 14
-#define E_R_A_SIZE 2
-#define SOURCE_SIZE 2
-#define DEST_SIZE 2
-#define OPCODE_SIZE 4
-#define PARAM_ONE_SIZE 2
-#define PARAM_TWO_SIZE 2
-
 #define END_LABEL_CHAR ':'
 #define START_COMMENT_CHAR ';'
 
@@ -36,6 +30,14 @@
 #define START_MACRO_DEFENITION "mcr"
 #define END_MACRO_DEF_LEN 5
 #define END_MACRO_DEFENITION "endmcr"
+#define DOT_INCLUDE_STRING ".include"
+#define INCLUDE_QUOTE_CHAR '"'
+#define PATH_SEPARATOR_CHAR '/'
+#define MACRO_ARGUMENT_SEPARATOR_CHAR ','
+#define MACRO_ARGUMENT_OPEN_PAREN_CHAR '('
+#define MACRO_ARGUMENT_CLOSE_PAREN_CHAR ')'
+#define MACRO_ARGUMENT_QUOTE_CHAR '"'
+#define UNDERSCORE_CHAR '_'
 
 #define MODE_READ "r"
 #define MODE_READ_WRITE "r+"
@@ -47,9 +49,16 @@
 #define LETTER_Z 'Z'
 #define COLON ':'
 #define NEW_LINE_CHAR '\n'
+#define NEW_LINE_STRING "\n"
 
 #define OBJECT_PRINT_DOT '.'
 #define OBJECT_PRINT_SLASH '/'
+/* An object line is the address, a tab, the word and a '\n'. The addresses of RAM_MEMORY_SZ words always fit 4 digits. */
+#define OBJECT_ADDRESS_DIGITS 4
+#define OBJECT_LINE_LENGTH (OBJECT_ADDRESS_DIGITS + 1 + WORD_FORMAT_BITS + 1)
+/* The first line of an object, the instruction and the data image counters. */
+#define OBJECT_HEADER_FORMAT "%9d\t%4d\n"
+#define OBJECT_HEADER_MAX_LENGTH 50
 #define BACKSLASH_ZERO '\0'
 
 /*Encoding.c*/
@@ -59,21 +68,12 @@
 #define OPEN_PAREN_STRING_W_SPACE "( "
 #define CLOSED_PAREN_STRING ") "
 #define COLON_STRING ":"
-#define OFFSET_LABELS 0x02
 #define BYTE_MASK 0xff
-#define WORD_MASK 0xff00
-#define START_OFFSET_SECOND_BYTE 0x08
 
-/**
-* Constans for the different offsets of the memory word fields.
-*/
-#define OFFSET_ERA     0x00
-#define OFFSET_DEST    0x02
-#define OFFSET_SOURCE  0x04
-#define OFFSET_OPCODE1 0x06
-#define OFFSET_OPCODE2 0x00
-#define OFFSET_PARAM1  0x02
-#define OFFSET_PARAM2  0x04
+/* The widths of the two's complement fields numbers are encoded in, see 'word_format.h'. */
+#define IMMEDIATE_BITS WORD_WIDTH_VALUE
+#define DATA_WORD_BITS WORD_FORMAT_BITS
+#define NUMBER_SEPS_STRING " ,()"
 
 #define ONE_VAR 1
 #define TWO_VARIABLES 2
@@ -92,5 +92,8 @@
 #define SRC_ASSEMBLER_FILE_EXTENSTION ".as"
 #define EXTERN_ASSEMBLER_FILE_EXTENSTION ".external"
 #define ENTRY_ASSEMBLER_FILE_EXTENSTION ".entry"
+#define OBJECT_ASSEMBLER_FILE_EXTENSTION ".object"
+#define COMPACT_OBJECT_ASSEMBLER_FILE_EXTENSTION ".cobject"
+#define LINE_CACHE_FILE_EXTENSTION ".cache"
 
 #endif
@@ -1,16 +1,249 @@
 #include "debug.h"
 #include <string.h>
 
-void print_error(char* start_pos, long line_num, errorCodes err_code)
+#define JSON_CONTROL_CHAR_LIMIT 0x20
+
+struct errorContext
+{
+	char* file; /* The file the line belongs to. */
+	char* line; /* A copy of the line. */
+	long line_num;
+	int column; /* 1 based, 0 if the diagnostic refers to the whole line. */
+	errorCodes err_code;
+};
+
+struct debugList
+{
+	int log_sz;
+	int phy_sz;
+	int errors_count;
+	int max_errors; /* The errors limit of the list, 0 for no limit. */
+	char* file; /* The file of the nodes that are registered next. */
+	errorContext* nodes; /* A dynamic array of the diagnostics, in the order they were registered. */
+};
+
+debugList* debug_list_new_list()
+{
+	debugList* dbg_list = (debugList*)xmalloc(sizeof(debugList));
+
+	dbg_list->log_sz = INIT_LOG_SZ;
+	dbg_list->phy_sz = INIT_PHY_SZ;
+	dbg_list->errors_count = 0;
+	dbg_list->max_errors = 0;
+	dbg_list->file = get_copy_string("");
+	dbg_list->nodes = (errorContext*)xcalloc(INIT_PHY_SZ, sizeof(errorContext));
+
+	return dbg_list;
+}
+
+void debug_list_set_file(debugList* dbg_list, char* path)
+{
+	free(dbg_list->file);
+	dbg_list->file = get_copy_string(path);
+}
+
+void debug_list_register_file_node(debugList* dbg_list, char* path, errorCodes err_code)
+{
+	errorContext* node;
+
+	if (dbg_list->log_sz + 1 >= dbg_list->phy_sz) {
+		GROW_CAPACITY(dbg_list->phy_sz);
+		dbg_list->nodes = GROW_ARRAY(errorContext*, dbg_list->nodes, dbg_list->phy_sz, sizeof(errorContext));
+	}
+
+	node = &dbg_list->nodes[dbg_list->log_sz++];
+	node->file = get_copy_string(path);
+	node->line = get_copy_string("");
+	node->line_num = 0;
+	node->column = 0;
+	node->err_code = err_code;
+
+	if (!is_warning_code(err_code))
+		dbg_list->errors_count++;
+}
+
+void debug_list_register_node(debugList* dbg_list, char* start_pos, char* err_pos, long line_num, errorCodes err_code)
+{
+	errorContext* node;
+
+	if (dbg_list->log_sz + 1 >= dbg_list->phy_sz) {
+		GROW_CAPACITY(dbg_list->phy_sz);
+		dbg_list->nodes = GROW_ARRAY(errorContext*, dbg_list->nodes, dbg_list->phy_sz, sizeof(errorContext));
+	}
+
+	node = &dbg_list->nodes[dbg_list->log_sz++];
+	node->file = get_copy_string(dbg_list->file);
+	node->line = get_copy_string(start_pos);
+	node->line_num = line_num;
+	node->err_code = err_code;
+
+	/* The offset between the start of the line and the error pos. */
+	node->column = (err_pos && err_pos >= start_pos && err_pos <= start_pos + strlen(start_pos)) ? (int)(err_pos - start_pos) + 1 : 0;
+
+	if (!is_warning_code(err_code))
+		dbg_list->errors_count++;
+}
+
+int debug_list_get_errors_count(debugList* dbg_list)
+{
+	return dbg_list->errors_count;
+}
+
+int debug_list_get_count(debugList* dbg_list)
+{
+	return dbg_list->log_sz;
+}
+
+errorContext* debug_list_get_node(debugList* dbg_list, int index)
+{
+	return &dbg_list->nodes[index];
+}
+
+char* error_context_get_file(errorContext* err_ctx)
+{
+	return err_ctx->file;
+}
+
+char* error_context_get_line(errorContext* err_ctx)
 {
-	char err_buff[DEBUG_LINE_MAX_LENGTH] = { 0 };
-	ptrdiff_t offset;
+	return err_ctx->line;
+}
 
-	/* Calculate the spacing between the start of the line and the error pos. */
-	sprintf(err_buff, "Line %li:", line_num);
+long error_context_get_line_num(errorContext* err_ctx)
+{
+	return err_ctx->line_num;
+}
 
-	printf("%s %s\n", err_buff, start_pos);
-	printf("Error: %s\n\n", map_token_to_err(err_code));
+int error_context_get_column(errorContext* err_ctx)
+{
+	return err_ctx->column;
+}
+
+errorCodes error_context_get_code(errorContext* err_ctx)
+{
+	return err_ctx->err_code;
+}
+
+void debug_list_move_nodes(debugList* dst, debugList* src, int begin, int end)
+{
+	errorContext* node;
+
+	for (; begin < end; begin++) {
+		if (dst->log_sz + 1 >= dst->phy_sz) {
+			GROW_CAPACITY(dst->phy_sz);
+			dst->nodes = GROW_ARRAY(errorContext*, dst->nodes, dst->phy_sz, sizeof(errorContext));
+		}
+
+		/* The strings are handed over, the source node is left empty. */
+		node = &src->nodes[begin];
+		dst->nodes[dst->log_sz++] = *node;
+		node->file = node->line = NULL;
+
+		if (!is_warning_code(node->err_code))
+			dst->errors_count++;
+	}
+}
+
+void debug_list_set_max_errors(debugList* dbg_list, int max_errors)
+{
+	dbg_list->max_errors = max_errors;
+}
+
+int debug_list_get_max_errors(debugList* dbg_list)
+{
+	return dbg_list->max_errors;
+}
+
+bool debug_list_reached_limit(debugList* dbg_list)
+{
+	return (dbg_list->max_errors > 0 && dbg_list->errors_count >= dbg_list->max_errors) ? TRUE : FALSE;
+}
+
+/* Prints a string as a json string literal, escaping quotes, backslashes and control chars. */
+static void print_json_string(FILE* out, char* str)
+{
+	fputc('"', out);
+
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			fprintf(out, "\\%c", *str);
+		else if ((unsigned char)*str < JSON_CONTROL_CHAR_LIMIT)
+			fprintf(out, "\\u%04x", (unsigned char)*str);
+		else
+			fputc(*str, out);
+	}
+
+	fputc('"', out);
+}
+
+static void print_node_text(FILE* out, errorContext* node)
+{
+	char message[ERROR_MESSAGE_MAX_LENGTH];
+
+	/* A diagnostic of the whole file has no line to show. */
+	if (node->line_num == 0) {
+		fprintf(out, "%s: %s: %s\n\n", node->file, is_warning_code(node->err_code) ? "Warning" : "Error", format_error_message(node->err_code, message));
+		return;
+	}
+
+	fprintf(out, "%s, Line %li", node->file, node->line_num);
+	if (node->column > 0)
+		fprintf(out, ", Column %d", node->column);
+
+	fprintf(out, ": %s\n%s: %s\n\n", node->line, is_warning_code(node->err_code) ? "Warning" : "Error", format_error_message(node->err_code, message));
+}
+
+static void print_node_json(FILE* out, errorContext* node)
+{
+	char message[ERROR_MESSAGE_MAX_LENGTH];
+
+	fputs("{\"file\":", out);
+	print_json_string(out, node->file);
+	fprintf(out, ",\"line\":%li,\"column\":%d,\"code\":%d,\"severity\":\"%s\",\"message\":", node->line_num, node->column, (int)node->err_code, is_warning_code(node->err_code) ? "warning" : "error");
+	print_json_string(out, format_error_message(node->err_code, message));
+	fputs(",\"source\":", out);
+	print_json_string(out, node->line);
+	fputs("}\n", out);
+}
+
+static void debug_list_free_nodes(debugList* dbg_list)
+{
+	int i;
+
+	for (i = 0; i < dbg_list->log_sz; i++) {
+		free(dbg_list->nodes[i].file);
+		free(dbg_list->nodes[i].line);
+	}
+
+	dbg_list->log_sz = 0;
+}
+
+void debug_list_flush(debugList* dbg_list, FILE* out, DiagnosticsFormat format)
+{
+	int i;
+
+	for (i = 0; i < dbg_list->log_sz; i++) {
+		if (format == DIAG_FORMAT_JSON)
+			print_node_json(out, &dbg_list->nodes[i]);
+		else
+			print_node_text(out, &dbg_list->nodes[i]);
+	}
+
+	fflush(out);
+	debug_list_free_nodes(dbg_list);
+}
+
+void debug_list_destroy(debugList** dbg_list)
+{
+	debug_list_free_nodes(*dbg_list);
+	free((*dbg_list)->nodes);
+	free((*dbg_list)->file);
+	free(*dbg_list);
+}
+
+bool is_warning_code(errorCodes code)
+{
+	return (code == ERROR_CODE_SYMBOL_IGNORED_WARN || code == ERROR_CODE_LINE_TOO_LONG_WARN) ? TRUE : FALSE;
 }
 
 char* map_token_to_err(errorCodes code)
@@ -27,7 +260,7 @@ char* map_token_to_err(errorCodes code)
 	case ERROR_CODE_SPACE_BEFORE_COLON: return "Space before colon";
 	case ERROR_CODE_INVALID_CHAR_IN_LABEL: return "Invalid character in label";
 	case ERROR_CODE_RESERVED_KEYWORD_DEF: return "Reserved keyword definition";
-	case ERROR_CODE_SYMBOL_IGNORED_WARN: return "Symbol ignored (warning)";
+	case ERROR_CODE_SYMBOL_IGNORED_WARN: return "Symbol ignored";
 	case ERROR_CODE_INVALID_AMOUNT_OF_OPERANDS: return "Invalid amount of operands";
 	case ERROR_CODE_COMMA_AFTER_INSTRUCTION: return "Comma after instruction";
 	case ERROR_CODE_MISSING_COMMA: return "Missing comma";
@@ -50,7 +283,41 @@ char* map_token_to_err(errorCodes code)
 	case ERROR_CODE_LABEL_ALREADY_EXISTS_AS_ENTRY: return "Label already defined as entry.";
 	case ERROR_CODE_LABEL_CANNOT_BE_DEFINED_AS_OPCODE_OR_REGISTER: return "Label cannot be defined as Opcode or Register";
 	case ERROR_CODE_LABEL_MISSING_OR_NON_EXISTS_OPCODE: return "OPCODE does not exists or missing";
+	case ERROR_CODE_IMMEDIATE_OUT_OF_RANGE: return "Immediate out of range";
+	case ERROR_CODE_DATA_OUT_OF_RANGE: return "Data value out of range";
+	case ERROR_CODE_DATA_IMAGE_FULL: return "Data image is full";
+	case ERROR_CODE_CODE_IMAGE_FULL: return "Instruction image is full";
+	case ERROR_CODE_LINE_TOO_LONG_WARN: return "Line is longer than 80 characters";
+	case ERROR_CODE_FILE_OPEN: return "Could not open the file";
+	case ERROR_CODE_FILE_EMPTY: return "The file is empty";
+	case ERROR_CODE_FILE_WRITE: return "Could not write the file";
+	case ERROR_CODE_MACRO_CYCLE: return "The macro expands itself";
+	case ERROR_CODE_MACRO_TOO_DEEP: return "The macros are nested too deep";
+	case ERROR_CODE_OBJECT_INVALID: return "The file isn't a valid compact object";
+	case ERROR_CODE_INCLUDE_SYNTAX: return "Expected a single quoted path after .include";
+	case ERROR_CODE_INCLUDE_OPEN: return "Could not read the included file";
+	case ERROR_CODE_INCLUDE_NESTED: return "An included file can't include other files";
+	case ERROR_CODE_MACRO_PARAMETERS: return "The parameters of the macro must be distinct names that are not opcodes or registers, separated by commas";
+	case ERROR_CODE_MACRO_ARGUMENTS: return "The amount of arguments doesn't match the parameters of the macro";
+	case ERROR_CODE_INCLUDE_UNAVAILABLE: return "The included file isn't available, the source isn't read from the disk";
 	default: return "Unknown error";
 	}
 }
 
+char* format_error_message(errorCodes code, char* message)
+{
+	int bits = 0;
+
+	/* The range of a value is the two's complement range of the field it's encoded in. */
+	if (code == ERROR_CODE_IMMEDIATE_OUT_OF_RANGE)
+		bits = IMMEDIATE_BITS;
+	else if (code == ERROR_CODE_DATA_OUT_OF_RANGE)
+		bits = DATA_WORD_BITS;
+
+	if (bits > 0)
+		sprintf(message, "%s, it must fit %d bits (%ld to %ld)", map_token_to_err(code), bits, -(1L << (bits - 1)), (1L << (bits - 1)) - 1);
+	else
+		sprintf(message, "%s", map_token_to_err(code));
+
+	return message;
+}
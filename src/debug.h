@@ -20,14 +20,29 @@ typedef enum
 	ERROR_CODE_INVALID_LABEL_DEF, ERROR_CODE_MISSING_OPEN_PAREN, ERROR_CODE_INVALID_COMMA_POS, ERROR_CODE_INVALID_INT,
 	ERROR_CODE_SPACE_AFTER_OPERAND, ERROR_CODE_INVALID_OPERAND, ERROR_CODE_INVALID_WHITE_SPACE, ERROR_CODE_EXTRA_PAREN,
 	ERROR_CODE_MISSING_OPEN_QUOTES, ERROR_CODE_MISSING_CLOSE_QUOTES, ERROR_CODE_TEXT_AFTER_END, ERROR_CODE_MISSING_OPERAND,ERROR_CODE_LABEL_DOES_NOT_EXISTS,
-	ERROR_CODE_LABEL_ALREADY_EXISTS_AS_EXTERN, ERROR_CODE_LABEL_ALREADY_EXISTS_AS_ENTRY, ERROR_CODE_LABEL_CANNOT_BE_DEFINED_AS_OPCODE_OR_REGISTER, ERROR_CODE_LABEL_MISSING_OR_NON_EXISTS_OPCODE
+	ERROR_CODE_LABEL_ALREADY_EXISTS_AS_EXTERN, ERROR_CODE_LABEL_ALREADY_EXISTS_AS_ENTRY, ERROR_CODE_LABEL_CANNOT_BE_DEFINED_AS_OPCODE_OR_REGISTER, ERROR_CODE_LABEL_MISSING_OR_NON_EXISTS_OPCODE,
+	ERROR_CODE_IMMEDIATE_OUT_OF_RANGE, ERROR_CODE_DATA_OUT_OF_RANGE, ERROR_CODE_DATA_IMAGE_FULL, ERROR_CODE_LINE_TOO_LONG_WARN,
+	ERROR_CODE_CODE_IMAGE_FULL, ERROR_CODE_FILE_OPEN, ERROR_CODE_FILE_EMPTY, ERROR_CODE_FILE_WRITE,
+	ERROR_CODE_MACRO_CYCLE, ERROR_CODE_MACRO_TOO_DEEP, ERROR_CODE_OBJECT_INVALID, ERROR_CODE_INCLUDE_SYNTAX,
+	ERROR_CODE_INCLUDE_OPEN, ERROR_CODE_INCLUDE_NESTED, ERROR_CODE_MACRO_PARAMETERS, ERROR_CODE_MACRO_ARGUMENTS,
+	ERROR_CODE_INCLUDE_UNAVAILABLE
 } errorCodes;
 
 /**
- * @brief Represents a context for an error in the assembly code.
+* @brief The formats a debug list can be flushed in.
+*/
+typedef enum { DIAG_FORMAT_TEXT, DIAG_FORMAT_JSON } DiagnosticsFormat;
+
+/**
+ * @brief Represents a context for an error in the assembly code, i.e a single diagnostic. Declaration in the '.c' file.
  */
 typedef struct errorContext errorContext;
 
+/**
+* @brief A forward declaration of the debug list, a collector of diagnostics that are flushed in one batch per file.
+*/
+typedef struct debugList debugList;
+
 /**
 * @brief Map a token code to a human readable error. This is used to display errors in debug output
 * @param code the token code to map
@@ -36,11 +51,159 @@ typedef struct errorContext errorContext;
 char* map_token_to_err(errorCodes code);
 
 /**
-* Prints an error to stderr. This is used for debugging and should not be called externally. The err_ctx and err_buff are passed by reference so it can be manipulated by the caller.
-*
-* @param err_ctx
-* @param err_buff
+* @brief The size of a buffer that holds any formatted error message.
+*/
+#define ERROR_MESSAGE_MAX_LENGTH 128
+
+/**
+* @brief Formats the human readable error of a code, the message of map_token_to_err followed by the range of the value
+* for the codes of a value that doesn't fit its field, the widths are taken from the word format.
+* @param code - The error code.
+* @param message - The buffer of the message, at least ERROR_MESSAGE_MAX_LENGTH chars.
+* @return The message.
+*/
+char* format_error_message(errorCodes code, char* message);
+
+/**
+* @brief Checks if an error code is only a warning, warnings don't fail the assembly.
+* @param code - The error code.
+* @return TRUE if the code is a warning, FALSE otherwise.
+*/
+bool is_warning_code(errorCodes code);
+
+/**
+* @brief Creates a new empty debug list.
+* @return The new debug list.
+*/
+debugList* debug_list_new_list();
+
+/**
+* @brief Sets the file the diagnostics that are registered from now on belong to.
+* @param dbg_list - The debug list.
+* @param path - The path of the file, it is copied.
+*/
+void debug_list_set_file(debugList* dbg_list, char* path);
+
+/**
+* @brief Registers a diagnostic, the line is copied so the caller may reuse its buffer.
+* @param dbg_list - The debug list.
+* @param start_pos - The start of the line the diagnostic refers to.
+* @param err_pos - The offending char inside the line, used for the column. NULL if the diagnostic refers to the whole line.
+* @param line_num - The number of the line in the file.
+* @param err_code - The error code.
+*/
+void debug_list_register_node(debugList* dbg_list, char* start_pos, char* err_pos, long line_num, errorCodes err_code);
+
+/**
+* @brief Registers a diagnostic of a whole file, i.e a file that can't be opened. It's reported with line 0.
+* @param dbg_list - The debug list.
+* @param path - The file the diagnostic refers to.
+* @param err_code - The error code.
+*/
+void debug_list_register_file_node(debugList* dbg_list, char* path, errorCodes err_code);
+
+/**
+* @brief Returns the amount of errors (not including warnings) that were registered.
+* @param dbg_list - The debug list.
+* @return The amount of errors.
+*/
+int debug_list_get_errors_count(debugList* dbg_list);
+
+/**
+* @brief Returns the amount of diagnostics (including warnings) in the list.
+* @param dbg_list - The debug list.
+* @return The amount of diagnostics.
+*/
+int debug_list_get_count(debugList* dbg_list);
+
+/**
+* @brief Returns a diagnostic of the list, in the order they were registered.
+* @param dbg_list - The debug list.
+* @param index - The index of the diagnostic, below debug_list_get_count.
+* @return The diagnostic, owned by the list until it's flushed.
+*/
+errorContext* debug_list_get_node(debugList* dbg_list, int index);
+
+/**
+* @brief Returns the file a diagnostic belongs to.
+* @param err_ctx - The diagnostic.
+* @return The path of the file.
+*/
+char* error_context_get_file(errorContext* err_ctx);
+
+/**
+* @brief Returns the line a diagnostic refers to.
+* @param err_ctx - The diagnostic.
+* @return The text of the line, empty for a diagnostic of the whole file.
+*/
+char* error_context_get_line(errorContext* err_ctx);
+
+/**
+* @brief Returns the number of the line a diagnostic refers to.
+* @param err_ctx - The diagnostic.
+* @return The number of the line, 0 for a diagnostic of the whole file.
+*/
+long error_context_get_line_num(errorContext* err_ctx);
+
+/**
+* @brief Returns the column a diagnostic refers to.
+* @param err_ctx - The diagnostic.
+* @return The column, 1 based, 0 if the diagnostic refers to the whole line.
+*/
+int error_context_get_column(errorContext* err_ctx);
+
+/**
+* @brief Returns the code of a diagnostic.
+* @param err_ctx - The diagnostic.
+* @return The error code.
+*/
+errorCodes error_context_get_code(errorContext* err_ctx);
+
+/**
+* @brief Moves a range of diagnostics from one list to the end of another, keeping their order.
+* Used to merge the diagnostics that were collected on other threads in the order of the lines.
+* @param dst - The list to append to.
+* @param src - The list to move from, the moved diagnostics are left empty in it.
+* @param begin - The index of the first diagnostic to move.
+* @param end - The index after the last diagnostic to move.
+*/
+void debug_list_move_nodes(debugList* dst, debugList* src, int begin, int end);
+
+/**
+* @brief Sets the amount of errors after which the passes stop processing the file.
+* @param dbg_list - The debug list.
+* @param max_errors - The errors limit, 0 for no limit.
+*/
+void debug_list_set_max_errors(debugList* dbg_list, int max_errors);
+
+/**
+* @brief Returns the amount of errors after which the passes stop processing the file.
+* @param dbg_list - The debug list.
+* @return The errors limit, 0 for no limit.
+*/
+int debug_list_get_max_errors(debugList* dbg_list);
+
+/**
+* @brief Checks if the errors limit of the list was reached, warnings are not counted.
+* @param dbg_list - The debug list.
+* @return TRUE if the limit was reached, FALSE otherwise or if there is no limit.
+*/
+bool debug_list_reached_limit(debugList* dbg_list);
+
+/**
+* @brief Formats all the registered diagnostics into a stream in one batch, and empties the list.
+* The text format prints the file, line and column of each diagnostic followed by the line and the error,
+* the json format prints each diagnostic as a single line json object (json lines).
+* @param dbg_list - The debug list.
+* @param out - The stream to flush to.
+* @param format - The format.
+*/
+void debug_list_flush(debugList* dbg_list, FILE* out, DiagnosticsFormat format);
+
+/**
+* @brief Frees a debug list, including the diagnostics that were not flushed.
+* @param dbg_list - The debug list to free.
 */
-void print_error(errorContext* err_ctx);
+void debug_list_destroy(debugList** dbg_list);
 
-#endif
\ No newline at end of file
+#endif
@@ -1,21 +1,80 @@
 #include "driver.h"
-#include "pre_assembler.h"
-#include "memory.h"
+#include "assembly.h"
 #include "debug.h"
-#include "first_pass.h"
-#include "second_pass.h"
+#include "parallel.h"
+#include "batch.h"
+#include "watch.h"
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
 
 struct driver {
-    SymbolTable* sym_table;
-    memoryBuffer* mem_buffer;
+    DiagnosticsFormat diag_format;
+    int max_errors; /* The errors limit of a single file, 0 for no limit. */
+    int max_total_errors; /* The errors limit of the whole run, 0 for no limit. */
+    int total_errors; /* The errors of the files that were processed so far. */
+    int jobs; /* The maximal amount of threads a pass may use. */
+    bool show_stats; /* Print what every worker of the batch did. */
+    bool use_uring; /* Read and write the files of the batch on io_uring, when it's available. */
+    bool is_framed; /* Write all the outputs of the standard input to the standard output, not only the object. */
+    OutputSink* sink; /* Where the outputs of the files are written. */
+    bool is_sink_stdout; /* The outputs are written to the standard output, so the diagnostics go to the standard error. */
+    ObjectFormat object_format;
+    bool is_decoding; /* The files are compact objects to decode, not sources. */
+    bool is_watching; /* After the first run the files are assembled again whenever they change. */
+    bool is_incremental; /* The lines that didn't change since the previous run are taken from the line caches of the files. */
+    FILE* diag_out; /* The stream the diagnostics are written to. */
 };
 
 #define FIRST_PASS_FAILED 1
 #define SECOND_PASS_FAILED 2
 
+#define OPTION_PREFIX "--"
+#define DIAGNOSTICS_OPTION "--diagnostics="
+#define DIAGNOSTICS_TEXT "text"
+#define DIAGNOSTICS_JSON "json"
+#define MAX_ERRORS_OPTION "--max-errors"
+#define MAX_TOTAL_ERRORS_OPTION "--max-total-errors"
+#define JOBS_OPTION "--jobs"
+#define STATS_OPTION "--stats"
+#define IO_OPTION "--io="
+#define IO_STDIO "stdio"
+#define IO_URING "uring"
+#define FRAMED_OPTION "--framed"
+#define OUTPUT_OPTION "--output="
+#define OUTPUT_FILES "files"
+#define OUTPUT_STDOUT "stdout"
+#define OUTPUT_NULL "null"
+#define STDOUT_FD 1
+#define OBJECT_OPTION "--object="
+#define OBJECT_TEXT "text"
+#define OBJECT_COMPACT "compact"
+#define DECODE_OBJECT_OPTION "--decode-object"
+#define WATCH_OPTION "--watch"
+#define INCREMENTAL_OPTION "--incremental"
+#define STDIN_FILE "-"
+#define STDIN_NAME "stdin"
+#define OPTION_VALUE_CHAR '='
+#define DECIMAL_BASE 10
+
 Driver* driver_new_driver()
 {
     Driver* driver = (Driver*)xmalloc(sizeof(Driver));
+    driver->diag_format = DIAG_FORMAT_TEXT;
+    driver->max_errors = 0;
+    driver->max_total_errors = 0;
+    driver->total_errors = 0;
+    driver->jobs = parallel_get_cpu_count();
+    driver->show_stats = FALSE;
+    driver->use_uring = FALSE;
+    driver->is_framed = FALSE;
+    driver->sink = output_sink_get_files();
+    driver->is_sink_stdout = FALSE;
+    driver->object_format = OBJECT_FORMAT_TEXT;
+    driver->is_decoding = FALSE;
+    driver->is_watching = FALSE;
+    driver->is_incremental = FALSE;
+    driver->diag_out = stdout;
     return driver;
 }
 
@@ -24,50 +83,435 @@ int driver_exec(Driver* driver, int argc, char** argv)
     return exec_impl(driver, argc, argv);
 }
 
-int exec_impl(Driver* driver, int argc, char** argv)
+/* Parses a non negative count, the whole string must be a decimal number. */
+static bool parse_count(char* str, int* out)
+{
+    char* end = NULL;
+    long value;
+
+    if (str == NULL || *str == '\0')
+        return FALSE;
+
+    value = strtol(str, &end, DECIMAL_BASE);
+    if (*end != '\0' || value < 0 || value > INT_MAX)
+        return FALSE;
+
+    *out = (int)value;
+    return TRUE;
+}
+
+/* Parses an option that takes a count, either as '--name N' or as '--name=N'. Returns the amount of args consumed. */
+static int parse_count_option(char* name, char** args, int count, int* out)
+{
+    size_t len = strlen(name);
+
+    if (strncmp(args[0], name, len) != 0)
+        return 0;
+
+    if (args[0][len] == OPTION_VALUE_CHAR)
+        return parse_count(args[0] + len + 1, out) ? 1 : 0;
+
+    if (args[0][len] == '\0' && count > 1)
+        return parse_count(args[1], out) ? 2 : 0;
+
+    return 0;
+}
+
+int parse_option(Driver* driver, char** args, int count)
 {
+    char* value;
+    int consumed;
+
+    if (strncmp(args[0], DIAGNOSTICS_OPTION, strlen(DIAGNOSTICS_OPTION)) == 0) {
+        value = args[0] + strlen(DIAGNOSTICS_OPTION);
+
+        if (strcmp(value, DIAGNOSTICS_TEXT) == 0)
+            driver->diag_format = DIAG_FORMAT_TEXT;
+        else if (strcmp(value, DIAGNOSTICS_JSON) == 0)
+            driver->diag_format = DIAG_FORMAT_JSON;
+        else
+            return 0;
+
+        return 1;
+    }
+
+    if (strcmp(args[0], FRAMED_OPTION) == 0) {
+        driver->is_framed = TRUE;
+        return 1;
+    }
+
+    if (strcmp(args[0], WATCH_OPTION) == 0) {
+        driver->is_watching = TRUE;
+        return 1;
+    }
+
+    if (strcmp(args[0], INCREMENTAL_OPTION) == 0) {
+        driver->is_incremental = TRUE;
+        return 1;
+    }
+
+    if (strcmp(args[0], DECODE_OBJECT_OPTION) == 0) {
+        driver->is_decoding = TRUE;
+        return 1;
+    }
+
+    if (strncmp(args[0], OBJECT_OPTION, strlen(OBJECT_OPTION)) == 0) {
+        value = args[0] + strlen(OBJECT_OPTION);
+
+        if (strcmp(value, OBJECT_TEXT) == 0)
+            driver->object_format = OBJECT_FORMAT_TEXT;
+        else if (strcmp(value, OBJECT_COMPACT) == 0)
+            driver->object_format = OBJECT_FORMAT_COMPACT;
+        else
+            return 0;
+
+        return 1;
+    }
+
+    if (strcmp(args[0], STATS_OPTION) == 0) {
+        driver->show_stats = TRUE;
+        return 1;
+    }
+
+    if (strncmp(args[0], IO_OPTION, strlen(IO_OPTION)) == 0) {
+        value = args[0] + strlen(IO_OPTION);
+
+        if (strcmp(value, IO_STDIO) == 0)
+            driver->use_uring = FALSE;
+        else if (strcmp(value, IO_URING) == 0)
+            driver->use_uring = TRUE;
+        else
+            return 0;
+
+        return 1;
+    }
+
+    if (strncmp(args[0], OUTPUT_OPTION, strlen(OUTPUT_OPTION)) == 0) {
+        value = args[0] + strlen(OUTPUT_OPTION);
+
+        if (strcmp(value, OUTPUT_FILES) != 0 && strcmp(value, OUTPUT_STDOUT) != 0 && strcmp(value, OUTPUT_NULL) != 0)
+            return 0;
+
+        /* An option that is given again replaces the sink before it, only the fd sink is owned. */
+        output_sink_destroy(&driver->sink);
+        driver->is_sink_stdout = (strcmp(value, OUTPUT_STDOUT) == 0) ? TRUE : FALSE;
+        if (driver->is_sink_stdout)
+            driver->sink = output_sink_new_fd(STDOUT_FD, TRUE);
+        else
+            driver->sink = (strcmp(value, OUTPUT_NULL) == 0) ? output_sink_get_null() : output_sink_get_files();
+
+        return 1;
+    }
+
+    if ((consumed = parse_count_option(MAX_TOTAL_ERRORS_OPTION, args, count, &driver->max_total_errors)) > 0)
+        return consumed;
+
+    if ((consumed = parse_count_option(JOBS_OPTION, args, count, &driver->jobs)) > 0) {
+        if (driver->jobs == 0)
+            driver->jobs = parallel_get_cpu_count();
+        return consumed;
+    }
+
+    return parse_count_option(MAX_ERRORS_OPTION, args, count, &driver->max_errors);
+}
+
+/* Writes the diagnostics of a file that was assembled, the files are reported in the order of the command line. */
+static void report_file(Driver* driver, Assembly* assembly)
+{
+    debugList* dbg_list = assembly_get_debug_list(assembly);
+
+    /* The diagnostics of the file are written in one batch, json output is kept free of other messages. */
+    debug_list_flush(dbg_list, driver->diag_out, driver->diag_format);
+    if (driver->diag_format == DIAG_FORMAT_TEXT) {
+        if (assembly_succeeded(assembly))
+            fprintf(driver->diag_out, "\n~~~\nProcess completed successfully\n~~~\n");
+        else if (debug_list_reached_limit(dbg_list))
+            fprintf(driver->diag_out, "Too many errors, stopped processing %s\n", assembly_get_src_path(assembly));
+    }
+
+    driver->total_errors += debug_list_get_errors_count(dbg_list);
+}
+
+/* The errors limit of the next file, it may not spend more than what is left of the budget of the whole run. */
+static int get_file_max_errors(Driver* driver)
+{
+    int max_errors = driver->max_errors, remaining;
+
+    if (driver->max_total_errors > 0) {
+        remaining = driver->max_total_errors - driver->total_errors;
+        if (max_errors == 0 || remaining < max_errors)
+            max_errors = remaining;
+    }
+
+    return max_errors;
+}
+
+/* The budget of the whole run depends on the errors of the files before, so the files are assembled one after the other. */
+static void assemble_serially(Driver* driver, char** files, int count)
+{
+    Assembly* assembly;
     int i;
-    char* src_path = NULL, *pre_assembler_path = NULL;
 
-    if (argc <= 1) {
-	    printf("Usage: ./exe_name <files...>\n");
-	    return 1;
+    for (i = 0; i < count; i++) {
+        assembly = assembly_new(files[i], driver->jobs, get_file_max_errors(driver));
+
+        assembly_set_object_format(assembly, driver->object_format);
+        assembly_set_incremental(assembly, driver->is_incremental);
+
+        /* The outputs go to the disk as they are made, any other sink gets them once the file is assembled. */
+        if (!output_sink_is_files(driver->sink))
+            assembly_defer_outputs(assembly, driver->sink);
+        assembly_run(assembly);
+        assembly_write_outputs(assembly);
+        report_file(driver, assembly);
+        assembly_destroy(&assembly);
+
+        /* The budget of the whole run is spent, the rest of the files are not processed. */
+        if (driver->max_total_errors > 0 && driver->total_errors >= driver->max_total_errors && i + 1 < count) {
+            if (driver->diag_format == DIAG_FORMAT_TEXT)
+                fprintf(driver->diag_out, "Too many errors, skipped the remaining %d file(s)\n", count - i - 1);
+            break;
+        }
     }
+}
 
-    for (i = 1; i < argc; i++) {
-        src_path = get_outfile_name(argv[i], SRC_ASSEMBLER_FILE_EXTENSTION);
-        start_pre_assembler(src_path);
-        pre_assembler_path = get_outfile_name(src_path, PRE_ASSEMBLER_FILE_EXTENSTION);
+static void print_worker_stats(char* name, int id, SchedulerWorkerStats* stats)
+{
+    fprintf(stderr, "%s %d: %d file(s), %d stolen, busy %.3fs of %.3fs (%.0f%%)\n", name, id, stats->items, stats->stolen,
+            stats->busy_seconds, stats->total_seconds, stats->total_seconds > 0 ? 100 * stats->busy_seconds / stats->total_seconds : 0.0);
+}
 
-        on_initialization(driver);
+static void print_stats(Batch* batch)
+{
+    Scheduler* scheduler = batch_get_scheduler(batch);
+    SchedulerWorkerStats stats, writer_stats;
+    int i;
 
-        /* If first pass failed returns false, otherwise returns true, goes as same for second pass */
-        if (do_first_pass(pre_assembler_path, driver->mem_buffer, driver->sym_table))
-            if (initiate_second_pass(pre_assembler_path, driver->sym_table, driver->mem_buffer))
-                printf("\n~~~\nProcess completed successfully\n~~~\n");
+    /* stderr, so the stats don't mix with the json diagnostics. */
+    fprintf(stderr, "io: %s\n", batch_is_uring_enabled(batch) ? "io_uring" : "stdio");
+    batch_get_stage_stats(batch, &stats, &writer_stats);
+    print_worker_stats("reader", 0, &stats);
 
-        on_exit(driver);
-        free(pre_assembler_path);
-        free(src_path);
+    for (i = 0; i < scheduler_get_workers_count(scheduler); i++) {
+        scheduler_get_stats(scheduler, i, &stats);
+        print_worker_stats("worker", i, &stats);
     }
 
-    return 0;
+    print_worker_stats("writer", 0, &writer_stats);
+}
+
+/* The files are read, assembled and written by a pipeline of stages, and reported in the order of the command line as they complete. */
+static void assemble_pipelined(Driver* driver, char** files, int count)
+{
+    Batch* batch = batch_new(files, count, driver->jobs, driver->max_errors);
+    Assembly* assembly;
+    int i;
+
+    batch_set_output_sink(batch, driver->sink);
+    batch_set_object_format(batch, driver->object_format);
+    batch_set_incremental(batch, driver->is_incremental);
+
+    /* Without io_uring the batch silently keeps the stdio path. */
+    if (driver->use_uring)
+        batch_enable_uring(batch);
+
+    batch_start(batch);
+    for (i = 0; i < count; i++) {
+        assembly = batch_wait(batch, i);
+        report_file(driver, assembly);
+        assembly_destroy(&assembly);
+    }
+    batch_join(batch);
+
+    if (driver->show_stats)
+        print_stats(batch);
+
+    batch_destroy(&batch);
+}
+
+/* The source is read from the standard input and the outputs are written to the standard output, no file is read or written on the disk.
+*  Returns the exit status, so the assembler can be checked inside a pipeline. */
+static int assemble_stream(Driver* driver)
+{
+    Assembly* assembly = assembly_new(STDIN_NAME, driver->jobs, get_file_max_errors(driver));
+    bool succeeded;
+
+    /* The standard output holds the object, the diagnostics are written to the standard error. */
+    driver->diag_out = stderr;
+    assembly_defer_outputs(assembly, output_sink_get_null());
+    assembly_set_object_format(assembly, driver->object_format);
+
+    /* The store is sealed, a source that isn't in it and the files it includes are never opened from the disk. */
+    file_store_seal(assembly_get_file_store(assembly), NULL, NULL);
+    if (!assembly_load_source_stream(assembly, stdin))
+        debug_list_register_file_node(assembly_get_debug_list(assembly), assembly_get_src_path(assembly), ERROR_CODE_FILE_OPEN);
+    else if (assembly_run(assembly))
+        assembly_write_outputs_stream(assembly, stdout, driver->is_framed);
+
+    report_file(driver, assembly);
+    succeeded = assembly_succeeded(assembly);
+    assembly_destroy(&assembly);
+
+    return succeeded ? 0 : 1;
+}
+
+/* Decodes compact objects into text objects on the standard output, one after the other in the order of the command line.
+*  Returns the exit status, 1 if any file couldn't be decoded. */
+static int decode_objects(Driver* driver, char** files, int count)
+{
+    FileStore* store = file_store_new(FALSE, output_sink_get_null());
+    debugList* dbg_list = debug_list_new_list();
+    FileBuffer file;
+    char* text;
+    size_t text_size;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (!file_store_load(store, files[i]) || !file_store_get_file(store, files[i], &file))
+            debug_list_register_file_node(dbg_list, files[i], ERROR_CODE_FILE_OPEN);
+        else if (!object_codec_decode_compact(file.data, file.size, &text, &text_size))
+            debug_list_register_file_node(dbg_list, files[i], ERROR_CODE_OBJECT_INVALID);
+        else {
+            fwrite(text, sizeof(char), text_size, stdout);
+            free(text);
+        }
+    }
+
+    /* The standard output holds the objects, the diagnostics are written to the standard error. */
+    i = debug_list_get_errors_count(dbg_list);
+    debug_list_flush(dbg_list, stderr, driver->diag_format);
+    debug_list_destroy(&dbg_list);
+    file_store_destroy(&store);
+
+    return (i > 0) ? 1 : 0;
+}
+
+static void assemble_files(Driver* driver, char** files, int count)
+{
+    if (driver->max_total_errors > 0)
+        assemble_serially(driver, files, count);
+    else
+        assemble_pipelined(driver, files, count);
+
+    /* The diagnostics may go to a pipe, they are seen as soon as the files were assembled. */
+    fflush(driver->diag_out);
+}
+
+/* Assembles the files, then assembles again the files whose contents changed, until the files can't be watched anymore.
+*  The process stays up between the changes, so only the changed files are read and the tables of the assembler are already built.
+*  Returns the exit status. */
+static int watch_files(Driver* driver, char** files, int count)
+{
+    /* The watcher is started first, a file that is saved during the first run is assembled again. */
+    Watcher* watcher = watcher_new(files, count);
+    char** changed = (char**)xcalloc(count, sizeof(char*));
+    int changed_count, i;
+
+    if (!watcher) {
+        fprintf(stderr, "The files can't be watched, inotify isn't available or their directories don't exist\n");
+        free(changed);
+        return 1;
+    }
+
+    assemble_files(driver, files, count);
+    while ((changed_count = watcher_wait(watcher, changed)) > 0) {
+        for (i = 0; i < changed_count && driver->diag_format == DIAG_FORMAT_TEXT; i++)
+            fprintf(driver->diag_out, "\n%s changed\n", changed[i]);
+
+        /* Every change has a budget of its own. */
+        driver->total_errors = 0;
+        assemble_files(driver, changed, changed_count);
+    }
+
+    watcher_destroy(&watcher);
+    free(changed);
+    return 1;
 }
 
-void on_initialization(Driver* driver)
+/* Returns whether the standard input is one of the files, it's only valid on its own. */
+static bool has_stdin_file(char** files, int count)
 {
-    driver->sym_table = symbol_table_new_table();
-    driver->mem_buffer = memory_buffer_get_new();
+    int i;
+
+    for (i = 0; i < count; i++)
+        if (strcmp(files[i], STDIN_FILE) == 0)
+            return TRUE;
+
+    return FALSE;
 }
 
-void on_exit(Driver* driver)
+int exec_impl(Driver* driver, int argc, char** argv)
 {
-    symbol_table_destroy(&driver->sym_table);
-    memory_buffer_destroy(&driver->mem_buffer);
+    int i, consumed, files_count = 0;
+    char** files = (char**)xcalloc(argc, sizeof(char*));
+    bool is_valid = TRUE;
+
+    /* The options may appear anywhere, they apply to all the files. */
+    for (i = 1; i < argc; i += consumed) {
+        consumed = 1;
+
+        if (strncmp(argv[i], OPTION_PREFIX, strlen(OPTION_PREFIX)) != 0) {
+            files[files_count++] = argv[i];
+        }
+        else if ((consumed = parse_option(driver, argv + i, argc - i)) == 0) {
+            printf("Unknown or invalid option %s\n", argv[i]);
+            is_valid = FALSE;
+            consumed = 1;
+        }
+    }
+
+    if (is_valid && files_count > 1 && has_stdin_file(files, files_count)) {
+        printf("The standard input can't be assembled together with other files\n");
+        is_valid = FALSE;
+    }
+
+    if (is_valid && driver->is_watching && has_stdin_file(files, files_count)) {
+        printf("The standard input can't be watched\n");
+        is_valid = FALSE;
+    }
+
+    /* The line cache is kept next to the source, the standard input has no place for it. */
+    if (is_valid && driver->is_incremental && has_stdin_file(files, files_count)) {
+        printf("The standard input can't be assembled incrementally\n");
+        is_valid = FALSE;
+    }
+
+    if (!is_valid || files_count == 0) {
+	    printf("Usage: ./exe_name [--diagnostics=text|json] [--max-errors N] [--max-total-errors N] [--jobs N] [--stats] [--io=stdio|uring] [--output=files|stdout|null] [--object=text|compact] [--watch] [--incremental] [--framed] <files...|->\n"
+	           "       ./exe_name --decode-object <compact objects...>\n");
+	    free(files);
+	    return 1;
+    }
+
+    if (driver->is_decoding) {
+        i = decode_objects(driver, files, files_count);
+        free(files);
+        return i;
+    }
+
+    if (has_stdin_file(files, files_count)) {
+        free(files);
+        return assemble_stream(driver);
+    }
+
+    /* The standard output holds the outputs, the diagnostics are written to the standard error. */
+    if (driver->is_sink_stdout)
+        driver->diag_out = stderr;
+
+    if (driver->is_watching) {
+        i = watch_files(driver, files, files_count);
+        free(files);
+        return i;
+    }
+
+    assemble_files(driver, files, files_count);
+
+    free(files);
+    return 0;
 }
 
 void driver_destroy(Driver** driver)
 {
+	output_sink_destroy(&(*driver)->sink);
 	free(*driver);
 }
-
@@ -4,6 +4,8 @@
 /** @file
 */
 
+#include "utils.h"
+
 /**
 * @brief Forward decleration for the programs driver. 
 */
@@ -49,17 +51,12 @@ void driver_destroy(Driver** driver);
 int exec_impl(Driver* driver, int argc, char** argv);
 
 /**
-* @brief Called when the driver is initialized. 
-* This is where we initialize the data structures that are used to store debug information. 
-* @param driver - The driver to initialize.
-*/
-void on_initialization(Driver* driver);
-
-/**
-* @brief Called when the module is unloaded.
-* Destroys all memory allocated by the module. This is the last function called to clean up the module's data structures.
-* @param driver - the driver to release
+* @brief Parses a command line option, i.e '--diagnostics=json' or '--max-errors 10'.
+* @param driver - The driver.
+* @param args - The option followed by the rest of the command line args, for options that take a value.
+* @param count - The amount of args in 'args'.
+* @return The amount of args the option consumed, 0 if the option is unknown or its value is invalid.
 */
-void on_exit(Driver* driver);
+int parse_option(Driver* driver, char** args, int count);
 
 #endif
@@ -11,151 +11,116 @@ struct VarData
 	int total;
 };
 
-void encode_dot_string(LineIterator* it, memoryBuffer* img)
+bool encode_dot_string(Token* operands, int count, memoryBuffer* img)
 {
-	char* closeQuote = strrchr(it->current, QUOTE_CHAR);
+	imageMemory* data_img = memory_buffer_get_data_img(img);
+	char* current = NULL, * close_quote = NULL;
 
-	/* Eat all blanks */
-	line_iterator_consume_blanks(it);
+	/* The string token includes its quotes, the syntax was already validated. */
+	if (count > 0 && operands[0].type == TOKEN_STRING) {
+		current = operands[0].start + 1;
+		close_quote = operands[0].start + operands[0].length - 1;
+	}
 
-	/* Eat quote */
-	line_iterator_advance(it);
+	/* Every char takes a word, and one more for the '\0'. */
+	if (!img_memory_reserve(data_img, (int)(close_quote - current) + 1))
+		return FALSE;
 
-	while (!line_iterator_is_end(it) && it->current < closeQuote) {
-		set_image_memory(memory_buffer_get_data_img(img), line_iterator_peek(it), FLAG_ERA | FLAG_SOURCE | FLAG_DEST | FLAG_OPCODE1);
-		img_memory_set_counter(memory_buffer_get_data_img(img), img_memory_get_counter(memory_buffer_get_data_img(img)) + 1);
-		line_iterator_advance(it);
-	}
+	for (; current < close_quote; current++)
+		img_memory_push_word(data_img, (unsigned char)*current);
 
-	set_image_memory(memory_buffer_get_data_img(img), BACKSLASH_ZERO, FLAG_ERA | FLAG_SOURCE | FLAG_DEST | FLAG_OPCODE1);
-	img_memory_set_counter(memory_buffer_get_data_img(img), img_memory_get_counter(memory_buffer_get_data_img(img)) + 1);
+	img_memory_push_word(data_img, BACKSLASH_ZERO);
+	return TRUE;
 }
 
-void encode_dot_data(LineIterator* it, memoryBuffer* img)
+bool encode_dot_data(Token* operands, int count, memoryBuffer* img)
 {
-	char* word;
+	imageMemory* data_img = memory_buffer_get_data_img(img);
+	char* end = NULL;
+	int i, num = 0, values = 0;
 
-	while ((word = line_iterator_next_word(it, COMMA_STRING))) {
-		unsigned int num = get_num(word);
-		encode_integer(memory_buffer_get_data_img(img), num);
+	/* Every value is an immediate token, the commas between them are skipped. */
+	for (i = 0; i < count; i++)
+		values += (operands[i].type == TOKEN_IMMEDIATE) ? 1 : 0;
 
-		/* Consume blanks and comma */
-		line_iterator_consume_blanks(it);
-		line_iterator_advance(it);
+	if (!img_memory_reserve(data_img, values))
+		return FALSE;
 
-		/* Free the extracted word. */
-		free(word);
+	for (i = 0; i < count; i++) {
+		if (operands[i].type == TOKEN_IMMEDIATE) {
+			(void)scan_int(operands[i].start, NUMBER_SEPS_STRING, DATA_WORD_BITS, &num, &end);
+			img_memory_push_word(data_img, (unsigned int)num);
+		}
 	}
+
+	return TRUE;
 }
 
-void encode_label_start_process(LineIterator* it, memoryBuffer* img, SymbolTable* symTable) {
+VarData* extract_label_operands(LineIterator* it, SyntaxGroups* synGroup) {
 	VarData* variables = NULL;
 	char* opcode = NULL;
-	SyntaxGroups synGroup;
 
 	line_iterator_reset(it);
 	line_iterator_jump_to(it, COLON_CHAR);
 
 	opcode = line_iterator_next_word(it, SPACE_STRING);
-	synGroup = get_syntax_group(opcode);
+	*synGroup = get_syntax_group(opcode);
 
-	if (synGroup == SG_GROUP_1 || synGroup == SG_GROUP_2 || synGroup == SG_GROUP_7) {
+	if (*synGroup == SG_GROUP_1 || *synGroup == SG_GROUP_2 || *synGroup == SG_GROUP_7) {
 		variables = extract_variables_group_1_and_2_and_7(it);
-
 	}
-	else if (synGroup == SG_GROUP_3 || synGroup == SG_GROUP_6) {
+	else if (*synGroup == SG_GROUP_3 || *synGroup == SG_GROUP_6) {
 		variables = extract_variables_group_3_and_6(it);
 	}
-	else if (synGroup == SG_GROUP_5) {
+	else if (*synGroup == SG_GROUP_5) {
 		variables = extract_variables_group_5(it);
 	}
 
-	if (!variables) {
-		free(opcode);
-		return;
-	}
-
-	/*encode ARE missing*/
-	encode_labels(variables, synGroup, symTable, memory_buffer_get_inst_img(img));
-	varData_destroy(&variables);
 	free(opcode);
+	return variables;
 }
 
-void encode_integer(imageMemory* img, unsigned int num)
+/* ORs the fields of a word into the word at the counter. */
+static void encode_current_word(imageMemory* img, unsigned int bits)
 {
-	/* Copy first 8 bits */
-	set_image_memory(img, num & BYTE_MASK, FLAG_ERA | FLAG_SOURCE | FLAG_DEST | FLAG_OPCODE1);
+	img_memory_or_word(img, img_memory_get_counter(img), bits);
+}
 
-	/* Copy second 8 bits */
-	set_image_memory(img, (num & WORD_MASK) >> START_OFFSET_SECOND_BYTE, FLAG_OPCODE2 | FLAG_PARAM1 | FLAG_PARAM2);
+void encode_integer(imageMemory* img, unsigned int num)
+{
+	encode_current_word(img, num & WORD_FORMAT_MASK);
 	img_memory_set_counter(img, img_memory_get_counter(img) + 1);
 }
 
-/**
-* Constans for the different offsets of the memory word fields.
-*/
-#define OFFSET_ERA     0x00
-#define OFFSET_DEST    0x02
-#define OFFSET_SOURCE  0x04
-#define OFFSET_OPCODE1 0x06
-#define OFFSET_OPCODE2 0x00
-#define OFFSET_PARAM1  0x02
-#define OFFSET_PARAM2  0x04
-
-void encode_preceding_word(imageMemory* img, Opcodes op, char* source, char* dest, bool is_jmp_label)
+void encode_preceding_word(imageMemory* img, Opcodes op, Token* source, Token* dest, bool is_jmp_label)
 {
-	set_image_memory(img, op << OFFSET_OPCODE1, FLAG_OPCODE1);
-	set_image_memory(img, (op >> 2) << OFFSET_OPCODE2, FLAG_OPCODE2);
+	unsigned int bits = WORD_FIELD(OPCODE, op);
 
 	if (is_jmp_label) {
-		set_image_memory(img, ADDRESSING_PARAM << OFFSET_DEST, FLAG_DEST);
-
-		if (source) {
-			if (*source == HASH_CHAR)
-				set_image_memory(img, ADDRESSING_IMM << OFFSET_PARAM2, FLAG_PARAM2);
-			else if (cmp_register_name(source))
-				set_image_memory(img, ADDRESSING_REG << OFFSET_PARAM2, FLAG_PARAM2);
-			else
-				set_image_memory(img, ADDRESSING_DIR << OFFSET_PARAM2, FLAG_PARAM2);
-		}
-		if (dest) {
-			if (*dest == HASH_CHAR)
-				set_image_memory(img, ADDRESSING_IMM << OFFSET_PARAM1, FLAG_PARAM1);
-			else if (cmp_register_name(dest))
-				set_image_memory(img, ADDRESSING_REG << OFFSET_PARAM1, FLAG_PARAM1);
-			else
-				set_image_memory(img, ADDRESSING_DIR << OFFSET_PARAM1, FLAG_PARAM1);
-		}
+		bits |= WORD_FIELD(DEST, ADDRESSING_PARAM);
+
+		if (source)
+			bits |= WORD_FIELD(PARAM2, get_token_addressing(source));
+		if (dest)
+			bits |= WORD_FIELD(PARAM1, get_token_addressing(dest));
 	}
 	else {
-		if (source) {
-			if (*source == HASH_CHAR)
-				set_image_memory(img, ADDRESSING_IMM << OFFSET_SOURCE, FLAG_SOURCE);
-			else if (cmp_register_name(source))
-				set_image_memory(img, ADDRESSING_REG << OFFSET_SOURCE, FLAG_SOURCE);
-			else
-				set_image_memory(img, ADDRESSING_DIR << OFFSET_SOURCE, FLAG_SOURCE);
-		}
-
-		if (dest) {
-			if (*dest == HASH_CHAR)
-				set_image_memory(img, ADDRESSING_IMM << OFFSET_DEST, FLAG_DEST);
-			else if (cmp_register_name(dest))
-				set_image_memory(img, ADDRESSING_REG << OFFSET_DEST, FLAG_DEST);
-			else
-				set_image_memory(img, ADDRESSING_DIR << OFFSET_DEST, FLAG_DEST);
-		}
+		if (source)
+			bits |= WORD_FIELD(SOURCE, get_token_addressing(source));
+		if (dest)
+			bits |= WORD_FIELD(DEST, get_token_addressing(dest));
 	}
+
+	encode_current_word(img, bits);
 	img_memory_set_counter(img, img_memory_get_counter(img) + 1);
 }
 
-void encode_opcode(LineIterator* it, memoryBuffer* img)
+void encode_opcode(Token* tokens, int count, memoryBuffer* img)
 {
-	char* opcode = line_iterator_next_word(it, SPACE_STRING);
-	Opcodes op = get_opcode(opcode);
-	SyntaxGroups group = get_syntax_group(opcode);
+	Opcodes op = (count > 0 && tokens[0].type == TOKEN_MNEMONIC) ? (Opcodes)tokens[0].value : OP_UNKNOWN;
+	SyntaxGroups group = get_opcode_syntax_group(op);
 
-	typedef void (*dispatchTable)(LineIterator*, Opcodes, memoryBuffer*);
+	typedef void (*dispatchTable)(Token*, int, Opcodes, memoryBuffer*);
 
 	dispatchTable table[] = {
 		encode_syntax_group_1, encode_syntax_group_2, encode_syntax_group_3,
@@ -163,47 +128,40 @@ void encode_opcode(LineIterator* it, memoryBuffer* img)
 		encode_syntax_group_7
 	};
 
-	if (group != SG_GROUP_INVALID) table[group](it, op, img);
-
-
-	free(opcode);
+	/* The operands are the tokens that follow the mnemonic. */
+	if (group != SG_GROUP_INVALID) table[group](tokens + 1, count - 1, op, img);
 }
 
-void encode_source_and_dest(imageMemory* img, char* source, char* dest)
+void encode_source_and_dest(imageMemory* img, Token* source, Token* dest)
 {
-	char* operands[3] = { NULL };
-	int i, num;
+	Token* operands[2] = { NULL };
+	char* end = NULL;
+	int i, num = 0;
 
 	operands[0] = source;
 	operands[1] = dest;
 
-	if (get_operand_kind(source) == KIND_REG && get_operand_kind(dest) == KIND_REG) {
-		/* Bits 2 - 7 -> First register. Bits 8 - 13 -> Second register. */
-		set_image_memory(img, (unsigned char)(*(source + 1) - '0'), FLAG_OPCODE2 | FLAG_PARAM1 | FLAG_PARAM2);
-		set_image_memory(img, (*(dest + 1) - '0') << 2, FLAG_OPCODE1 | FLAG_DEST | FLAG_SOURCE);
+	if (get_token_operand_kind(source) == KIND_REG && get_token_operand_kind(dest) == KIND_REG) {
+		/* The two registers share a single word. */
+		encode_current_word(img, WORD_FIELD(REG_SOURCE, source->value) | WORD_FIELD(REG_DEST, dest->value));
 		img_memory_set_counter(img, img_memory_get_counter(img) + 1);
 		return;
 	}
 
 	for (i = 0; i < 2; i++) {
-		OperandKind kind;
-
 		if (operands[i]) {
-			kind = get_operand_kind(operands[i]);
-
-			switch (kind) {
+			switch (get_token_operand_kind(operands[i])) {
 			case KIND_IMM:
-				num = get_num(operands[i] + 1); /* +1 to ignore the '#' */
-				set_image_memory(img, num << 2, FLAG_DEST | FLAG_SOURCE | FLAG_OPCODE1);
-				set_image_memory(img, num >> START_OFFSET_SECOND_BYTE, FLAG_PARAM1 | FLAG_PARAM2 | FLAG_OPCODE2);
+				(void)scan_int(operands[i]->start + 1, NUMBER_SEPS_STRING, IMMEDIATE_BITS, &num, &end); /* +1 to ignore the '#' */
+				encode_current_word(img, WORD_FIELD(VALUE, num));
 				break;
 			case KIND_REG:
 				/* Two different cases for source and dest. */
 				if (operands[i] == source) {
-					set_image_memory(img, *(source + 1) - '0', FLAG_OPCODE2 | FLAG_PARAM1 | FLAG_PARAM2);
+					encode_current_word(img, WORD_FIELD(REG_SOURCE, source->value));
 				}
 				else if (operands[i] == dest) {
-					set_image_memory(img, (*(dest + 1) - '0') << 2, FLAG_OPCODE1 | FLAG_DEST | FLAG_SOURCE);
+					encode_current_word(img, WORD_FIELD(REG_DEST, dest->value));
 				}
 				break;
 			 default:
@@ -232,6 +190,35 @@ void varData_destroy(VarData** ptr)
 	free(*ptr);
 }
 
+OperandKind get_token_operand_kind(Token* token)
+{
+	if (!token) return KIND_NONE;
+	if (*token->start == HASH_CHAR) return KIND_IMM;
+	if (token->type == TOKEN_REGISTER) return KIND_REG;
+	return KIND_LABEL;
+}
+
+AddressingType get_token_addressing(Token* token)
+{
+	switch (get_token_operand_kind(token)) {
+	case KIND_IMM: return ADDRESSING_IMM;
+	case KIND_REG: return ADDRESSING_REG;
+	default: return ADDRESSING_DIR;
+	}
+}
+
+int get_operand_tokens(Token* tokens, int count, Token** out, int max)
+{
+	int i, found = 0;
+
+	for (i = 0; i < count && found < max; i++) {
+		if (tokens[i].type != TOKEN_PUNCTUATION)
+			out[found++] = &tokens[i];
+	}
+
+	return found;
+}
+
 OperandKind get_operand_kind(char* op)
 {
 	if (!op) return KIND_NONE;
@@ -241,144 +228,104 @@ OperandKind get_operand_kind(char* op)
 	return KIND_LABEL;
 }
 
-void encode_syntax_group_1(LineIterator* it, Opcodes op, memoryBuffer* img)
+void encode_syntax_group_1(Token* operands, int count, Opcodes op, memoryBuffer* img)
 {
 	/* Source operand can be immediate, register or label. */
 	/* Dest operand can be register or label. */
-	char* source = NULL, * dest = NULL;
+	Token* vars[TWO_VARIABLES] = { NULL };
 
-	source = line_iterator_next_word(it, COMMA_STRING);
-
-	line_iterator_consume_blanks(it);
-	line_iterator_advance(it);
-
-	dest = line_iterator_next_word(it, SPACE_STRING);
+	get_operand_tokens(operands, count, vars, TWO_VARIABLES);
 
 	/* Encode the first memory word. */
-	encode_preceding_word(memory_buffer_get_inst_img(img), op, source, dest, FALSE);
+	encode_preceding_word(memory_buffer_get_inst_img(img), op, vars[0], vars[1], FALSE);
 
 	/* Encode the source and dest. */
-	encode_source_and_dest(memory_buffer_get_inst_img(img), source, dest);
-
-	free(source);
-	free(dest);
+	encode_source_and_dest(memory_buffer_get_inst_img(img), vars[0], vars[1]);
 }
 
-void encode_syntax_group_2(LineIterator* it, Opcodes op, memoryBuffer* img)
+void encode_syntax_group_2(Token* operands, int count, Opcodes op, memoryBuffer* img)
 {
 	/* Source operand can be immediate, register or label. */
 	/* Dest operand can be register or label. */
-	char* source = NULL, * dest = NULL;
-
-	source = line_iterator_next_word(it, COMMA_STRING);
-
-	line_iterator_consume_blanks(it);
-	line_iterator_advance(it);
+	Token* vars[TWO_VARIABLES] = { NULL };
 
-	dest = line_iterator_next_word(it, SPACE_STRING);
+	get_operand_tokens(operands, count, vars, TWO_VARIABLES);
 
 	/* Encode the first memory word. */
-	encode_preceding_word(memory_buffer_get_inst_img(img), op, source, dest, FALSE);
+	encode_preceding_word(memory_buffer_get_inst_img(img), op, vars[0], vars[1], FALSE);
 
 	/* Encode the source and dest. */
-	encode_source_and_dest(memory_buffer_get_inst_img(img), source, dest);
-
-	free(source);
-	free(dest);
+	encode_source_and_dest(memory_buffer_get_inst_img(img), vars[0], vars[1]);
 }
 
-void encode_syntax_group_3(LineIterator* it, Opcodes op, memoryBuffer* img)
+void encode_syntax_group_3(Token* operands, int count, Opcodes op, memoryBuffer* img)
 {
-	/* Source operand can be immediate, register or label. */
 	/* Dest operand can be register or label. */
-	char* dest = NULL;
+	Token* dest = NULL;
 
-	dest = get_last_word(it);
+	get_operand_tokens(operands, count, &dest, ONE_VAR);
 
 	/* Encode the first memory word. */
 	encode_preceding_word(memory_buffer_get_inst_img(img), op, NULL, dest, FALSE);
 
 	/* Encode the source and dest. */
 	encode_source_and_dest(memory_buffer_get_inst_img(img), NULL, dest);
-
-	free(dest);
 }
 
-void encode_syntax_group_4(LineIterator* it, Opcodes op, memoryBuffer* img)
+void encode_syntax_group_4(Token* operands, int count, Opcodes op, memoryBuffer* img)
 {
 	/* Encodes rts and stop */
 	/* Encode the first memory word. */
 	encode_preceding_word(memory_buffer_get_inst_img(img), op, NULL, NULL, FALSE);
 }
 
-void encode_syntax_group_5(LineIterator* it, Opcodes op, memoryBuffer* img)
+void encode_syntax_group_5(Token* operands, int count, Opcodes op, memoryBuffer* img)
 {
-	/* Source operand can be immediate, register or label. */
-	/* Dest operand can be register or label. */
-	char* source = NULL, * dest = NULL;
-	line_iterator_jump_to(it, OPEN_PAREN_CHAR);
-
-	source = line_iterator_next_word(it, COMMA_STRING);
-
-	line_iterator_advance(it);
-
-	dest = line_iterator_next_word(it, CLOSED_PAREN_STRING);
+	/* A label, optionally followed by two parameters in parenthesis, i.e 'L1(#-1,r6)'. */
+	Token* vars[TWO_VARS_ONE_LABEL] = { NULL };
+	int total = get_operand_tokens(operands, count, vars, TWO_VARS_ONE_LABEL);
 
 	/* Encode the first memory word. */
-	if (source && dest) {
-		encode_preceding_word(memory_buffer_get_inst_img(img), op, source, dest, TRUE);
+	if (total == TWO_VARS_ONE_LABEL) {
+		encode_preceding_word(memory_buffer_get_inst_img(img), op, vars[1], vars[2], TRUE);
 		img_memory_set_counter(memory_buffer_get_inst_img(img), img_memory_get_counter(memory_buffer_get_inst_img(img)) + 1);
 
 		/* Encode the source and dest. */
-		encode_source_and_dest(memory_buffer_get_inst_img(img), source, dest);
+		encode_source_and_dest(memory_buffer_get_inst_img(img), vars[1], vars[2]);
 	}
 	else {
-		encode_preceding_word(memory_buffer_get_inst_img(img), op, dest, source, FALSE);
+		encode_preceding_word(memory_buffer_get_inst_img(img), op, NULL, vars[0], FALSE);
 		img_memory_set_counter(memory_buffer_get_inst_img(img), img_memory_get_counter(memory_buffer_get_inst_img(img)) + 1);
 	}
-
-	free(source);
-	free(dest);
 }
 
-void encode_syntax_group_6(LineIterator* it, Opcodes op, memoryBuffer* img)
+void encode_syntax_group_6(Token* operands, int count, Opcodes op, memoryBuffer* img)
 {
-	/* Source operand can be immediate, register or label. */
-	/* Dest operand can be register or label. */
-	char* dest = NULL;
+	/* Dest operand can be immediate, register or label. */
+	Token* dest = NULL;
 
-	dest = get_last_word(it);
+	get_operand_tokens(operands, count, &dest, ONE_VAR);
 
 	/* Encode the first memory word. */
 	encode_preceding_word(memory_buffer_get_inst_img(img), op, NULL, dest, FALSE);
 
 	/* Encode the source and dest. */
 	encode_source_and_dest(memory_buffer_get_inst_img(img), NULL, dest);
-
-	free(dest);
 }
 
-void encode_syntax_group_7(LineIterator* it, Opcodes op, memoryBuffer* img)
+void encode_syntax_group_7(Token* operands, int count, Opcodes op, memoryBuffer* img)
 {
-	/* Source operand can be immediate, register or label. */
+	/* Source operand can be a label. */
 	/* Dest operand can be register or label. */
-	char* source = NULL, * dest = NULL;
-
-	source = line_iterator_next_word(it, COMMA_STRING);
+	Token* vars[TWO_VARIABLES] = { NULL };
 
-	line_iterator_consume_blanks(it);
-	line_iterator_advance(it);
-
-	dest = line_iterator_next_word(it, SPACE_STRING);
+	get_operand_tokens(operands, count, vars, TWO_VARIABLES);
 
 	/* Encode the first memory word. */
-	encode_preceding_word(memory_buffer_get_inst_img(img), op, source, dest, FALSE);
+	encode_preceding_word(memory_buffer_get_inst_img(img), op, vars[0], vars[1], FALSE);
 
 	/* Encode the source and dest. */
-	encode_source_and_dest(memory_buffer_get_inst_img(img), source, dest);
-
-	free(source);
-	free(dest);
+	encode_source_and_dest(memory_buffer_get_inst_img(img), vars[0], vars[1]);
 }
 
 
@@ -459,6 +406,34 @@ int varData_get_total(VarData* vd)
 	return vd->total;
 }
 
+int encode_labels_get_words_count(VarData* variables)
+{
+	int count = 0;
+
+	if (!variables)
+		return 0;
+
+	/* The same words encode_labels () moves the counter over. */
+	if (variables->label)
+		count++;
+
+	if (get_operand_kind(variables->leftVar) == KIND_REG && get_operand_kind(variables->rightVar) == KIND_REG)
+		return count + 1;
+
+	count += (variables->leftVar) ? 1 : 0;
+	count += (variables->rightVar) ? 1 : 0;
+	return count;
+}
+
+/* An external symbol is resolved by the linker, any other symbol is relocated by its address. */
+static void encode_symbol_word(imageMemory* img, SymbolTableNode* nodePtr)
+{
+	if (symbol_get_type(symbol_node_get_sym(nodePtr)) == SYM_EXTERN)
+		encode_current_word(img, WORD_FIELD(ERA, ENCODING_EXT));
+	else
+		encode_current_word(img, WORD_FIELD(VALUE, symbol_get_counter(symbol_node_get_sym(nodePtr))) | WORD_FIELD(ERA, ENCODING_RELOC));
+}
+
 void encode_labels(VarData* variables, SyntaxGroups synGroup, SymbolTable* symTable, imageMemory* img)
 {
 	SymbolTableNode* nodePtr = NULL;
@@ -472,14 +447,7 @@ void encode_labels(VarData* variables, SyntaxGroups synGroup, SymbolTable* symTa
 	if (variables->label) {
 		nodePtr = symbol_table_search_symbol(symTable, variables->label);
 		if (nodePtr) {
-			if (symbol_get_type(symbol_node_get_sym(nodePtr)) == SYM_EXTERN) {
-				set_image_memory(img, ENCODING_EXT, FLAG_ERA);
-			}
-			else {
-				set_image_memory(img, (symbol_get_counter(symbol_node_get_sym(nodePtr)) & 0xff) << 0x02, FLAG_OPCODE1 | FLAG_SOURCE | FLAG_DEST);
-				set_image_memory(img, (symbol_get_counter(symbol_node_get_sym(nodePtr)) << 0x02) >> 0x08, FLAG_OPCODE2 | FLAG_PARAM1 | FLAG_PARAM2);
-				set_image_memory(img, ENCODING_RELOC, FLAG_ERA);
-			}
+			encode_symbol_word(img, nodePtr);
 		}
 		img_memory_set_counter(img, img_memory_get_counter(img) + 1);
 	}
@@ -493,14 +461,7 @@ void encode_labels(VarData* variables, SyntaxGroups synGroup, SymbolTable* symTa
 		if (variables->leftVar) {
 			nodePtr = symbol_table_search_symbol(symTable, variables->leftVar);
 			if (nodePtr) {
-				if (symbol_get_type(symbol_node_get_sym(nodePtr)) == SYM_EXTERN) {
-					set_image_memory(img, ENCODING_EXT, FLAG_ERA);
-				}
-				else {
-					set_image_memory(img, (symbol_get_counter(symbol_node_get_sym(nodePtr)) & 0xff) << 0x02, FLAG_OPCODE1 | FLAG_SOURCE | FLAG_DEST);
-					set_image_memory(img, (symbol_get_counter(symbol_node_get_sym(nodePtr)) << 0x02) >> 0x08, FLAG_OPCODE2 | FLAG_PARAM1 | FLAG_PARAM2);
-					set_image_memory(img, ENCODING_RELOC, FLAG_ERA);
-				}
+				encode_symbol_word(img, nodePtr);
 			}
 			img_memory_set_counter(img, img_memory_get_counter(img) + 1);
 		}
@@ -508,14 +469,7 @@ void encode_labels(VarData* variables, SyntaxGroups synGroup, SymbolTable* symTa
 		if (variables->rightVar) {
 			nodePtr = symbol_table_search_symbol(symTable, variables->rightVar);
 			if (nodePtr) {
-				if (symbol_get_type(symbol_node_get_sym(nodePtr)) == SYM_EXTERN) {
-					set_image_memory(img, ENCODING_EXT, FLAG_ERA);
-				}
-				else {
-					set_image_memory(img, ((symbol_get_counter(symbol_node_get_sym(nodePtr))) & 0xff) << 0x02, FLAG_OPCODE1 | FLAG_SOURCE | FLAG_DEST);
-					set_image_memory(img, ((symbol_get_counter(symbol_node_get_sym(nodePtr))) << 0x02) >> 0x08, FLAG_OPCODE2 | FLAG_PARAM1 | FLAG_PARAM2);
-					set_image_memory(img, ENCODING_RELOC, FLAG_ERA);
-				}
+				encode_symbol_word(img, nodePtr);
 			}
 			img_memory_set_counter(img, img_memory_get_counter(img) + 1);
 		}
@@ -28,27 +28,37 @@ typedef struct VarData VarData;
 
 /**
 * Encode a dot string.
-* @param it
+* @param operands - The tokens that follow the '.string' directive.
+* @param count - The amount of tokens.
 * @param img
+* @return FALSE if the data image is full, nothing is written in that case.
 */
-void encode_dot_string(LineIterator* it, memoryBuffer* img);
+bool encode_dot_string(Token* operands, int count, memoryBuffer* img);
 
 /**
 * Encode the data section of a dot file.
-* @param it
+* @param operands - The tokens that follow the '.data' directive.
+* @param count - The amount of tokens.
 * @param img
+* @return FALSE if the data image is full, nothing is written in that case.
 */
-void encode_dot_data(LineIterator* it, memoryBuffer* img);
+bool encode_dot_data(Token* operands, int count, memoryBuffer* img);
 
 /*2 first digits are already encodede on first pass*/
 /**
-* @Encode the start of a label.
-* @param it
-* @param img
-* @param symTable
-* @param dbg_list Debug list to add debug info
+* @brief Extracts the operands of an instruction line, the ones encode_labels () resolves.
+* @param it - The line, the iterator is reset and left after the operands.
+* @param synGroup - Receives the syntax group of the opcode.
+* @return The operands, NULL if the opcode has none. The caller must free it with varData_destroy.
+*/
+VarData* extract_label_operands(LineIterator* it, SyntaxGroups* synGroup);
+
+/**
+* @brief Returns the amount of words encode_labels () moves the counter over, without resolving anything.
+* @param variables - The operands.
+* @return The amount of words.
 */
-void encode_label_start_process(LineIterator* it, memoryBuffer* img, SymbolTable* symTable);
+int encode_labels_get_words_count(VarData* variables);
 
 /**
 * Encode labels in an assembler image. This is a helper function.
@@ -61,10 +71,11 @@ void encode_labels(VarData* variables, SyntaxGroups synGroup, SymbolTable* symTa
 
 /**
 * @brief Encode a single opcode. This is the entry point for the encoding routines.
-* @param it
+* @param tokens - The tokens of the line, starting at the mnemonic.
+* @param count - The amount of tokens.
 * @param img
 */
-void encode_opcode(LineIterator* it, memoryBuffer* img);
+void encode_opcode(Token* tokens, int count, memoryBuffer* img);
 
 /**
 * @brief Encode an integer in image memory. This is used to encode a variable - length integer ( 8 bits )
@@ -81,7 +92,7 @@ void encode_integer(imageMemory* img, unsigned int num);
 * @param dest The destination of the instruction or NULL if there is no destination.
 * @param is_jmp_label Flag indicating whether or not this is a jump
 */
-void encode_preceding_word(imageMemory* img, Opcodes op, char* source, char* dest, bool is_jmp_label);
+void encode_preceding_word(imageMemory* img, Opcodes op, Token* source, Token* dest, bool is_jmp_label);
 
 /**
 * @brief Encode source and destination registers. This is used to encode a pair of register or immediates.
@@ -89,7 +100,7 @@ void encode_preceding_word(imageMemory* img, Opcodes op, char* source, char* des
 * @param source
 * @param dest
 */
-void encode_source_and_dest(imageMemory* img, char* source, char* dest);
+void encode_source_and_dest(imageMemory* img, Token* source, Token* dest);
 
 /**
 * @brief This function allocates a new VarData object.
@@ -164,59 +175,66 @@ int varData_get_total(VarData* vd);
 
 /**
 * @brief Encode a syntax group 1 instruction. dependent syntax group that we use to encode source and destination operands.
-* @param it Line iterator pointing to the start of the syntax group
+* @param operands - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
 * @param op Operand type to be encoded
 * @param img
 */
-void encode_syntax_group_1(LineIterator* it, Opcodes op, memoryBuffer* img);
+void encode_syntax_group_1(Token* operands, int count, Opcodes op, memoryBuffer* img);
 
 /**
 * @brief Encode a syntax group 2 instruction. This is the second part of the machine - dependent syntax group encoding.
-* @param it Line iterator pointing to the start of the syntax group
+* @param operands - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
 * @param op Operand type to be used
 * @param img
 */
-void encode_syntax_group_2(LineIterator* it, Opcodes op, memoryBuffer* img);
+void encode_syntax_group_2(Token* operands, int count, Opcodes op, memoryBuffer* img);
 
 /**
 * @brief Encode a syntax group 3 instruction.
-* @param it Line iterator pointing to the start of the instruction to encode.
+* @param operands - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
 * @param op The opcode of the instruction to encode. This is used to determine the source and destination word and to encode the source and destination respectively.
 * @param img
 */
-void encode_syntax_group_3(LineIterator* it, Opcodes op, memoryBuffer* img);
+void encode_syntax_group_3(Token* operands, int count, Opcodes op, memoryBuffer* img);
 
 /**
 * @brief Encode a syntax group 4. Encodes RTS and stop. This is used to encode the first memory word and the second and subsequent memory words
-* @param it Line iterator pointing to the start of the line to be encoded.
+* @param operands - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
 * @param op The opcode of the encoding operation. This is always OP_SyntaxGroup4.
 * @param img
 */
-void encode_syntax_group_4(LineIterator* it, Opcodes op, memoryBuffer* img);
+void encode_syntax_group_4(Token* operands, int count, Opcodes op, memoryBuffer* img);
 
 /**
 * @brief Encode a syntax group 5 instruction.
-* @param it
+* @param operands - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
 * @param op The opcode of the encoding
 * @param img
 */
-void encode_syntax_group_5(LineIterator* it, Opcodes op, memoryBuffer* img);
+void encode_syntax_group_5(Token* operands, int count, Opcodes op, memoryBuffer* img);
 
 /**
 * @brief Encode a syntax group 6 instruction.
-* @param it Line iterator pointing to the start of the line to be encoded.
+* @param operands - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
 * @param op Operand type to be used for encoding.
 * @param img
 */
-void encode_syntax_group_6(LineIterator* it, Opcodes op, memoryBuffer* img);
+void encode_syntax_group_6(Token* operands, int count, Opcodes op, memoryBuffer* img);
 
 /**
 * @brief Encode a syntax group 7 instruction.
-* @param it Line iterator pointing to the start of the instruction
+* @param operands - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
 * @param op Operand type to be used for encoding
 * @param img
 */
-void encode_syntax_group_7(LineIterator* it, Opcodes op, memoryBuffer* img);
+void encode_syntax_group_7(Token* operands, int count, Opcodes op, memoryBuffer* img);
 
 /**
 * @brief Get the kind of operand.
@@ -225,6 +243,30 @@ void encode_syntax_group_7(LineIterator* it, Opcodes op, memoryBuffer* img);
 */
 OperandKind get_operand_kind(char* op);
 
+/**
+* @brief Get the kind of an operand token.
+* @param token
+* @return KIND_NONE if token is NULL KIND_IMM if it starts with a hash_char KIND_REG if it is a register, KIND_LABEL otherwise
+*/
+OperandKind get_token_operand_kind(Token* token);
+
+/**
+* @brief Get the addressing type of an operand token, as encoded in the preceding word.
+* @param token
+* @return The addressing type.
+*/
+AddressingType get_token_addressing(Token* token);
+
+/**
+* @brief Collects the operand tokens of an instruction, skipping the commas and parenthesis between them.
+* @param tokens - The tokens that follow the mnemonic.
+* @param count - The amount of tokens.
+* @param out - An array that receives pointers to the operands.
+* @param max - The size of 'out'.
+* @return The amount of operands found.
+*/
+int get_operand_tokens(Token* tokens, int count, Token** out, int max);
+
 /**
 @brief Deallocates the memory used by a VarData struct and its fields.
 @param ptr A pointer to the VarData struct pointer to be destroyed.
@@ -0,0 +1,357 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "file_store.h"
+#include "line_reader.h"
+#include "mapped_file.h"
+
+typedef struct storedFile
+{
+	char* path;
+	char* data; /* The contents, written by open_memstream for the outputs of a deferred store. */
+	size_t size;
+	bool is_output; /* FALSE for a source that was loaded, only the outputs are flushed. */
+	MappedFile* mapped; /* A sized output that is written through to the disk. */
+	struct storedFile* next;
+} storedFile;
+
+struct fileStore
+{
+	bool is_deferred;
+	bool is_sealed; /* Nothing is read from the disk, the files the store doesn't hold are asked from the resolver. */
+	FileResolver resolver;
+	void* resolver_context;
+	OutputSink* sink;
+	storedFile* head;
+	storedFile* tail; /* The files are kept in the order they were added, so a sink gets the outputs in the order they were made. */
+};
+
+FileStore* file_store_new(bool is_deferred, OutputSink* sink)
+{
+	FileStore* store = (FileStore*)xmalloc(sizeof(FileStore));
+
+	store->is_deferred = (is_deferred || !output_sink_is_files(sink)) ? TRUE : FALSE;
+	store->is_sealed = FALSE;
+	store->resolver = NULL;
+	store->resolver_context = NULL;
+	store->sink = sink;
+	store->head = NULL;
+	store->tail = NULL;
+
+	return store;
+}
+
+static storedFile* find_file(FileStore* store, char* path)
+{
+	storedFile* file;
+
+	for (file = store->head; file; file = file->next)
+		if (strcmp(file->path, path) == 0)
+			return file;
+
+	return NULL;
+}
+
+/* Returns the file of a path, emptied, a file that is written again replaces its old contents. */
+static storedFile* add_file(FileStore* store, char* path, bool is_output)
+{
+	storedFile* file = find_file(store, path);
+
+	if (!file) {
+		file = (storedFile*)xcalloc(1, sizeof(storedFile));
+		file->path = get_copy_string(path);
+		if (store->tail)
+			store->tail->next = file;
+		else
+			store->head = file;
+		store->tail = file;
+	}
+
+	free(file->data);
+	file->data = NULL;
+	file->size = 0;
+	file->is_output = is_output;
+	file->mapped = NULL;
+
+	return file;
+}
+
+bool file_store_load(FileStore* store, char* path)
+{
+	FILE* in = open_file(path, MODE_READ);
+	storedFile* file;
+	long size;
+
+	if (!in)
+		return FALSE;
+
+	fseek(in, 0, SEEK_END);
+	size = ftell(in);
+	rewind(in);
+
+	if (size < 0) {
+		fclose(in);
+		return FALSE;
+	}
+
+	file = add_file(store, path, FALSE);
+	file->data = (char*)xmalloc(size + 1);
+	file->size = fread(file->data, sizeof(char), size, in);
+	fclose(in);
+
+	return TRUE;
+}
+
+bool file_store_load_stream(FileStore* store, char* path, FILE* in)
+{
+	size_t log_sz = INIT_LOG_SZ, phy_sz = INIT_PHY_SZ, read_size;
+	char* data = (char*)xmalloc(phy_sz);
+
+	for (;;) {
+		if (log_sz + 1 >= phy_sz) {
+			GROW_CAPACITY(phy_sz);
+			data = GROW_ARRAY(char*, data, phy_sz, sizeof(char));
+		}
+
+		read_size = fread(data + log_sz, sizeof(char), phy_sz - log_sz - 1, in);
+		log_sz += read_size;
+		if (read_size == 0)
+			break;
+	}
+
+	if (ferror(in)) {
+		free(data);
+		return FALSE;
+	}
+
+	file_store_put(store, path, data, log_sz);
+	return TRUE;
+}
+
+void file_store_put(FileStore* store, char* path, char* data, size_t size)
+{
+	storedFile* file = add_file(store, path, FALSE);
+
+	file->data = data;
+	file->size = size;
+}
+
+void file_store_seal(FileStore* store, FileResolver resolver, void* context)
+{
+	store->is_sealed = TRUE;
+	store->resolver = resolver;
+	store->resolver_context = context;
+}
+
+bool file_store_is_sealed(FileStore* store)
+{
+	return store->is_sealed;
+}
+
+bool file_store_is_on_disk(FileStore* store)
+{
+	return (!store->is_sealed && output_sink_is_files(store->sink)) ? TRUE : FALSE;
+}
+
+/* Returns the file of a path in a sealed store, asking the resolver for it the first time. NULL if it isn't available. */
+static storedFile* resolve_file(FileStore* store, char* path)
+{
+	storedFile* file = find_file(store, path);
+	const char* contents;
+	char* data;
+	size_t size = 0;
+
+	if (file || !store->resolver || !(contents = store->resolver(store->resolver_context, path, &size)))
+		return file;
+
+	data = (char*)xmalloc(size + 1);
+	memcpy(data, contents, size);
+	data[size] = '\0';
+	file_store_put(store, path, data, size);
+
+	return find_file(store, path);
+}
+
+bool file_store_resolve(FileStore* store, char* path, FileBuffer* file)
+{
+	storedFile* stored = store->is_sealed ? resolve_file(store, path) : NULL;
+
+	if (!stored || !stored->data)
+		return FALSE;
+
+	file->path = stored->path;
+	file->data = stored->data;
+	file->size = stored->size;
+	file->is_done = TRUE;
+
+	return TRUE;
+}
+
+FILE* file_store_open_read(FileStore* store, char* path, debugList* dbg_list)
+{
+	storedFile* file = store->is_sealed ? resolve_file(store, path) : find_file(store, path);
+	FILE* in;
+
+	if (!file && store->is_sealed) {
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_OPEN);
+		return NULL;
+	}
+
+	if (!file)
+		return line_reader_open_source(path, dbg_list);
+
+	if (file->size == 0) {
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_EMPTY);
+		return NULL;
+	}
+
+	if (!(in = fmemopen(file->data, file->size, MODE_READ)))
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_OPEN);
+
+	return in;
+}
+
+FILE* file_store_open_write(FileStore* store, char* path, debugList* dbg_list)
+{
+	storedFile* file;
+	FILE* out;
+
+	if (!store->is_deferred) {
+		if (!(out = open_file(path, MODE_WRITE)))
+			debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_WRITE);
+		return out;
+	}
+
+	/* The stream owns the buffer until it's closed, the file only points at it. */
+	file = add_file(store, path, TRUE);
+	if (!(out = open_memstream(&file->data, &file->size)))
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_WRITE);
+
+	return out;
+}
+
+char* file_store_create_sized(FileStore* store, char* path, size_t size, debugList* dbg_list)
+{
+	storedFile* file = add_file(store, path, TRUE);
+
+	if (store->is_deferred) {
+		file->data = (char*)xmalloc(size + 1);
+		file->size = size;
+		return file->data;
+	}
+
+	if (!(file->mapped = mapped_file_create(path, size))) {
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_WRITE);
+		return NULL;
+	}
+
+	return mapped_file_get_data(file->mapped);
+}
+
+bool file_store_close_sized(FileStore* store, char* path, debugList* dbg_list)
+{
+	storedFile* file = find_file(store, path);
+
+	if (!file)
+		return FALSE;
+
+	/* Held in memory until the flush. */
+	if (!file->mapped)
+		return TRUE;
+
+	/* Written through to the disk, the store doesn't hold its contents. */
+	if (!mapped_file_close(&file->mapped)) {
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_WRITE);
+		return FALSE;
+	}
+
+	file->is_output = FALSE;
+	return TRUE;
+}
+
+static void free_files(FileStore* store)
+{
+	storedFile* file = store->head, *next;
+
+	for (; file; file = next) {
+		next = file->next;
+		if (file->mapped)
+			mapped_file_close(&file->mapped);
+		free(file->data);
+		free(file->path);
+		free(file);
+	}
+
+	store->head = NULL;
+	store->tail = NULL;
+}
+
+bool file_store_get_file(FileStore* store, char* path, FileBuffer* file)
+{
+	storedFile* stored = find_file(store, path);
+
+	/* A file that is written through to the disk isn't held. */
+	if (!stored || stored->mapped || !stored->data)
+		return FALSE;
+
+	file->path = stored->path;
+	file->data = stored->data;
+	file->size = stored->size;
+	file->is_done = TRUE;
+
+	return TRUE;
+}
+
+int file_store_get_outputs(FileStore* store, FileBuffer* outputs, int max)
+{
+	storedFile* file;
+	int count = 0;
+
+	for (file = store->head; file && store->is_deferred && count < max; file = file->next) {
+		if (!file->is_output)
+			continue;
+
+		outputs[count].path = file->path;
+		outputs[count].data = file->data;
+		outputs[count].size = file->size;
+		outputs[count].is_done = FALSE;
+		count++;
+	}
+
+	return count;
+}
+
+static bool is_written_elsewhere(storedFile* file, FileBuffer* written, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (written[i].path == file->path)
+			return written[i].is_done;
+
+	return FALSE;
+}
+
+bool file_store_flush(FileStore* store, FileBuffer* written, int count, debugList* dbg_list)
+{
+	storedFile* file;
+	bool is_written = TRUE;
+
+	for (file = store->head; file && store->is_deferred; file = file->next) {
+		if (!file->is_output || is_written_elsewhere(file, written, count))
+			continue;
+
+		if (!output_sink_write(store->sink, file->path, file->data, file->size)) {
+			debug_list_register_file_node(dbg_list, file->path, ERROR_CODE_FILE_WRITE);
+			is_written = FALSE;
+		}
+	}
+
+	free_files(store);
+	return is_written;
+}
+
+void file_store_destroy(FileStore** store)
+{
+	free_files(*store);
+	free(*store);
+}
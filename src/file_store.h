@@ -0,0 +1,169 @@
+#ifndef FILE_STORE_H
+#define FILE_STORE_H
+
+/** @file
+*	This header declares the file store of an assembly, every file the passes read or write goes through it.
+*   A store either works on the disk directly, or keeps the files in memory: a source may be loaded ahead of time,
+*   and the outputs are held until they are flushed, so the reading and the writing can be done on other threads than the assembly.
+*   The outputs end up in the output sink of the store, the outputs of a store with another sink than the files sink are always held until the flush.
+*   A sealed store never touches the disk, a file it doesn't hold is asked from its resolver or isn't available (i.e the standard input and the library).
+*   A store belongs to a single assembly, it's not locked.
+*/
+
+#include "utils.h"
+#include "debug.h"
+#include "output_sink.h"
+#include <stddef.h>
+
+/**
+* @brief A forward declaration of the file store, declaration in the '.c' file.
+*/
+typedef struct fileStore FileStore;
+
+/**
+* @brief A function that returns the contents of a file a sealed store doesn't hold, i.e an included file that the caller keeps in memory.
+* @param context - The context that was given with the resolver.
+* @param path - The path of the file.
+* @param size - Receives the size of the contents.
+* @return The contents, they belong to the resolver and are copied. NULL if the file isn't available.
+*/
+typedef const char* (*FileResolver)(void* context, char* path, size_t* size);
+
+/**
+* @brief This function creates a new file store.
+* @param is_deferred - TRUE to keep the outputs in memory until file_store_flush, FALSE to write them to the disk as they are closed.
+* @param sink - The sink the outputs are written to, the store doesn't own it. Only the files sink may write them as they are closed.
+* @return A new file store.
+*/
+FileStore* file_store_new(bool is_deferred, OutputSink* sink);
+
+/**
+* @brief This function reads a file from the disk into the store, the passes read it from memory after that.
+* @param store - The store.
+* @param path - The path of the file.
+* @return TRUE if the file was read, FALSE if it couldn't be read, it's reported when the passes open it then.
+*/
+bool file_store_load(FileStore* store, char* path);
+
+/**
+* @brief This function reads a whole stream into the store as the contents of a file, i.e a source that is piped to the standard input.
+* @param store - The store.
+* @param path - The path the passes open the file by, nothing is read from the disk.
+* @param in - The stream, it's read until its end.
+* @return TRUE if the stream was read, FALSE if a read failed.
+*/
+bool file_store_load_stream(FileStore* store, char* path, FILE* in);
+
+/**
+* @brief This function puts the contents of a file that was read elsewhere into the store, the same as file_store_load.
+* @param store - The store.
+* @param path - The path of the file.
+* @param data - The contents, allocated with one extra byte, the store takes it.
+* @param size - The size of the contents.
+*/
+void file_store_put(FileStore* store, char* path, char* data, size_t size);
+
+/**
+* @brief This function seals a store, from now on it doesn't read any file from the disk.
+* @param store - The store.
+* @param resolver - The function a file that the store doesn't hold is asked from, NULL if such a file isn't available.
+* @param context - The context that is passed to the resolver.
+*/
+void file_store_seal(FileStore* store, FileResolver resolver, void* context);
+
+/**
+* @brief This function returns whether a store is sealed.
+* @param store - The store.
+* @return TRUE if the store doesn't read files from the disk, FALSE otherwise.
+*/
+bool file_store_is_sealed(FileStore* store);
+
+/**
+* @brief This function returns whether a store works on the disk, it reads the files from the disk and its outputs go to the files sink.
+* @param store - The store.
+* @return TRUE if the store works on the disk, FALSE otherwise.
+*/
+bool file_store_is_on_disk(FileStore* store);
+
+/**
+* @brief This function returns a file a sealed store holds, a file it doesn't hold yet is asked from its resolver and kept.
+* @param store - The store.
+* @param path - The path of the file.
+* @param file - Receives the file, it points into the store and is valid until the store is flushed or freed.
+* @return TRUE if the file is available, FALSE otherwise.
+*/
+bool file_store_resolve(FileStore* store, char* path, FileBuffer* file);
+
+/**
+* @brief This function opens a file for reading, from memory if the store holds it and from the disk otherwise (a sealed store asks its resolver).
+* A file that can't be opened or is empty is reported in the diagnostics.
+* @param store - The store.
+* @param path - The path of the file.
+* @param dbg_list - The debug list the failure is reported to.
+* @return The open file, it must be closed with fclose. NULL on failure.
+*/
+FILE* file_store_open_read(FileStore* store, char* path, debugList* dbg_list);
+
+/**
+* @brief This function opens an output for writing, a file that can't be created is reported in the diagnostics.
+* @param store - The store.
+* @param path - The path of the file.
+* @param dbg_list - The debug list the failure is reported to.
+* @return The open file, it must be closed with fclose before the store reads or flushes it. NULL on failure.
+*/
+FILE* file_store_open_write(FileStore* store, char* path, debugList* dbg_list);
+
+/**
+* @brief This function creates an output of an exact size, its parts may be filled from several threads.
+* @param store - The store.
+* @param path - The path of the file.
+* @param size - The size of the file.
+* @param dbg_list - The debug list the failure is reported to.
+* @return The contents of the file to fill, valid until file_store_close_sized. NULL on failure.
+*/
+char* file_store_create_sized(FileStore* store, char* path, size_t size, debugList* dbg_list);
+
+/**
+* @brief This function closes an output that was created by file_store_create_sized.
+* @param store - The store.
+* @param path - The path of the file.
+* @param dbg_list - The debug list the failure is reported to.
+* @return TRUE if the file was written (or kept for the flush), FALSE otherwise.
+*/
+bool file_store_close_sized(FileStore* store, char* path, debugList* dbg_list);
+
+/**
+* @brief This function returns a file the store holds in memory.
+* @param store - The store.
+* @param path - The path of the file.
+* @param file - Receives the file, it points into the store and is valid until the store is flushed or freed.
+* @return TRUE if the store holds the file, FALSE otherwise.
+*/
+bool file_store_get_file(FileStore* store, char* path, FileBuffer* file);
+
+/**
+* @brief This function returns the outputs a deferred store holds, so they can be written together with the outputs of other stores.
+* @param store - The store.
+* @param outputs - Receives the outputs, they point into the store and are valid until file_store_flush.
+* @param max - The size of 'outputs'.
+* @return The amount of outputs.
+*/
+int file_store_get_outputs(FileStore* store, FileBuffer* outputs, int max);
+
+/**
+* @brief This function writes the outputs a deferred store holds to its sink in the order they were created, and frees all the files it holds.
+* @param store - The store.
+* @param written - Outputs of file_store_get_outputs that were already written elsewhere, the rest are written here. NULL for none.
+* @param count - The amount of outputs in 'written'.
+* @param dbg_list - The debug list the files that can't be written are reported to.
+* @return TRUE if all the outputs were written, FALSE otherwise.
+*/
+bool file_store_flush(FileStore* store, FileBuffer* written, int count, debugList* dbg_list);
+
+/**
+* @brief This function frees a file store, outputs that weren't flushed are dropped.
+* @param store - The store to free.
+*/
+void file_store_destroy(FileStore** store);
+
+#endif
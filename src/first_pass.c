@@ -1,18 +1,252 @@
 #include "first_pass.h"
 #include "syntactical_analysis.h"
 #include "encoding.h"
+#include "parallel.h"
 #include <string.h>
 
-bool do_first_pass(char* path, memoryBuffer* img, SymbolTable* sym_table)
+/* A chunk holds at least this many lines, smaller files are processed on the calling thread. */
+#define FIRST_PASS_MIN_CHUNK_LINES 512
+
+struct firstPassLine
+{
+	FirstPassChunk* chunk;
+	char* text; /* The line, it lives in the text of the source file. */
+	long number;
+	size_t current; /* Where the processing of the line continues, an offset into 'text'. */
+	char* word; /* A copy of the first word of the line, NULL if the line is empty. */
+	firstPassStates state;
+	int keyword;
+	errorCodes err_code; /* The error of a FP_NONE line. */
+	int diag_begin, diag_valid, diag_end; /* [begin, valid) precede the processing of the line, [valid, end) are of its syntax validation. */
+	bool is_valid; /* The result of the syntax validation. */
+	bool is_image_full; /* The words of the line don't fit an image on their own. */
+	int words_begin, words_count; /* The words the line encoded, in the chunk's words. */
+	CachedLine* cached; /* The line of the cache the preparation was taken from, NULL if the line was prepared. */
+};
+
+struct firstPassChunk
+{
+	FirstPassLine* lines; /* A range of the lines of the file. */
+	int count;
+	debugList* dbg_list; /* The diagnostics of the chunk's lines, moved to the file's list by the merge. */
+	LineCache* cache; /* The lines of the previous run, NULL if the assembly isn't incremental. */
+	memoryBuffer* scratch; /* A line is encoded here, then its words are appended to 'words'. */
+	int log_sz;
+	int phy_sz;
+	unsigned int* words;
+	FirstPassChunk* chunks; /* Every chunk of the file, the chunks before this one precede its lines. */
+	int budget; /* The lines with errors after which the merge stops, counted from the first line of the file, 0 for no limit. */
+	int error_lines; /* The prepared lines of the chunk that reported an error, read by the chunks after it while they prepare. */
+};
+
+/* Makes room for 'count' more words in the chunk's words. */
+static void reserve_chunk_words(FirstPassChunk* chunk, int count)
+{
+	if (chunk->log_sz + count >= chunk->phy_sz) {
+		while (chunk->log_sz + count >= chunk->phy_sz)
+			GROW_CAPACITY(chunk->phy_sz);
+		chunk->words = GROW_ARRAY(unsigned int*, chunk->words, chunk->phy_sz, sizeof(unsigned int));
+	}
+}
+
+/* Takes the preparation of a line that didn't change since the previous run from the cache, returns FALSE if the line has to be prepared. */
+static bool reuse_line(FirstPassChunk* chunk, FirstPassLine* rec)
+{
+	CachedLine* cached = chunk->cache ? line_cache_find_after(chunk->cache, (rec > chunk->lines) ? rec[-1].cached : NULL, rec->text) : NULL;
+	int i;
+
+	if (!cached || cached->state < 0 || cached->state >= FP_TOTAL)
+		return FALSE;
+
+	rec->cached = cached;
+	rec->word = get_copy_string(cached->word);
+	rec->state = (firstPassStates)cached->state;
+	rec->keyword = cached->keyword;
+	rec->current = cached->current;
+	rec->is_valid = cached->is_valid;
+	rec->is_image_full = cached->is_image_full;
+
+	/* Only the lines that reported nothing are cached. */
+	rec->diag_valid = rec->diag_end = rec->diag_begin;
+
+	reserve_chunk_words(chunk, cached->words_count);
+	rec->words_begin = chunk->log_sz;
+	rec->words_count = cached->words_count;
+	for (i = 0; i < cached->words_count; i++)
+		chunk->words[chunk->log_sz++] = cached->words[i];
+
+	return TRUE;
+}
+
+/* Classifies, validates and encodes a single line, everything that doesn't depend on the other lines. */
+static void prepare_line(FirstPassChunk* chunk, FirstPassLine* rec, TokenList* token_list)
+{
+	LineIterator it;
+	Token* tokens = NULL;
+	int count;
+	imageMemory* scratch_img = NULL;
+
+	rec->chunk = chunk;
+	rec->state = FP_NONE;
+	rec->err_code = ERROR_CODE_SYNTAX_ERROR;
+	rec->diag_begin = debug_list_get_count(chunk->dbg_list);
+
+	if (reuse_line(chunk, rec))
+		return;
+
+	/* Feed the iterator with the line, trim white spaces. */
+	line_iterator_put_line(&it, rec->text);
+	line_iterator_consume_blanks(&it);
+
+	/* Lex the line once, the classification, the validation and the encoders share the tokens. */
+	count = token_list_lex_line(token_list, it.current);
+	tokens = token_list_get_tokens(token_list);
+
+	/* A label before .entry or .extern is ignored, the line is processed from the directive. */
+	if (count > 1 && tokens[0].type == TOKEN_LABEL_DEF && tokens[1].type == TOKEN_DIRECTIVE && (tokens[1].value == DOT_ENTRY_CODE || tokens[1].value == DOT_EXTERN_CODE)) {
+		debug_list_register_node(chunk->dbg_list, it.start, tokens[1].start, rec->number, ERROR_CODE_SYMBOL_IGNORED_WARN);
+		tokens++;
+		count--;
+	}
+
+	if (count > 0) {
+		rec->word = token_get_copy(&tokens[0]);
+		rec->state = get_symbol_type(&it, tokens, count, rec->word, &rec->keyword, &rec->err_code);
+	}
+
+	/* none of the above, must be an error. */
+	if (rec->state == FP_NONE)
+		debug_list_register_node(chunk->dbg_list, it.start, NULL, rec->number, rec->err_code);
+
+	rec->current = it.current - it.start;
+	rec->diag_valid = debug_list_get_count(chunk->dbg_list);
+	rec->words_begin = chunk->log_sz;
+
+	if (rec->state != FP_NONE) {
+		tokens += rec->keyword;
+		count -= rec->keyword;
+		rec->is_valid = validate_syntax(tokens, count, rec->state, it.start, rec->number, chunk->dbg_list);
+
+		/* The names of .entry and .extern are checked against the symbols by the merge, they don't encode any word. */
+		if (rec->is_valid && rec->state != FP_SYM_ENT && rec->state != FP_SYM_EXT) {
+			if (rec->state == FP_SYM_DATA || rec->state == FP_SYM_STR) {
+				scratch_img = memory_buffer_get_data_img(chunk->scratch);
+				rec->is_image_full = (rec->state == FP_SYM_DATA) ? !encode_dot_data(tokens + 1, count - 1, chunk->scratch) : !encode_dot_string(tokens + 1, count - 1, chunk->scratch);
+			}
+			else {
+				scratch_img = memory_buffer_get_inst_img(chunk->scratch);
+				encode_opcode(tokens, count, chunk->scratch);
+			}
+
+			/* Keep the encoded words, and clear the scratch image for the next line. */
+			rec->words_count = img_memory_get_counter(scratch_img);
+			reserve_chunk_words(chunk, rec->words_count);
+			for (count = 0; count < rec->words_count; count++)
+				chunk->words[chunk->log_sz++] = img_memory_get_word(scratch_img, count);
+			img_memory_clear(scratch_img);
+		}
+	}
+
+	rec->diag_end = debug_list_get_count(chunk->dbg_list);
+}
+
+/* Checks if the lines prepared so far spend the errors budget. Every line with an error adds at least one error to the file's list when it's
+*  merged, so once the chunks before this one and the chunk itself found that many, the merge stops before the next line of the chunk. */
+static bool is_budget_spent(FirstPassChunk* chunk)
+{
+	FirstPassChunk* prev = NULL;
+	int error_lines = chunk->error_lines;
+
+	if (chunk->budget == 0)
+		return FALSE;
+
+	for (prev = chunk->chunks; prev < chunk && error_lines < chunk->budget; prev++)
+		error_lines += __atomic_load_n(&prev->error_lines, __ATOMIC_RELAXED);
+
+	return error_lines >= chunk->budget ? TRUE : FALSE;
+}
+
+/* A ParallelTask, prepares the lines of a chunk until the errors budget is spent, the lines after it are never merged. */
+static void prepare_chunk(void* item)
+{
+	FirstPassChunk* chunk = (FirstPassChunk*)item;
+	TokenList* token_list = token_list_new_list();
+	int i, errors_count;
+
+	for (i = 0; i < chunk->count && !is_budget_spent(chunk); i++) {
+		errors_count = debug_list_get_errors_count(chunk->dbg_list);
+		prepare_line(chunk, &chunk->lines[i], token_list);
+		if (debug_list_get_errors_count(chunk->dbg_list) > errors_count)
+			__atomic_store_n(&chunk->error_lines, chunk->error_lines + 1, __ATOMIC_RELAXED);
+	}
+
+	token_list_destroy(&token_list);
+}
+
+/* Records the lines that were prepared without any diagnostic, the next incremental run takes them from the cache. */
+static void record_lines(LineCache* cache, FirstPassLine* lines, int count)
+{
+	CachedLine cached;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (lines[i].state == FP_NONE || lines[i].diag_begin != lines[i].diag_end)
+			continue;
+
+		if (lines[i].cached) {
+			line_cache_record(cache, lines[i].cached);
+			continue;
+		}
+
+		cached.text = lines[i].text;
+		cached.word = lines[i].word;
+		cached.state = (int)lines[i].state;
+		cached.keyword = lines[i].keyword;
+		cached.current = lines[i].current;
+		cached.is_valid = lines[i].is_valid;
+		cached.is_image_full = lines[i].is_image_full;
+		cached.words_count = lines[i].words_count;
+		cached.words = lines[i].chunk->words + lines[i].words_begin;
+		line_cache_record(cache, &cached);
+	}
+}
+
+/* Moves the diagnostics of the line's syntax validation to the file's list, returns the result of the validation. */
+static bool replay_validation(FirstPassLine* rec, debugList* dbg_list)
+{
+	debug_list_move_nodes(dbg_list, rec->chunk->dbg_list, rec->diag_valid, rec->diag_end);
+	return rec->is_valid;
+}
+
+/* Appends the words the line encoded to the image at the final address, returns the error if the image is full. */
+static errorCodes place_line_words(FirstPassLine* rec, memoryBuffer* img)
+{
+	bool is_data = (rec->state == FP_SYM_DATA || rec->state == FP_SYM_STR) ? TRUE : FALSE;
+	imageMemory* dst = is_data ? memory_buffer_get_data_img(img) : memory_buffer_get_inst_img(img);
+	int i;
+
+	if (rec->is_image_full || !img_memory_reserve(dst, rec->words_count))
+		return is_data ? ERROR_CODE_DATA_IMAGE_FULL : ERROR_CODE_CODE_IMAGE_FULL;
+
+	for (i = 0; i < rec->words_count; i++)
+		img_memory_push_word(dst, rec->chunk->words[rec->words_begin + i]);
+
+	return ERROR_CODE_OK;
+}
+
+bool do_first_pass(char* path, memoryBuffer* img, SymbolTable* sym_table, int jobs, LineCache* cache, FileStore* store, debugList* dbg_list)
 {
 	FILE* in = NULL;
 	LineIterator it;
-	char* curr_line = NULL;
-	long line = 1;
+	FirstPassLine* lines = NULL, *rec = NULL;
+	FirstPassChunk* chunks = NULL;
+	LineReader* reader = NULL;
+	SourceFile source;
+	int lines_count, chunks_count, budget = 0, i;
 	bool should_encode = TRUE;
 
 	/* typedef for the dispatch table. */
-	typedef bool (*fpass_dispatch_table)(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool did_err_occurred);
+	typedef bool (*fpass_dispatch_table)(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool did_err_occurred, debugList* dbg_list);
 
 	fpass_dispatch_table table[FP_TOTAL] = {
 		first_pass_process_sym_def,
@@ -22,148 +256,188 @@ bool do_first_pass(char* path, memoryBuffer* img, SymbolTable* sym_table)
 		first_pass_process_sym_ent,
 		first_pass_process_opcode
 	};
-	in = open_file(path, MODE_READ);
-
-	/* Read a new line from the input stream.*/
-	while ((curr_line = get_line(in)) != NULL) {
-		char* word = NULL;
-		errorCodes errCode = ERROR_CODE_UNKNOWN;
-		firstPassStates state;
-
-		/* Feed the iterator with a new line. */
-		line_iterator_put_line(&it, curr_line);
-		/* Trim white spaces. */
-		line_iterator_consume_blanks(&it);
-		find_uncessery_syms(&it, line);
-		word = line_iterator_next_word(&it, SPACE_STRING);
-		state = get_symbol_type(&it, word, &errCode);
-
-		/* none of the above, must be an error. */
-		/* if state FP_NONE register the node in the list and register it as a new node. */
-		if (state == FP_NONE) {
-			print_error(it.start, line, errCode);
+	if (!(in = file_store_open_read(store, path, dbg_list)))
+		return FALSE;
+
+	reader = line_reader_new(in);
+	line_reader_read_all(reader, &source);
+	line_reader_destroy(&reader);
+	fclose(in);
+	debug_list_set_file(dbg_list, path);
+
+	lines_count = source.count;
+	if (lines_count < FIRST_PASS_MIN_CACHED_LINES)
+		cache = NULL;
+
+	lines = (FirstPassLine*)xcalloc(lines_count + 1, sizeof(FirstPassLine));
+	for (i = 0; i < lines_count; i++) {
+		lines[i].text = source.lines[i].text;
+		lines[i].number = source.lines[i].number;
+		lines[i].state = FP_NONE; /* A line that isn't prepared is never recorded. */
+	}
+
+	/* The errors left before the merge stops, the chunks stop preparing lines once they found that many. */
+	if (debug_list_get_max_errors(dbg_list) > 0) {
+		budget = debug_list_get_max_errors(dbg_list) - debug_list_get_errors_count(dbg_list);
+		if (budget < 1)
+			budget = 1;
+	}
+
+	/* Split the lines into chunks, the lines of a chunk are lexed, validated and encoded on their own thread. */
+	chunks_count = lines_count / FIRST_PASS_MIN_CHUNK_LINES;
+	if (chunks_count > jobs)
+		chunks_count = jobs;
+	if (chunks_count < 1)
+		chunks_count = 1;
+
+	chunks = (FirstPassChunk*)xcalloc(chunks_count, sizeof(FirstPassChunk));
+	for (i = 0; i < chunks_count; i++) {
+		chunks[i].lines = lines + (long)lines_count * i / chunks_count;
+		chunks[i].count = (int)((long)lines_count * (i + 1) / chunks_count - (long)lines_count * i / chunks_count);
+		chunks[i].dbg_list = debug_list_new_list();
+		debug_list_set_file(chunks[i].dbg_list, path);
+		chunks[i].cache = cache;
+		chunks[i].scratch = memory_buffer_get_new();
+		chunks[i].phy_sz = INIT_PHY_SZ;
+		chunks[i].words = (unsigned int*)xcalloc(INIT_PHY_SZ, sizeof(unsigned int));
+		chunks[i].chunks = chunks;
+		chunks[i].budget = budget;
+	}
+
+	parallel_run_tasks(chunks, chunks_count, sizeof(FirstPassChunk), prepare_chunk);
+	if (cache)
+		record_lines(cache, lines, lines_count);
+
+	/* Merge the lines in order, the symbols get their final addresses and the words are placed after the words of the previous lines. */
+	for (i = 0; i < lines_count && !debug_list_reached_limit(dbg_list); i++) {
+		rec = &lines[i];
+		debug_list_move_nodes(dbg_list, rec->chunk->dbg_list, rec->diag_begin, rec->diag_valid);
+
+		if (rec->state == FP_NONE) {
 			should_encode = FALSE;
-		}
-		else {
-			should_encode &= table[state](&it, img, sym_table, word, line, should_encode);
+			continue;
 		}
 
-		free(word);
-		free(curr_line);
-		line++;
+		line_iterator_put_line(&it, rec->text);
+		it.current = rec->text + rec->current;
+		should_encode &= table[rec->state](&it, rec, img, sym_table, rec->word, rec->number, should_encode, dbg_list);
 	}
 
-	fclose(in);
+	for (i = 0; i < chunks_count; i++) {
+		debug_list_destroy(&chunks[i].dbg_list);
+		memory_buffer_destroy(&chunks[i].scratch);
+		free(chunks[i].words);
+	}
+	for (i = 0; i < lines_count; i++)
+		free(lines[i].word);
+
+	free(chunks);
+	free(lines);
+	source_file_free(&source);
 	symbol_table_set_completed(sym_table, TRUE);
 
 	return should_encode;
 }
 
-firstPassStates get_symbol_type(LineIterator* it, char* word, errorCodes* outErr)
+/* Moves the iterator past a token, the same place line_iterator_next_word () would have left it. */
+static void skip_token(LineIterator* it, Token* token)
+{
+	it->current = token->start + token->length;
+}
+
+firstPassStates get_symbol_type(LineIterator* it, Token* tokens, int count, char* word, int* keyword, errorCodes* outErr)
 {
-	/* An .entry definition. */
-	/* Returns FP_SYM_ENT or FP_SYM_EXT. entry. extern. data or. string.*/
-	if (strcmp(word, DOT_ENTRY_STRING) == 0) {
-		return FP_SYM_ENT;
-	}
-	/* An .extern definition. */
-	/* Returns FP_SYM_EXT or FP_SYM_DEF depending on the word.*/
-	if (strcmp(word, DOT_EXTERN_STRING) == 0) {
-		return FP_SYM_EXT;
-	}
-	if (strcmp(word, DOT_DATA_STRING) == 0) {
-		return FP_SYM_DATA;
-	}
-	if (strcmp(word, DOT_STRING_STRING) == 0) {
-		return FP_SYM_STR;
-	}
-	/* Get the opcode of the word.*/
-	if (get_opcode(word) != OP_UNKNOWN) {
-		/* Unget the opcode. */
-		line_iterator_unget_word(it, word);
+	/* A directive, returns FP_SYM_ENT, FP_SYM_EXT, FP_SYM_DATA or FP_SYM_STR. */
+	if (tokens[0].type == TOKEN_DIRECTIVE) {
+		skip_token(it, &tokens[0]);
+
+		switch (tokens[0].value) {
+		case DOT_ENTRY_CODE: return FP_SYM_ENT;
+		case DOT_EXTERN_CODE: return FP_SYM_EXT;
+		case DOT_DATA_CODE: return FP_SYM_DATA;
+		case DOT_STRING_CODE: return FP_SYM_STR;
+		default: break;
+		}
+	}
+	/* An opcode, leave the iterator at the mnemonic. */
+	if (tokens[0].type == TOKEN_MNEMONIC) {
+		it->current = tokens[0].start;
 		return FP_OPCODE;
 	}
 	/* Symbol definition, may follow, .data or .string*/
 	/* Check if the word is a valid label.*/
 	if ((*outErr = check_label_syntax(word)) == ERROR_CODE_OK) {
-		char* next_word = line_iterator_next_word(it, SPACE_STRING);
-
-		/* Free the next word. */
-		if (!next_word) {
-			free(next_word);
+		if (count < 2)
 			return FP_NONE;
-		}
 
-		/* Check if .data */
-		if (strcmp(next_word, DOT_DATA_STRING) == 0) {
-			free(next_word);
-			return FP_SYM_DATA;
-		}
-		/* Check if .string */
-		if (strcmp(next_word, DOT_STRING_STRING) == 0) {
-			free(next_word);
-			return FP_SYM_STR;
+		*keyword = 1;
+
+		/* Check if .data or .string */
+		if (tokens[1].type == TOKEN_DIRECTIVE && (tokens[1].value == DOT_DATA_CODE || tokens[1].value == DOT_STRING_CODE)) {
+			skip_token(it, &tokens[1]);
+			return (tokens[1].value == DOT_DATA_CODE) ? FP_SYM_DATA : FP_SYM_STR;
 		}
 
-		/* Unget the word, and return FP_SYM_DEF */
-		line_iterator_unget_word(it, next_word);
-		free(next_word);
+		/* Leave the iterator at the next word, and return FP_SYM_DEF */
+		it->current = tokens[1].start;
 		return FP_SYM_DEF;
 	}
 
 	return FP_NONE;
 }
 
-bool first_pass_process_sym_def(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode)
+bool first_pass_process_sym_def(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list)
 {
 	/* Get a handle to the node, if the type is entry/extern then update its counter to the img->instruction_image.counter. */
 	/* If it is not an extern/entry then register an error. */
 	SymbolTableNode* node = symbol_table_search_symbol(sym_table, name);
-	char* tempCurrent = NULL;
+	errorCodes err_code;
 
 	/* Register a symbol definition node.*/
 	if (node && (symbol_get_type(symbol_node_get_sym(node)) == SYM_DATA || symbol_get_type(symbol_node_get_sym(node)) == SYM_CODE)) {
-		print_error(it->start, line, ERROR_CODE_SYMBOL_REDEFINITION);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_SYMBOL_REDEFINITION);
 		return FALSE;
 	}
 	
 	symbol_table_insert_symbol(sym_table, symbol_table_new_node(name, SYM_CODE, img_memory_get_counter(memory_buffer_get_inst_img(img))));
 
-	/* Check the syntax, we want a copy of the iterator because if the syntax is correct we will encode the instructions to memory. */
-	/* Check if the syntax is valid.*/
-	if (!validate_syntax(*it, FP_SYM_DEF, line)) {
+	/* The syntax was validated when the line was prepared, replay its result. */
+	if (!replay_validation(rec, dbg_list)) {
 		return FALSE;
 	}
 
-	/* Encode to the image.*/
-	if (should_encode) {
-		encode_opcode(it, img);
+	/* Place the encoded words in the image.*/
+	if (should_encode && (err_code = place_line_words(rec, img)) != ERROR_CODE_OK) {
+		debug_list_register_node(dbg_list, it->start, it->current, line, err_code);
+		return FALSE;
 	}
-	free(tempCurrent);
 	return TRUE;
 }
 
-bool first_pass_process_opcode(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode)
+bool first_pass_process_opcode(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list)
 {
-	/* Check the syntax, we want a copy of the iterator because if the syntax is correct we will encode the instructions to memory. */
-	if (!validate_syntax(*it, FP_OPCODE, line)) {
+	errorCodes err_code;
+
+	/* The syntax was validated when the line was prepared, replay its result. */
+	if (!replay_validation(rec, dbg_list)) {
 		return FALSE;
 	}
-	/* Encode to the image.*/
-	if (should_encode) {
-		encode_opcode(it, img);
+	/* Place the encoded words in the image.*/
+	if (should_encode && (err_code = place_line_words(rec, img)) != ERROR_CODE_OK) {
+		debug_list_register_node(dbg_list, it->start, it->current, line, err_code);
+		return FALSE;
 	}
 	return TRUE;
 }
 
-bool first_pass_process_sym_data(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode)
+bool first_pass_process_sym_data(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list)
 {
 	/* Get a handle to the node, if the type is entry/extern then update its counter to the img->instruction_image.counter. */
 	/* If it is not an extern/entry then register an error. */
 	SymbolTableNode* node = symbol_table_search_symbol(sym_table, name);
 
 	if (node && (symbol_get_type(symbol_node_get_sym(node)) == SYM_DATA || symbol_get_type(symbol_node_get_sym(node)) == SYM_CODE)) {
-		print_error(it->start, line, ERROR_CODE_SYMBOL_REDEFINITION);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_SYMBOL_REDEFINITION);
 		return FALSE;
 	}
 
@@ -171,25 +445,26 @@ bool first_pass_process_sym_data(LineIterator* it, memoryBuffer* img, SymbolTabl
 		symbol_table_insert_symbol(sym_table, symbol_table_new_node(name, SYM_DATA, img_memory_get_counter(memory_buffer_get_inst_img(img)) + img_memory_get_counter(memory_buffer_get_data_img(img))));
 	}
 
-	/* Check the syntax, we want a copy of the iterator because if the syntax is correct we will encode the instructions to memory. */
-	if (!validate_syntax(*it, FP_SYM_DATA, line)) {
+	/* The syntax was validated when the line was prepared, replay its result. */
+	if (!replay_validation(rec, dbg_list)) {
 		return FALSE;
 	}
 
-	/* Encode the .data.*/
-	if (should_encode) {
-		encode_dot_data(it, img);
+	/* Place the encoded words in the data image. */
+	if (should_encode && place_line_words(rec, img) != ERROR_CODE_OK) {
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_DATA_IMAGE_FULL);
+		return FALSE;
 	}
 
 	return TRUE;
 }
 
-bool first_pass_process_sym_string(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode)
+bool first_pass_process_sym_string(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list)
 {
 	SymbolTableNode* node = symbol_table_search_symbol(sym_table, name);
 
 	if (node && (symbol_get_type(symbol_node_get_sym(node)) == SYM_DATA || symbol_get_type(symbol_node_get_sym(node)) == SYM_CODE)) {
-		print_error(it->start, it->current, line, ERROR_CODE_SYMBOL_REDEFINITION);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_SYMBOL_REDEFINITION);
 		return FALSE;
 	}
 
@@ -197,19 +472,20 @@ bool first_pass_process_sym_string(LineIterator* it, memoryBuffer* img, SymbolTa
 		symbol_table_insert_symbol(sym_table, symbol_table_new_node(name, SYM_DATA, img_memory_get_counter(memory_buffer_get_inst_img(img)) + img_memory_get_counter(memory_buffer_get_data_img(img))));
 	}
 
-	/* Check the syntax, we want a copy of the iterator because if the syntax is correct we will encode the instructions to memory. */
-	if (!validate_syntax(*it, FP_SYM_STR, line)) {
+	/* The syntax was validated when the line was prepared, replay its result. */
+	if (!replay_validation(rec, dbg_list)) {
 		return FALSE;
 	}
 
-	/* Encode the image as a dot string. */
-	if (should_encode) {
-		encode_dot_string(it, img);
+	/* Place the encoded words in the data image. */
+	if (should_encode && place_line_words(rec, img) != ERROR_CODE_OK) {
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_DATA_IMAGE_FULL);
+		return FALSE;
 	}
 	return TRUE;
 }
 
-bool first_pass_process_sym_ent(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode)
+bool first_pass_process_sym_ent(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list)
 {
 	char* word = line_iterator_next_word(it, SPACE_STRING);
 	SymbolTableNode* node = NULL;
@@ -217,24 +493,24 @@ bool first_pass_process_sym_ent(LineIterator* it, memoryBuffer* img, SymbolTable
 	line_iterator_unget_word(it, word);
 	/* register a new word in the list*/
 	if (!word) {
-		print_error(it->start, line, ERROR_CODE_SYNTAX_ERROR);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_SYNTAX_ERROR);
 		free(word);
 		return FALSE;
 	}
 	if (!is_label_name(it)) {
-		print_error(it->start, it->current, line, ERROR_CODE_INVALID_LABEL_DEF);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_INVALID_LABEL_DEF);
 		free(word);
 		return FALSE;
 	}
 
 	if (symbol_table_search_symbol_bool(sym_table, word) && check_symbol_existence(sym_table, word, SYM_ENTRY)) {
-		print_error(it->start, it->current, line, ERROR_CODE_LABEL_ALREADY_EXISTS_AS_EXTERN);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_LABEL_ALREADY_EXISTS_AS_EXTERN);
 		free(word);
 		return FALSE;
 	}
 
 	if (get_opcode(word) != OP_UNKNOWN || is_register_name_whole(it)) {
-		print_error(it->start, it->current, line, ERROR_CODE_LABEL_CANNOT_BE_DEFINED_AS_OPCODE_OR_REGISTER);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_LABEL_CANNOT_BE_DEFINED_AS_OPCODE_OR_REGISTER);
 		free(word);
 		return FALSE;
 	}
@@ -252,37 +528,37 @@ bool first_pass_process_sym_ent(LineIterator* it, memoryBuffer* img, SymbolTable
 
 	free(word);
 
-	/* Check the syntax, we want a copy of the iterator because if the syntax is correct we will encode the instructions to memory. */
-	if (!validate_syntax(*it, FP_SYM_ENT, line)) {
+	/* The syntax was validated when the line was prepared, replay its result. */
+	if (!replay_validation(rec, dbg_list)) {
 		return FALSE;
 	}
 
 	return TRUE;
 }
 
-bool first_pass_process_sym_ext(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode)
+bool first_pass_process_sym_ext(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list)
 {
 	char* word = line_iterator_next_word(it, SPACE_STRING);
 
 	line_iterator_unget_word(it, word);
 	/* register a new word in the list*/
 	if (!word) {
-		print_error(it->start, it->current, line, ERROR_CODE_SYNTAX_ERROR);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_SYNTAX_ERROR);
 		free(word);
 		return FALSE;
 	}
 	if (!is_label_name(it)) {
-		print_error(it->start, it->current, line, ERROR_CODE_INVALID_LABEL_DEF);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_INVALID_LABEL_DEF);
 		free(word);
 		return FALSE;
 	}
 	if (symbol_table_search_symbol_bool(sym_table, word) && check_symbol_existence(sym_table, word, SYM_EXTERN)) {
-		print_error(it->start, it->current, line, ERROR_CODE_LABEL_ALREADY_EXISTS_AS_ENTRY);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_LABEL_ALREADY_EXISTS_AS_ENTRY);
 		free(word);
 		return FALSE;
 	}
 	if (get_opcode(word) != OP_UNKNOWN || is_register_name_whole(it)) {
-		print_error(it->start, it->current, line, ERROR_CODE_LABEL_CANNOT_BE_DEFINED_AS_OPCODE_OR_REGISTER);
+		debug_list_register_node(dbg_list, it->start, it->current, line, ERROR_CODE_LABEL_CANNOT_BE_DEFINED_AS_OPCODE_OR_REGISTER);
 		free(word);
 		return FALSE;
 	}
@@ -290,18 +566,10 @@ bool first_pass_process_sym_ext(LineIterator* it, memoryBuffer* img, SymbolTable
 	symbol_table_insert_symbol(sym_table, symbol_table_new_node(word, SYM_EXTERN, 0));
 	free(word);
 
-	/* Check the syntax, we want a copy of the iterator because if the syntax is correct we will encode the instructions to memory. */
-	if (!validate_syntax(*it, FP_SYM_ENT, line)) {
+	/* The syntax was validated when the line was prepared, replay its result. */
+	if (!replay_validation(rec, dbg_list)) {
 		return FALSE;
 	}
 
 	return TRUE;
 }
-
-void find_uncessery_syms(LineIterator* it, long line)
-{
-	if ((line_iterator_word_includes(it, DOT_EXTERN_STRING) || (line_iterator_word_includes(it, DOT_ENTRY_STRING))) && line_iterator_word_includes(it, COLON_STRING)) {
-		line_iterator_jump_to(it, COLON_CHAR);
-		print_error(it->start, line, ERROR_CODE_SYMBOL_IGNORED_WARN);
-	}
-}
@@ -6,39 +6,66 @@
 
 #include "symbol_table.h"
 #include "line_iterator.h"
+#include "line_reader.h"
 #include "memory.h"
 #include "debug.h"
+#include "file_store.h"
+#include "lexer.h"
+#include "line_cache.h"
 
+/* A source of fewer lines is prepared without the line cache, lexing its lines again costs less than reading and writing the cache. */
+#define FIRST_PASS_MIN_CACHED_LINES 2000
 
 /**
 * @brief An enum for the different states of the first pass algorithm.
 */
 typedef enum { FP_SYM_DEF, FP_SYM_DATA, FP_SYM_STR, FP_SYM_EXT, FP_SYM_ENT, FP_OPCODE, FP_TOTAL, FP_NONE } firstPassStates;
 
+/**
+* @brief A forward declaration of a line that was prepared by the first pass, declaration in the '.c' file.
+* A prepared line was classified, validated and encoded, everything that doesn't depend on the other lines.
+*/
+typedef struct firstPassLine FirstPassLine;
+
+/**
+* @brief A forward declaration of a chunk of lines that is prepared on a single thread, declaration in the '.c' file.
+*/
+typedef struct firstPassChunk FirstPassChunk;
+
 /** 
 * @brief This function implements the first pass algorithm.
+* The lines are split into chunks that are prepared in parallel, the prepared lines are then merged in order:
+* the symbols get their final addresses, the encoded words are placed in the image and the diagnostics keep the order of the lines.
 * @param path - The path to the pre-assembled file.
 * @param img - A pointer to the memory buffer, contains the data/instruction img and the registers.
 * @param sym_table - A pointer to the symbol table.
+* @param jobs - The maximal amount of threads to prepare the lines on.
+* @param cache - The lines of the previous run, a line that is in it isn't prepared again, and the lines of this run are recorded in it. NULL to prepare every line,
+* it's ignored for a source of fewer than FIRST_PASS_MIN_CACHED_LINES lines.
+* @param store - The files of the assembly, the pre-assembled file is read from it.
 * @param dbg_list - A pointer to the debug list, used to register errors.
 * @return - TRUE if no errors occurred, FALSE otherwise.
 */
-bool do_first_pass(char* path, memoryBuffer* img, SymbolTable* sym_table);
+bool do_first_pass(char* path, memoryBuffer* img, SymbolTable* sym_table, int jobs, LineCache* cache, FileStore* store, debugList* dbg_list);
 
 /** 
  * @brief This function take in a string, and checks if it's a symbol, if so it returns it's type.
  * This function also checks if the symbol name is a valid symbol name.
- * @param it - A string to do the check upon.
+ * @param it - A string to do the check upon, it's left where the processing of the line should continue.
+ * @param tokens - The tokens of the line.
+ * @param count - The amount of tokens.
  * @param word - the stymbol type being searched
+ * @param keyword - Set to the index of the token the processing should start at, i.e the mnemonic or the directive.
  * @param outErr - error code to be edited in case of an error
  * @return A appropriate firstPassState.
 */
-firstPassStates get_symbol_type(LineIterator* it, char* word, errorCodes* outErr);
+firstPassStates get_symbol_type(LineIterator* it, Token* tokens, int count, char* word, int* keyword, errorCodes* outErr);
 
 /**
 * @brief This function is used to process lines with label definitions.
 * It also encodes the memory if possible into the memoryBuffer and updates the symbol table if necessary.
 * @param it - The line interator.
+* @param rec - The prepared line, its syntax validation is replayed and its encoded words are placed in the image.
 * @param img - The memory buffer.
 * @param sym_table - The symbol table.
 * @param dbg_list - The debug list.
@@ -47,12 +74,13 @@ firstPassStates get_symbol_type(LineIterator* it, char* word, errorCodes* outErr
 * param should_encode - If there is an error we can skip the encoding phase.
 * @return True if there are no errors, false otherwise.
 */
-bool first_pass_process_sym_def(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode);
+bool first_pass_process_sym_def(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list);
 
 /**
 * @brief This function is used to process .entry lines.
 * It also encodes the memory if possible into the memoryBuffer and updates the symbol table if necessary.
 * @param it - The line interator.
+* @param rec - The prepared line, unused, the checks of the operand depend on the symbol table so the line is validated here.
 * @param img - The memory buffer.
 * @param sym_table - The symbol table.
 * @param dbg_list - The debug list.
@@ -61,12 +89,13 @@ bool first_pass_process_sym_def(LineIterator* it, memoryBuffer* img, SymbolTable
 * param should_encode - If there is an error we can skip the encoding phase.
 * @return True if there are no errors, false otherwise.
 */
-bool first_pass_process_sym_ent(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode);
+bool first_pass_process_sym_ent(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list);
 
 /**
 * @brief This function is used to process .string lines.
 * It also encodes the memory if possible into the memoryBuffer and updates the symbol table if necessary.
 * @param it - The line interator.
+* @param rec - The prepared line, its syntax validation is replayed and its encoded words are placed in the image.
 * @param img - The memory buffer.
 * @param sym_table - The symbol table.
 * @param dbg_list - The debug list.
@@ -75,12 +104,13 @@ bool first_pass_process_sym_ent(LineIterator* it, memoryBuffer* img, SymbolTable
 * param should_encode - If there is an error we can skip the encoding phase.
 * @return True if there are no errors, false otherwise.
 */
-bool first_pass_process_sym_string(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode);
+bool first_pass_process_sym_string(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list);
 
 /**
 * @brief This function is used to process .data lines.
 * It also encodes the memory if possible into the memoryBuffer and updates the symbol table if necessary.
 * @param it - The line interator.
+* @param rec - The prepared line, its syntax validation is replayed and its encoded words are placed in the image.
 * @param img - The memory buffer.
 * @param sym_table - The symbol table.
 * @param dbg_list - The debug list.
@@ -89,12 +119,13 @@ bool first_pass_process_sym_string(LineIterator* it, memoryBuffer* img, SymbolTa
 * param should_encode - If there is an error we can skip the encoding phase.
 * @return True if there are no errors, false otherwise.
 */
-bool first_pass_process_sym_data(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode);
+bool first_pass_process_sym_data(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list);
 
 /**
 * @brief This function is used to process .extern lines.
 * It also encodes the memory if possible into the memoryBuffer and updates the symbol table if necessary.
 * @param it - The line interator.
+* @param rec - The prepared line, unused, the checks of the operand depend on the symbol table so the line is validated here.
 * @param img - The memory buffer.
 * @param sym_table - The symbol table.
 * @param dbg_list - The debug list.
@@ -103,12 +134,13 @@ bool first_pass_process_sym_data(LineIterator* it, memoryBuffer* img, SymbolTabl
 * param should_encode - If there is an error we can skip the encoding phase.
 * @return True if there are no errors, false otherwise.
 */
-bool first_pass_process_sym_ext(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode);
+bool first_pass_process_sym_ext(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list);
 
 /**
 * @brief This function is used to process lines with opcodes and no label definitions.
 * It also encodes the memory if possible into the memoryBuffer and updates the symbol table if necessary.
 * @param it - The line interator.
+* @param rec - The prepared line, its syntax validation is replayed and its encoded words are placed in the image.
 * @param img - The memory buffer.
 * @param sym_table - The symbol table.
 * @param dbg_list - The debug list.
@@ -117,14 +149,6 @@ bool first_pass_process_sym_ext(LineIterator* it, memoryBuffer* img, SymbolTable
 * param should_encode - If there is an error we can skip the encoding phase.
 * @return True if there are no errors, false otherwise.
 */
-bool first_pass_process_opcode(LineIterator* it, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode);
-
-/**
-@brief Finds unnecessary symbols in a line of code that contains an extern or entry directive and a colon.
-@param it A pointer to the LineIterator object used to iterate over the line.
-@param line The number of the line being checked.
-@param dbg A pointer to the debugList object used to store debug information.
-*/
-void find_uncessery_syms(LineIterator* it, long line);
+bool first_pass_process_opcode(LineIterator* it, FirstPassLine* rec, memoryBuffer* img, SymbolTable* sym_table, char* name, long line, bool should_encode, debugList* dbg_list);
 
 #endif
@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "include_cache.h"
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+struct includedFile
+{
+	char* path;
+	time_t mtime_sec; /* The modification time and the size of the file when it was loaded. */
+	long mtime_nsec;
+	off_t size;
+	void* data;
+	IncludeFreeFunc free_data;
+	int refs; /* How many sources hold the entry. */
+	bool is_loading; /* TRUE while the file is loaded outside of the lock, the sources that acquire it meanwhile wait for the load. */
+	bool is_stale; /* TRUE once the file changed, the entry is no longer in the list and it's freed by its last release. */
+	struct includedFile* next;
+};
+
+/* Every entry of the process, they are few (the files that are included), so they are searched in order. */
+static IncludedFile* cache_head = NULL;
+static long cache_loads_count = 0;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cache_loaded = PTHREAD_COND_INITIALIZER;
+
+static void included_file_free(IncludedFile* file)
+{
+	if (file->data)
+		file->free_data(file->data);
+	free(file->path);
+	free(file);
+}
+
+/* Takes a stale entry out of the list, it's freed now if no source holds it. Called with the lock held. */
+static void include_cache_unlink(IncludedFile* file)
+{
+	IncludedFile** link = &cache_head;
+
+	while (*link != file)
+		link = &(*link)->next;
+	*link = file->next;
+
+	file->is_stale = TRUE;
+	if (file->refs == 0)
+		included_file_free(file);
+}
+
+/* Drops a reference to an entry, a stale entry is freed by its last one. Called with the lock held. */
+static void include_cache_unref(IncludedFile* file)
+{
+	if (--file->refs == 0 && file->is_stale)
+		included_file_free(file);
+}
+
+IncludedFile* include_cache_acquire(char* path, IncludeLoadFunc load, IncludeFreeFunc free_data, void* context)
+{
+	IncludedFile* file;
+	struct stat info;
+	void* data;
+	bool is_found = (stat(path, &info) == 0);
+
+	pthread_mutex_lock(&cache_lock);
+
+	for (file = cache_head; file && strcmp(file->path, path) != 0; file = file->next);
+
+	if (file && is_found && file->mtime_sec == info.st_mtim.tv_sec && file->mtime_nsec == info.st_mtim.tv_nsec && file->size == info.st_size) {
+		file->refs++;
+		while (file->is_loading)
+			pthread_cond_wait(&cache_loaded, &cache_lock);
+
+		/* The load failed, the entry was taken out of the list by the source that loaded it. */
+		if (!file->data) {
+			include_cache_unref(file);
+			file = NULL;
+		}
+
+		pthread_mutex_unlock(&cache_lock);
+		return file;
+	}
+
+	/* The file changed or it's gone, the sources that hold the old entry keep it until they release it. */
+	if (file)
+		include_cache_unlink(file);
+
+	if (!is_found) {
+		pthread_mutex_unlock(&cache_lock);
+		return NULL;
+	}
+
+	/* The entry is listed before it's loaded, so the sources that include the file meanwhile wait for this load rather than load it too.
+	*  The lock isn't held by the load, the sources that include other files go on. */
+	file = (IncludedFile*)xmalloc(sizeof(IncludedFile));
+	file->path = get_copy_string(path);
+	file->mtime_sec = info.st_mtim.tv_sec;
+	file->mtime_nsec = info.st_mtim.tv_nsec;
+	file->size = info.st_size;
+	file->data = NULL;
+	file->free_data = free_data;
+	file->refs = 1;
+	file->is_loading = TRUE;
+	file->is_stale = FALSE;
+	file->next = cache_head;
+	cache_head = file;
+
+	pthread_mutex_unlock(&cache_lock);
+	data = load(path, context);
+	pthread_mutex_lock(&cache_lock);
+
+	file->data = data;
+	file->is_loading = FALSE;
+	if (data) {
+		cache_loads_count++;
+	}
+	else {
+		/* Another source may have replaced the entry while it was loaded. */
+		if (!file->is_stale)
+			include_cache_unlink(file);
+		include_cache_unref(file);
+		file = NULL;
+	}
+
+	pthread_cond_broadcast(&cache_loaded);
+	pthread_mutex_unlock(&cache_lock);
+	return file;
+}
+
+void* include_cache_get_data(IncludedFile* file)
+{
+	return file->data;
+}
+
+void include_cache_release(IncludedFile** file)
+{
+	pthread_mutex_lock(&cache_lock);
+	include_cache_unref(*file);
+	pthread_mutex_unlock(&cache_lock);
+	*file = NULL;
+}
+
+long include_cache_get_loads_count()
+{
+	long count;
+
+	pthread_mutex_lock(&cache_lock);
+	count = cache_loads_count;
+	pthread_mutex_unlock(&cache_lock);
+
+	return count;
+}
+
+void include_cache_clear()
+{
+	IncludedFile* file, * next;
+
+	pthread_mutex_lock(&cache_lock);
+
+	for (file = cache_head; file; file = next) {
+		next = file->next;
+		if (file->refs == 0)
+			include_cache_unlink(file);
+	}
+
+	pthread_mutex_unlock(&cache_lock);
+}
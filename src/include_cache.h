@@ -0,0 +1,70 @@
+#ifndef INCLUDE_CACHE_H
+#define INCLUDE_CACHE_H
+
+/** @file
+*	This header declares the include cache, it keeps every file that was included by a source for the whole process.
+*   A file is keyed by its path, its modification time and its size, so it's loaded once and reused by every source that includes it,
+*   in the same batch and in the later runs of a long lived process (i.e the watch mode). A file that changed on the disk is loaded again.
+*   The cache doesn't know what a loaded file is, the caller passes the functions that load and free it. It's locked, but a file is loaded
+*   outside of the lock: a source that includes a file that is being loaded waits for that load rather than load it twice, and the sources
+*   that include other files aren't held by it.
+*   Only the files on the disk are cached, the sources of a sealed file store (see 'file_store.h') include the files of their store instead.
+*/
+
+#include "utils.h"
+
+/**
+* @brief A forward declaration of an entry of the include cache, declaration in the '.c' file.
+*/
+typedef struct includedFile IncludedFile;
+
+/**
+* @brief A function that loads a file into the data the cache keeps for it.
+* @param path - The path of the file.
+* @param context - The context that was given to include_cache_acquire.
+* @return The data, NULL if the file couldn't be read.
+*/
+typedef void* (*IncludeLoadFunc)(char* path, void* context);
+
+/**
+* @brief A function that frees the data of a loaded file.
+* @param data - The data.
+*/
+typedef void (*IncludeFreeFunc)(void* data);
+
+/**
+* @brief This function returns the entry of a file, it's loaded if it isn't cached or if it changed since it was cached.
+* Every entry that was acquired must be released.
+* @param path - The path of the file.
+* @param load - The function that loads the file.
+* @param free_data - The function that frees the data of the file once it's no longer cached.
+* @param context - The context that is passed to the load function, i.e the file store it reads the file through.
+* @return The entry, NULL if the file couldn't be read.
+*/
+IncludedFile* include_cache_acquire(char* path, IncludeLoadFunc load, IncludeFreeFunc free_data, void* context);
+
+/**
+* @brief This function returns the data of an entry, as it was loaded.
+* @param file - The entry.
+* @return The data.
+*/
+void* include_cache_get_data(IncludedFile* file);
+
+/**
+* @brief This function releases an entry, it stays cached unless the file changed since.
+* @param file - The entry, it's set to NULL.
+*/
+void include_cache_release(IncludedFile** file);
+
+/**
+* @brief This function returns how many times a file was loaded by the cache, i.e to check that an included file is only read once.
+* @return The amount of loads.
+*/
+long include_cache_get_loads_count();
+
+/**
+* @brief This function frees every entry that isn't acquired, i.e before the process exits.
+*/
+void include_cache_clear();
+
+#endif
@@ -0,0 +1,159 @@
+#include "lexer.h"
+#include "char_scanner.h"
+#include "syntactical_analysis.h"
+#include <string.h>
+#include <ctype.h>
+
+#define MNEMONIC_MAX_LENGTH 4
+#define REGISTER_NAME_LENGTH 2
+#define PUNCTUATION_STRING ",()"
+#define OPERAND_SEPS_STRING " ,()\""
+
+struct tokenList
+{
+	int log_sz;
+	int phy_sz;
+	Token* tokens; /* A dynamic array of tokens, reused between lines. */
+};
+
+TokenList* token_list_new_list()
+{
+	TokenList* list = (TokenList*)xmalloc(sizeof(TokenList));
+
+	list->log_sz = INIT_LOG_SZ;
+	list->phy_sz = INIT_PHY_SZ;
+	list->tokens = (Token*)xcalloc(INIT_PHY_SZ, sizeof(Token));
+
+	return list;
+}
+
+static Token* token_list_push(TokenList* list, TokenType type, char* start, char* end)
+{
+	Token* token;
+
+	if (list->log_sz + 1 >= list->phy_sz) {
+		GROW_CAPACITY(list->phy_sz);
+		list->tokens = GROW_ARRAY(Token*, list->tokens, list->phy_sz, sizeof(Token));
+	}
+
+	token = &list->tokens[list->log_sz++];
+	token->type = type;
+	token->start = start;
+	token->length = (int)(end - start);
+	token->value = 0;
+
+	return token;
+}
+
+static int get_directive_code(Token* token)
+{
+	if (token_equals(token, DOT_DATA_STRING)) return DOT_DATA_CODE;
+	if (token_equals(token, DOT_STRING_STRING)) return DOT_STRING_CODE;
+	if (token_equals(token, DOT_ENTRY_STRING)) return DOT_ENTRY_CODE;
+	if (token_equals(token, DOT_EXTERN_STRING)) return DOT_EXTERN_CODE;
+	return 0;
+}
+
+static Opcodes get_token_opcode(Token* token)
+{
+	char name[MNEMONIC_MAX_LENGTH + 1] = { 0 };
+
+	if (token->length > MNEMONIC_MAX_LENGTH)
+		return OP_UNKNOWN;
+
+	memcpy(name, token->start, token->length * sizeof(char));
+	return get_opcode(name);
+}
+
+/* Sets the type (and the value) of a word token. */
+static void classify_word(Token* token, bool is_first)
+{
+	char first = *token->start;
+
+	if (is_first && token->start[token->length - 1] == COLON_CHAR) {
+		token->type = TOKEN_LABEL_DEF;
+	}
+	else if (first == POSTFIX_DOT_CHAR) {
+		token->type = TOKEN_DIRECTIVE;
+		token->value = get_directive_code(token);
+	}
+	else if (first == HASH_CHAR || first == POS_SIGN_CHAR || first == NEG_SIGN_CHAR || isdigit((unsigned char)first)) {
+		token->type = TOKEN_IMMEDIATE;
+	}
+	else if (token->length == REGISTER_NAME_LENGTH && first == REG_BEG_CHAR && REG_MIN_NUM <= token->start[1] && token->start[1] <= REG_MAX_NUM) {
+		token->type = TOKEN_REGISTER;
+		token->value = token->start[1] - REG_MIN_NUM;
+	}
+	else if ((token->value = get_token_opcode(token)) != OP_UNKNOWN) {
+		token->type = TOKEN_MNEMONIC;
+	}
+	else {
+		token->type = TOKEN_IDENTIFIER;
+		token->value = 0;
+	}
+}
+
+int token_list_lex_line(TokenList* list, char* line)
+{
+	char* current = line, * end = NULL;
+	int head_words = 1;
+	Token* token;
+
+	list->log_sz = 0;
+
+	while (*(current = char_scanner_skip_blanks(current)) != '\0') {
+		if (head_words > 0) {
+			/* The head of the line, i.e the label definition and the mnemonic/directive, ends at a blank. */
+			end = char_scanner_find_any(current, SPACE_STRING);
+			token = token_list_push(list, TOKEN_IDENTIFIER, current, end);
+			classify_word(token, list->log_sz == 1);
+			head_words += (token->type == TOKEN_LABEL_DEF) ? 0 : -1;
+		}
+		else if (*current == QUOTE_CHAR) {
+			/* A string runs until the last quote of the line, or until the end of the line if it's not closed. */
+			end = strrchr(current, QUOTE_CHAR);
+			end = (end == current) ? current + strlen(current) : end + 1;
+			token_list_push(list, TOKEN_STRING, current, end);
+		}
+		else if (strchr(PUNCTUATION_STRING, *current)) {
+			end = current + 1;
+			token_list_push(list, TOKEN_PUNCTUATION, current, end)->value = *current;
+		}
+		else {
+			end = char_scanner_find_any(current, OPERAND_SEPS_STRING);
+			classify_word(token_list_push(list, TOKEN_IDENTIFIER, current, end), FALSE);
+		}
+
+		current = end;
+	}
+
+	return list->log_sz;
+}
+
+int token_list_get_count(TokenList* list)
+{
+	return list->log_sz;
+}
+
+Token* token_list_get_tokens(TokenList* list)
+{
+	return list->tokens;
+}
+
+void token_list_destroy(TokenList** list)
+{
+	free((*list)->tokens);
+	free(*list);
+}
+
+bool token_equals(Token* token, char* text)
+{
+	return ((size_t)token->length == strlen(text) && strncmp(token->start, text, token->length) == 0) ? TRUE : FALSE;
+}
+
+char* token_get_copy(Token* token)
+{
+	char* copy = (char*)xcalloc(token->length + 1, sizeof(char));
+	memcpy(copy, token->start, token->length * sizeof(char));
+	return copy;
+}
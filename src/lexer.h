@@ -0,0 +1,88 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+/** @file
+*	This header declares the lexer, which turns a source line into an array of typed tokens in a single scan.
+*   The tokens of a line are produced once, and shared by the first pass classification and the encoders.
+*/
+
+#include "utils.h"
+
+/**
+* @brief This enumeration is used to represent each token type with a specific numeric constant.
+*/
+typedef enum
+{
+	TOKEN_LABEL_DEF, TOKEN_DIRECTIVE, TOKEN_MNEMONIC, TOKEN_REGISTER,
+	TOKEN_IMMEDIATE, TOKEN_IDENTIFIER, TOKEN_PUNCTUATION, TOKEN_STRING
+} TokenType;
+
+/**
+* @brief This data structure is a view of a single token inside a line, it does not own the memory it points to.
+* Like the LineIterator, tokens are small and are passed around and stored by value.
+*/
+typedef struct
+{
+	TokenType type;
+	char* start; /* Pointer to the first char of the token inside the line. */
+	int length; /* The amount of chars in the token. */
+	int value; /* The opcode of a mnemonic, the number of a register, the code of a directive or the char of a punctuation. */
+} Token;
+
+/**
+* @brief A forward declaration of the token list, a reusable array of the tokens of the current line.
+*/
+typedef struct tokenList TokenList;
+
+/**
+* @brief This function creates a new empty token list.
+* @return An empty token list.
+*/
+TokenList* token_list_new_list();
+
+/**
+* @brief This function lexes a line into the token list, the previous tokens are discarded.
+* The first word (and the second one if the first is a label definition) is the head of the line and it ends at a blank,
+* the operands that follow it are also seperated by commas and parenthesis.
+* @param list - The list.
+* @param line - The line, it must outlive the tokens.
+* @return The amount of tokens in the line.
+*/
+int token_list_lex_line(TokenList* list, char* line);
+
+/**
+* @brief This function returns the amount of tokens in the list.
+* @param list - The list.
+* @return The amount of tokens.
+*/
+int token_list_get_count(TokenList* list);
+
+/**
+* @brief This function returns a pointer to the tokens array of the list.
+* @param list - The list.
+* @return The tokens array, it is valid until the next line is lexed.
+*/
+Token* token_list_get_tokens(TokenList* list);
+
+/**
+* @brief This function frees a token list.
+* @param list - The list to free.
+*/
+void token_list_destroy(TokenList** list);
+
+/**
+* @brief This function checks if the token is exactly the given text.
+* @param token - The token.
+* @param text - The text.
+* @return True if the token matches the text, false otherwise.
+*/
+bool token_equals(Token* token, char* text);
+
+/**
+* @brief This function copies the text of a token into a new string, the caller must free it.
+* @param token - The token.
+* @return A copy of the token's text.
+*/
+char* token_get_copy(Token* token);
+
+#endif
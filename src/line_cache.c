@@ -0,0 +1,285 @@
+#include "line_cache.h"
+#include <limits.h>
+
+/* The start of the sidecar file, a cache of another version is ignored. */
+#define LINE_CACHE_HEADER "asm14 line cache 3\n"
+/* Written after the header, padded to a whole unsigned int, a cache that was written on a machine of another byte order or int size doesn't read back as this value. */
+#define LINE_CACHE_BYTE_ORDER 0x01020304U
+/* A record starts with these fields, then the words, the text and the word with their '\0', padded to a whole unsigned int. */
+#define LINE_CACHE_FIELDS 8
+#define FIELD_STATE 0
+#define FIELD_KEYWORD 1
+#define FIELD_CURRENT 2
+#define FIELD_IS_VALID 3
+#define FIELD_IS_IMAGE_FULL 4
+#define FIELD_WORDS_COUNT 5
+#define FIELD_TEXT_LENGTH 6
+#define FIELD_WORD_LENGTH 7
+#define RECORD_ALIGN(size) (((size) + sizeof(unsigned int) - 1) / sizeof(unsigned int) * sizeof(unsigned int))
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+#define FNV_MASK 0xFFFFFFFFUL
+#define EMPTY_SLOT -1
+
+typedef struct
+{
+	size_t log_sz;
+	size_t phy_sz;
+	char* bytes;
+} recordBuffer;
+
+struct lineCache
+{
+	char* file; /* The file that was loaded, the text, the word and the words of the loaded lines point into it. */
+	CachedLine* loaded; /* The lines of the previous run, in the order of the file. */
+	int loaded_count;
+	int* slots; /* The indexes of the loaded lines by the hash of their text, EMPTY_SLOT for none. */
+	unsigned long slots_mask;
+	recordBuffer recorded; /* The records of the lines of this run, in the order they were recorded, as they are saved. */
+	int recorded_count;
+};
+
+/* FNV-1a over the text of a line. */
+static unsigned long hash_text(char* text)
+{
+	unsigned long hash = FNV_OFFSET_BASIS;
+
+	for (; *text; text++)
+		hash = ((hash ^ (unsigned char)*text) * FNV_PRIME) & FNV_MASK;
+
+	return hash;
+}
+
+LineCache* line_cache_new()
+{
+	return (LineCache*)xcalloc(1, sizeof(LineCache));
+}
+
+/* Parses a record at 'at', 'end' is the end of the file. Returns the start of the next record, NULL if the record is damaged. */
+static char* parse_record(char* at, char* end, CachedLine* line)
+{
+	unsigned int fields[LINE_CACHE_FIELDS];
+	unsigned int max[LINE_CACHE_FIELDS] = { INT_MAX, 1, 0, 1, 1, RAM_MEMORY_SZ, INT_MAX, INT_MAX };
+	size_t size;
+	int i;
+
+	if ((size_t)(end - at) < sizeof(fields))
+		return NULL;
+
+	memcpy(fields, at, sizeof(fields));
+	max[FIELD_CURRENT] = fields[FIELD_TEXT_LENGTH];
+	for (i = 0; i < LINE_CACHE_FIELDS; i++)
+		if (fields[i] > max[i])
+			return NULL;
+
+	/* A line without a text or a word is never kept. */
+	size = sizeof(fields) + fields[FIELD_WORDS_COUNT] * sizeof(unsigned int) + fields[FIELD_TEXT_LENGTH] + fields[FIELD_WORD_LENGTH] + 2;
+	if (fields[FIELD_TEXT_LENGTH] == 0 || fields[FIELD_WORD_LENGTH] == 0 || (size_t)(end - at) < RECORD_ALIGN(size))
+		return NULL;
+
+	line->state = (int)fields[FIELD_STATE];
+	line->keyword = (int)fields[FIELD_KEYWORD];
+	line->current = fields[FIELD_CURRENT];
+	line->is_valid = fields[FIELD_IS_VALID] ? TRUE : FALSE;
+	line->is_image_full = fields[FIELD_IS_IMAGE_FULL] ? TRUE : FALSE;
+	line->words_count = (int)fields[FIELD_WORDS_COUNT];
+	line->words = (unsigned int*)(at + sizeof(fields));
+	line->text = (char*)(line->words + line->words_count);
+	line->word = line->text + fields[FIELD_TEXT_LENGTH] + 1;
+
+	for (i = 0; i < line->words_count; i++)
+		if (line->words[i] > WORD_FORMAT_MASK)
+			return NULL;
+
+	if (strlen(line->text) != fields[FIELD_TEXT_LENGTH] || strlen(line->word) != fields[FIELD_WORD_LENGTH])
+		return NULL;
+
+	return at + RECORD_ALIGN(size);
+}
+
+/* Fills the slots of the loaded lines, there are at least twice as many slots as lines. A text that is loaded twice keeps its first line. */
+static void hash_lines(LineCache* cache)
+{
+	unsigned long count = 1, slot;
+	int i;
+
+	while (count < 2UL * (unsigned long)cache->loaded_count)
+		count *= 2;
+
+	cache->slots_mask = count - 1;
+	cache->slots = (int*)xmalloc(count * sizeof(int));
+	for (slot = 0; slot < count; slot++)
+		cache->slots[slot] = EMPTY_SLOT;
+
+	for (i = 0; i < cache->loaded_count; i++) {
+		slot = hash_text(cache->loaded[i].text) & cache->slots_mask;
+		while (cache->slots[slot] != EMPTY_SLOT && strcmp(cache->loaded[cache->slots[slot]].text, cache->loaded[i].text) != 0)
+			slot = (slot + 1) & cache->slots_mask;
+		if (cache->slots[slot] == EMPTY_SLOT)
+			cache->slots[slot] = i;
+	}
+}
+
+/* Drops a cache that can't be used, none of it is used. */
+static bool drop_loaded(LineCache* cache)
+{
+	free(cache->file);
+	free(cache->loaded);
+	cache->file = NULL;
+	cache->loaded = NULL;
+	cache->loaded_count = 0;
+	return FALSE;
+}
+
+bool line_cache_load(LineCache* cache, char* path)
+{
+	FILE* in = open_file(path, MODE_READ);
+	size_t header_size = RECORD_ALIGN(strlen(LINE_CACHE_HEADER)), size;
+	unsigned int byte_order;
+	char* at, * end;
+	long length;
+
+	if (!in)
+		return FALSE;
+
+	fseek(in, 0, SEEK_END);
+	length = ftell(in);
+	rewind(in);
+
+	/* The records are read in place, the buffer of malloc is aligned for their ints. */
+	size = (length > 0) ? (size_t)length : 0;
+	cache->file = (char*)xmalloc(size + 1);
+	size = fread(cache->file, sizeof(char), size, in);
+	cache->file[size] = BACKSLASH_ZERO; /* The texts of a damaged record end here at the latest. */
+	fclose(in);
+
+	if (size < header_size + sizeof(byte_order) || memcmp(cache->file, LINE_CACHE_HEADER, strlen(LINE_CACHE_HEADER)) != 0)
+		return drop_loaded(cache);
+
+	memcpy(&byte_order, cache->file + header_size, sizeof(byte_order));
+	if (byte_order != LINE_CACHE_BYTE_ORDER)
+		return drop_loaded(cache);
+
+	/* A record takes more than its fields, so the lines fit without growing the array. */
+	cache->loaded = (CachedLine*)xmalloc((size / (LINE_CACHE_FIELDS * sizeof(unsigned int)) + 1) * sizeof(CachedLine));
+	end = cache->file + size;
+	for (at = cache->file + header_size + sizeof(byte_order); at < end; cache->loaded_count++) {
+		/* A damaged cache could be wrong anywhere, none of it is used. */
+		if (!(at = parse_record(at, end, &cache->loaded[cache->loaded_count])))
+			return drop_loaded(cache);
+	}
+
+	hash_lines(cache);
+	return TRUE;
+}
+
+CachedLine* line_cache_find(LineCache* cache, char* text)
+{
+	unsigned long slot;
+
+	if (cache->loaded_count == 0)
+		return NULL;
+
+	for (slot = hash_text(text) & cache->slots_mask; cache->slots[slot] != EMPTY_SLOT; slot = (slot + 1) & cache->slots_mask)
+		if (strcmp(cache->loaded[cache->slots[slot]].text, text) == 0)
+			return &cache->loaded[cache->slots[slot]];
+
+	return NULL;
+}
+
+CachedLine* line_cache_find_after(LineCache* cache, CachedLine* previous, char* text)
+{
+	/* The lines of an edited source mostly follow each other as they did in the previous run. */
+	if (previous && previous + 1 < cache->loaded + cache->loaded_count && strcmp(previous[1].text, text) == 0)
+		return previous + 1;
+
+	return line_cache_find(cache, text);
+}
+
+/* Appends bytes to the records, 'bytes' may be NULL for zeroes. */
+static void append_bytes(recordBuffer* buffer, void* bytes, size_t size)
+{
+	if (buffer->log_sz + size > buffer->phy_sz) {
+		if (buffer->phy_sz == 0)
+			buffer->phy_sz = INIT_PHY_SZ;
+		while (buffer->log_sz + size > buffer->phy_sz)
+			GROW_CAPACITY(buffer->phy_sz);
+		buffer->bytes = GROW_ARRAY(char*, buffer->bytes, buffer->phy_sz, sizeof(char));
+	}
+
+	if (bytes)
+		memcpy(buffer->bytes + buffer->log_sz, bytes, size);
+	else
+		memset(buffer->bytes + buffer->log_sz, 0, size);
+	buffer->log_sz += size;
+}
+
+void line_cache_record(LineCache* cache, CachedLine* line)
+{
+	unsigned int fields[LINE_CACHE_FIELDS];
+	size_t size, begin = cache->recorded.log_sz;
+	char* record;
+
+	/* A line that was taken from the cache is copied as it was loaded. */
+	if (cache->loaded_count > 0 && line >= cache->loaded && line < cache->loaded + cache->loaded_count) {
+		record = (char*)line->words - sizeof(fields);
+		append_bytes(&cache->recorded, record, RECORD_ALIGN((size_t)(line->word + strlen(line->word) + 1 - record)));
+		cache->recorded_count++;
+		return;
+	}
+
+	fields[FIELD_STATE] = (unsigned int)line->state;
+	fields[FIELD_KEYWORD] = (unsigned int)line->keyword;
+	fields[FIELD_CURRENT] = (unsigned int)line->current;
+	fields[FIELD_IS_VALID] = line->is_valid ? 1 : 0;
+	fields[FIELD_IS_IMAGE_FULL] = line->is_image_full ? 1 : 0;
+	fields[FIELD_WORDS_COUNT] = (unsigned int)line->words_count;
+	fields[FIELD_TEXT_LENGTH] = (unsigned int)strlen(line->text);
+	fields[FIELD_WORD_LENGTH] = (unsigned int)strlen(line->word);
+
+	append_bytes(&cache->recorded, fields, sizeof(fields));
+	append_bytes(&cache->recorded, line->words, line->words_count * sizeof(unsigned int));
+	append_bytes(&cache->recorded, line->text, fields[FIELD_TEXT_LENGTH] + 1);
+	append_bytes(&cache->recorded, line->word, fields[FIELD_WORD_LENGTH] + 1);
+
+	size = cache->recorded.log_sz - begin;
+	append_bytes(&cache->recorded, NULL, RECORD_ALIGN(size) - size);
+	cache->recorded_count++;
+}
+
+int line_cache_get_recorded_count(LineCache* cache)
+{
+	return cache->recorded_count;
+}
+
+bool line_cache_save(LineCache* cache, char* path)
+{
+	FILE* out = open_file(path, MODE_WRITE);
+	unsigned int byte_order = LINE_CACHE_BYTE_ORDER;
+	char padding[sizeof(unsigned int)] = { 0 };
+	bool is_written;
+
+	if (!out)
+		return FALSE;
+
+	fputs(LINE_CACHE_HEADER, out);
+	fwrite(padding, sizeof(char), RECORD_ALIGN(strlen(LINE_CACHE_HEADER)) - strlen(LINE_CACHE_HEADER), out);
+	fwrite(&byte_order, sizeof(byte_order), 1, out);
+	fwrite(cache->recorded.bytes, sizeof(char), cache->recorded.log_sz, out);
+
+	is_written = ferror(out) ? FALSE : TRUE;
+	if (fclose(out) != 0)
+		is_written = FALSE;
+
+	return is_written;
+}
+
+void line_cache_destroy(LineCache** cache)
+{
+	free((*cache)->file);
+	free((*cache)->loaded);
+	free((*cache)->slots);
+	free((*cache)->recorded.bytes);
+	free(*cache);
+	*cache = NULL;
+}
@@ -0,0 +1,96 @@
+#ifndef LINE_CACHE_H
+#define LINE_CACHE_H
+
+/** @file
+*	This header declares the line cache of the incremental assembly, a sidecar file next to the source that keeps how the first pass prepared every line.
+*   A line is prepared (classified, validated and encoded) from its text alone, so the lines are keyed by their text: a line that didn't change,
+*   or that moved, is taken from the cache and only the changed lines are lexed again. The addresses, the symbols and the label operands depend on
+*   the other lines, they are computed again from the cached words every time, so the outputs are the same as without the cache.
+*   Only the lines whose preparation reported nothing are kept. A cache that is missing, of another version or damaged is ignored as a whole.
+*   The records are binary, as the lines are held in memory, so the file is written at once and its lines are used in place once it's read.
+*/
+
+#include "utils.h"
+
+/**
+* @brief This data structure is the preparation of a single line.
+*/
+typedef struct
+{
+	char* text; /* The line, as the line reader returned it. */
+	char* word; /* The first word of the line. */
+	int state; /* The firstPassStates of the line. */
+	int keyword; /* The index of the token the processing of the line starts at. */
+	size_t current; /* Where the processing of the line continues, an offset into 'text'. */
+	bool is_valid;
+	bool is_image_full;
+	int words_count;
+	unsigned int* words; /* The words the line encoded. */
+} CachedLine;
+
+/**
+* @brief A forward declaration of the line cache, declaration in the '.c' file.
+*/
+typedef struct lineCache LineCache;
+
+/**
+* @brief This function creates a new empty line cache.
+* @return A new line cache.
+*/
+LineCache* line_cache_new();
+
+/**
+* @brief This function loads the lines of the previous run, they are the ones line_cache_find searches.
+* @param cache - The cache.
+* @param path - The path of the sidecar file.
+* @return TRUE if the lines were loaded, FALSE if the file is missing or isn't a valid cache, the cache is left empty then.
+*/
+bool line_cache_load(LineCache* cache, char* path);
+
+/**
+* @brief This function searches the lines that were loaded for a line, it only reads the cache so it may be called on several threads at once.
+* @param cache - The cache.
+* @param text - The text of the line.
+* @return The preparation of the line, owned by the cache, NULL if the line isn't in the cache.
+*/
+CachedLine* line_cache_find(LineCache* cache, char* text);
+
+/**
+* @brief This function searches the lines that were loaded for a line, it starts at the line that followed another line in the previous run.
+* @param cache - The cache.
+* @param previous - The line that line_cache_find or line_cache_find_after returned for the line before this one, NULL if none.
+* @param text - The text of the line.
+* @return The preparation of the line, owned by the cache, NULL if the line isn't in the cache.
+*/
+CachedLine* line_cache_find_after(LineCache* cache, CachedLine* previous, char* text);
+
+/**
+* @brief This function records the preparation of a line of this run, the recorded lines are the ones line_cache_save writes.
+* @param cache - The cache.
+* @param line - The preparation, it's copied. A line that line_cache_find or line_cache_find_after returned is copied as it was loaded.
+*/
+void line_cache_record(LineCache* cache, CachedLine* line);
+
+/**
+* @brief This function returns the amount of lines that were recorded.
+* @param cache - The cache.
+* @return The amount of lines.
+*/
+int line_cache_get_recorded_count(LineCache* cache);
+
+/**
+* @brief This function writes the recorded lines to the sidecar file, in the order they were recorded. A line that was recorded several times
+* is written every time, the cache keeps the first one when it's loaded.
+* @param cache - The cache.
+* @param path - The path of the sidecar file.
+* @return TRUE if the file was written, FALSE otherwise.
+*/
+bool line_cache_save(LineCache* cache, char* path);
+
+/**
+* @brief This function frees a line cache.
+* @param cache - The cache to free.
+*/
+void line_cache_destroy(LineCache** cache);
+
+#endif
@@ -1,7 +1,7 @@
 #include "line_iterator.h"
 #include "utils.h"
+#include "char_scanner.h"
 #include <string.h>
-#include <ctype.h>
 
 void line_iterator_put_line(LineIterator* it, char* line)
 {
@@ -34,14 +34,13 @@ void line_iterator_unget_word(LineIterator* it, char* word)
 
 void line_iterator_consume_blanks(LineIterator* it)
 {
-    while (isspace(line_iterator_peek(it)))
-        line_iterator_advance(it);
+    it->current = char_scanner_skip_blanks(it->current);
 }
 
 void line_iterator_jump_to(LineIterator* it, char sep)
 {
-    char* loc = strchr(it->current, sep);
-    if (loc == NULL)
+    char* loc = char_scanner_find_char(it->current, sep);
+    if (*loc != sep)
         return;
     it->current = loc + 1;
 }
@@ -53,45 +52,33 @@ char line_iterator_peek(LineIterator* it)
 
 char* line_iterator_next_word(LineIterator* it, char* seps)
 {
-    int log_sz = 0, phy_sz = 4;
-    char* word = (char*)xcalloc(phy_sz, sizeof(char));
+    char* word = NULL, * end = NULL;
+    size_t length;
 
     /* Consume all white spaces */
     line_iterator_consume_blanks(it);
 
-    while (!line_iterator_is_end(it) && !line_iterator_match_any(it, seps)) {
-        if (log_sz + 1 >= phy_sz) {
-            GROW_CAPACITY(phy_sz);
-            word = GROW_ARRAY(char*, word, phy_sz, sizeof(char));
-        }
-        word[log_sz++] = line_iterator_peek(it);
-        line_iterator_advance(it);
-    }
-
+    /* Find the end of the word at once, so the word is allocated only once. */
+    end = char_scanner_find_any(it->current, seps);
+    length = end - it->current;
 
     /* No more words are available*/
-    if (log_sz == 0) {
-        free(word);
+    if (length == 0) {
         return NULL;
     }
 
-    if (log_sz + 1 < phy_sz) {
-        word = GROW_ARRAY(char*, word, log_sz + 1, sizeof(char));
-    }
+    word = (char*)xmalloc((length + 1) * sizeof(char));
+    memcpy(word, it->current, length * sizeof(char));
+    word[length] = '\0';
+    it->current = end;
 
-    word[log_sz] = '\0';
     return word;
 }
 
 bool line_iterator_match_any(LineIterator* it, char* seps)
 {
-    while (*seps) {
-        if (line_iterator_peek(it) == *seps)
-            return TRUE;
-        seps++;
-    }
-
-    return line_iterator_peek(it) == *seps;
+    /* strchr () also matches the terminator, so the end of the line is always a match. */
+    return strchr(seps, line_iterator_peek(it)) != NULL;
 }
 
 bool line_iterator_is_end(LineIterator* it)
@@ -106,7 +93,7 @@ bool line_iterator_is_start(LineIterator* it)
 
 bool line_iterator_word_includes(LineIterator* it, char* searchFor)
 {
-    return (strstr(it->current, searchFor) != NULL);
+    return (char_scanner_find_word(it->current, searchFor) != NULL);
 }
 
 char* get_last_word(LineIterator* it) {
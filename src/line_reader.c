@@ -0,0 +1,130 @@
+#include "line_reader.h"
+#include <string.h>
+
+struct lineReader
+{
+	FILE* in;
+	long number; /* The number of the last line that was read. */
+	size_t phy_sz;
+	char* buffer; /* Reused for every line, grows to fit the longest line. */
+};
+
+FILE* line_reader_open_source(char* path, debugList* dbg_list)
+{
+	FILE* in = open_file(path, MODE_READ);
+
+	if (!in) {
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_OPEN);
+		return NULL;
+	}
+
+	if (is_file_empty(in)) {
+		debug_list_register_file_node(dbg_list, path, ERROR_CODE_FILE_EMPTY);
+		fclose(in);
+		return NULL;
+	}
+
+	return in;
+}
+
+LineReader* line_reader_new(FILE* in)
+{
+	LineReader* reader = (LineReader*)xmalloc(sizeof(LineReader));
+
+	reader->in = in;
+	reader->number = 0;
+	reader->phy_sz = SOURCE_LINE_MAX_LENGTH + 1;
+	reader->buffer = (char*)xcalloc(reader->phy_sz, sizeof(char));
+
+	return reader;
+}
+
+bool line_reader_next(LineReader* reader, SourceLine* line)
+{
+	size_t length = 0;
+	char* tab;
+
+	/* Read in chunks until the '\n' (or the end of the file), doubling the buffer whenever it fills up. */
+	while (fgets(reader->buffer + length, (int)(reader->phy_sz - length), reader->in) != NULL) {
+		length += strlen(reader->buffer + length);
+
+		if (length > 0 && reader->buffer[length - 1] == '\n')
+			break;
+
+		if (length + 1 >= reader->phy_sz) {
+			GROW_CAPACITY(reader->phy_sz);
+			reader->buffer = GROW_ARRAY(char*, reader->buffer, reader->phy_sz, sizeof(char));
+		}
+	}
+
+	/* Nothing was read, we reached the end of the file. */
+	if (length == 0)
+		return FALSE;
+
+	if (reader->buffer[length - 1] == '\n')
+		reader->buffer[--length] = '\0';
+
+	/* Tabs are treated as spaces by the rest of the pipeline. */
+	for (tab = strchr(reader->buffer, TAB_CHAR); tab; tab = strchr(tab + 1, TAB_CHAR))
+		*tab = SPACE_CHAR;
+
+	line->is_too_long = (length >= SOURCE_LINE_MAX_LENGTH) ? TRUE : FALSE;
+
+	/* Mark a line of blanks for later functions in the pipeline to ignore. */
+	if (is_line_only_blanks(reader->buffer)) {
+		*reader->buffer = '\0';
+		length = 0;
+	}
+
+	line->text = reader->buffer;
+	line->length = length;
+	line->number = ++reader->number;
+
+	return TRUE;
+}
+
+void line_reader_read_all(LineReader* reader, SourceFile* file)
+{
+	SourceLine line;
+	size_t text_log_sz = 0, text_phy_sz = INIT_PHY_SZ, offset = 0;
+	int phy_sz = INIT_PHY_SZ, i;
+
+	file->text = (char*)xcalloc(text_phy_sz, sizeof(char));
+	file->lines = (SourceLine*)xcalloc(phy_sz, sizeof(SourceLine));
+	file->count = 0;
+
+	while (line_reader_next(reader, &line)) {
+		if (file->count + 1 >= phy_sz) {
+			GROW_CAPACITY(phy_sz);
+			file->lines = GROW_ARRAY(SourceLine*, file->lines, phy_sz, sizeof(SourceLine));
+		}
+
+		if (text_log_sz + line.length + 1 >= text_phy_sz) {
+			while (text_log_sz + line.length + 1 >= text_phy_sz)
+				GROW_CAPACITY(text_phy_sz);
+			file->text = GROW_ARRAY(char*, file->text, text_phy_sz, sizeof(char));
+		}
+
+		memcpy(file->text + text_log_sz, line.text, line.length + 1);
+		text_log_sz += line.length + 1;
+		file->lines[file->count++] = line;
+	}
+
+	/* The text buffer doesn't move anymore, point the lines into it. */
+	for (i = 0; i < file->count; i++) {
+		file->lines[i].text = file->text + offset;
+		offset += file->lines[i].length + 1;
+	}
+}
+
+void source_file_free(SourceFile* file)
+{
+	free(file->lines);
+	free(file->text);
+}
+
+void line_reader_destroy(LineReader** reader)
+{
+	free((*reader)->buffer);
+	free(*reader);
+}
@@ -0,0 +1,80 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+/** @file
+*	This header declares the line reader, which reads a file line by line into a single reusable buffer.
+*   The buffer grows to fit the longest line, so lines are never truncated and no memory is allocated per line.
+*/
+
+#include "utils.h"
+#include "debug.h"
+
+/**
+* @brief This data structure is a view of the line that was read last, it is valid until the next line is read.
+*/
+typedef struct
+{
+	char* text; /* The line without the '\n', tabs are replaced with spaces and a line of blanks is empty. */
+	size_t length; /* The amount of chars in 'text'. */
+	long number; /* The number of the line in the file, starting at 1. */
+	bool is_too_long; /* TRUE if the line is longer than the SOURCE_LINE_MAX_LENGTH limit of the language. */
+} SourceLine;
+
+/**
+* @brief This data structure holds every line of a file, read at once so the lines can be processed out of order, i.e on several threads.
+*/
+typedef struct
+{
+	char* text; /* The lines one after the other, each one is '\0' terminated. */
+	SourceLine* lines; /* The lines, their text points into 'text'. */
+	int count;
+} SourceFile;
+
+/**
+* @brief A forward declaration of the line reader, declaration in the '.c' file.
+*/
+typedef struct lineReader LineReader;
+
+/**
+* @brief This function opens a source for reading, a source that can't be opened or is empty is reported in the diagnostics.
+* @param path - The path of the source.
+* @param dbg_list - The debug list the failure is reported to.
+* @return The open file, NULL on failure.
+*/
+FILE* line_reader_open_source(char* path, debugList* dbg_list);
+
+/**
+* @brief This function creates a new line reader.
+* @param in - The file to read from, it must be open for reading and it's not closed by the reader.
+* @return A new line reader.
+*/
+LineReader* line_reader_new(FILE* in);
+
+/**
+* @brief This function reads the next line of the file.
+* @param reader - The reader.
+* @param line - Receives the line.
+* @return TRUE if a line was read, FALSE at the end of the file.
+*/
+bool line_reader_next(LineReader* reader, SourceLine* line);
+
+/**
+* @brief This function reads all the (remaining) lines of the file.
+* @param reader - The reader.
+* @param file - Receives the lines, it must be freed with source_file_free.
+*/
+void line_reader_read_all(LineReader* reader, SourceFile* file);
+
+/**
+* @brief This function frees the lines that were read by line_reader_read_all.
+* @param file - The lines.
+*/
+void source_file_free(SourceFile* file);
+
+/**
+* @brief This function frees a line reader, the lines it returned are no longer valid.
+* @param reader - The reader to free.
+*/
+void line_reader_destroy(LineReader** reader);
+
+#endif
@@ -0,0 +1,81 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mapped_file.h"
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define MAPPED_FILE_MODE 0666
+
+struct mappedFile
+{
+	int fd;
+	size_t size;
+	char* data;
+	bool is_mapped; /* FALSE if 'data' is a heap buffer that is written when the file is closed. */
+};
+
+MappedFile* mapped_file_create(char* path, size_t size)
+{
+	MappedFile* file = NULL;
+	void* data = MAP_FAILED;
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, MAPPED_FILE_MODE);
+
+	if (fd < 0)
+		return NULL;
+
+	/*
+	* The blocks are allocated before the file is mapped, a store to a page of a sparse file the disk has no room for raises SIGBUS.
+	* An empty mapping is invalid, and a failed allocation is left to the fallback write to report.
+	*/
+	if (size > 0 && posix_fallocate(fd, 0, (off_t)size) == 0)
+		data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	file = (MappedFile*)xmalloc(sizeof(MappedFile));
+	file->fd = fd;
+	file->size = size;
+	file->is_mapped = (data != MAP_FAILED) ? TRUE : FALSE;
+	file->data = file->is_mapped ? (char*)data : (char*)xcalloc(size + 1, sizeof(char));
+
+	return file;
+}
+
+char* mapped_file_get_data(MappedFile* file)
+{
+	return file->data;
+}
+
+bool mapped_file_close(MappedFile** file)
+{
+	MappedFile* f = *file;
+	bool is_written = TRUE;
+	size_t offset = 0;
+	ssize_t written;
+
+	if (f->is_mapped) {
+		is_written = (munmap(f->data, f->size) == 0) ? TRUE : FALSE;
+	}
+	else {
+		/* Positional writes, a short or an interrupted write continues where it stopped. */
+		while (offset < f->size) {
+			written = pwrite(f->fd, f->data + offset, f->size - offset, (off_t)offset);
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written <= 0)
+				break;
+			offset += (size_t)written;
+		}
+
+		is_written = (offset == f->size) ? TRUE : FALSE;
+		free(f->data);
+	}
+
+	if (close(f->fd) != 0)
+		is_written = FALSE;
+
+	free(f);
+	*file = NULL;
+	return is_written;
+}
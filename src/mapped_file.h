@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+/** @file
+*	This header declares an output file whose size is known up front, its blocks are allocated up front and it's written through a memory mapping.
+*   Different parts of the file may be filled from different threads, there is no shared stream position.
+*   If the blocks can't be allocated (i.e the disk is full) or the file can't be mapped, it's filled in memory and written in one go when it's closed.
+*/
+
+#include "utils.h"
+#include <stddef.h>
+
+/**
+* @brief A forward declaration of the mapped file, declaration in the '.c' file.
+*/
+typedef struct mappedFile MappedFile;
+
+/**
+* @brief This function creates (or truncates) a file of an exact size.
+* @param path - The path of the file.
+* @param size - The size of the file in bytes.
+* @return The file, NULL if it could not be created.
+*/
+MappedFile* mapped_file_create(char* path, size_t size);
+
+/**
+* @brief This function returns the contents of the file, 'size' bytes that the caller fills.
+* @param file - The file.
+* @return The contents.
+*/
+char* mapped_file_get_data(MappedFile* file);
+
+/**
+* @brief This function writes the contents to the disk (if they are not mapped) and closes the file.
+* @param file - The file to close.
+* @return TRUE if the contents were written, FALSE otherwise.
+*/
+bool mapped_file_close(MappedFile** file);
+
+#endif
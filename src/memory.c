@@ -86,69 +86,46 @@ void memory_buffer_destroy(memoryBuffer** ptr)
     free(*ptr);
 }
 
-void set_image_memory(imageMemory* mem, unsigned char byte, int flags)
+bool img_memory_reserve(imageMemory* im, int count)
 {
-    MemoryWord* curr_block = &img_memory_get_memory(mem)[img_memory_get_counter(mem)];
-
-    /* Set the ERA bits to the current block.*/
-    if (flags & FLAG_ERA)     set_era_bits(curr_block, byte);
-    /* Set the source bits of the current block.*/
-    if (flags & FLAG_SOURCE)  set_source_bits(curr_block, byte);
-    /* Set the destination bits of the current block.*/
-    if (flags & FLAG_DEST)    set_dest_bits(curr_block, byte);
-    /* Set the opcode cell 1 bits.*/
-    if (flags & FLAG_OPCODE1) set_opcode_cell_1_bits(curr_block, byte);
-    /* Set the opcode cell 2 bits.*/
-    if (flags & FLAG_OPCODE2) set_opcode_cell_2_bits(curr_block, byte);
-    /* Set the parameter 1 bit.*/
-    if (flags & FLAG_PARAM1)  set_param1_bits(curr_block, byte);
-    /* Set the parameter 2 bits of the current block.*/
-    if (flags & FLAG_PARAM2)  set_param2_bits(curr_block, byte);
+    return (count >= 0 && im->counter + count <= RAM_MEMORY_SZ) ? TRUE : FALSE;
 }
 
-/* Constans for internal usage. */
-#define OFFSET_0 0
-#define OFFSET_1 1
-
-#define MASK_ERA     0x03
-#define MASK_DEST    0x0c
-#define MASK_SOURCE  0x30
-#define MASK_OPCODE1 0xc0
-#define MASK_OPCODE2 0x03
-#define MASK_PARAM1  0x0c
-#define MASK_PARAM2  0x30
-
-void set_era_bits(MemoryWord* mem, unsigned char byte)
+/* The loops over the bytes of a word have a constant count, the compiler unrolls them for the format of the build. */
+void img_memory_push_word(imageMemory* im, unsigned int value)
 {
-    mem->mem[OFFSET_0] |= byte & MASK_ERA;
-}
+    MemoryWord* curr_block = &im->memory[im->counter++];
+    int i;
 
-void set_source_bits(MemoryWord* mem, unsigned char byte)
-{
-    mem->mem[OFFSET_0] |= byte & MASK_SOURCE;
+    value &= WORD_FORMAT_MASK;
+    for (i = 0; i < SIZEOF_MEMORY_WORD; i++)
+        curr_block->mem[i] = (unsigned char)((value >> (i * WORD_FORMAT_BYTE_BITS)) & BYTE_MASK);
 }
 
-void set_dest_bits(MemoryWord* mem, unsigned char byte)
+unsigned int img_memory_get_word(imageMemory* im, int offset)
 {
-    mem->mem[OFFSET_0] |= byte & MASK_DEST;
-}
+    MemoryWord* block = &im->memory[offset];
+    unsigned int value = 0;
+    int i;
 
-void set_opcode_cell_1_bits(MemoryWord* mem, unsigned char byte)
-{
-    mem->mem[OFFSET_0] |= byte & MASK_OPCODE1;
-}
+    for (i = SIZEOF_MEMORY_WORD - 1; i >= 0; i--)
+        value = (value << WORD_FORMAT_BYTE_BITS) | block->mem[i];
 
-void set_opcode_cell_2_bits(MemoryWord* mem, unsigned char byte)
-{
-    mem->mem[OFFSET_1] |= byte & MASK_OPCODE2;
+    return value;
 }
 
-void set_param1_bits(MemoryWord* mem, unsigned char byte)
+void img_memory_or_word(imageMemory* im, int offset, unsigned int value)
 {
-    mem->mem[OFFSET_1] |= byte & MASK_PARAM1;
+    MemoryWord* block = &im->memory[offset];
+    int i;
+
+    value &= WORD_FORMAT_MASK;
+    for (i = 0; i < SIZEOF_MEMORY_WORD; i++)
+        block->mem[i] |= (unsigned char)((value >> (i * WORD_FORMAT_BYTE_BITS)) & BYTE_MASK);
 }
 
-void set_param2_bits(MemoryWord* mem, unsigned char byte)
+void img_memory_clear(imageMemory* im)
 {
-    mem->mem[OFFSET_1] |= byte & MASK_PARAM2;
+    memset(im->memory, RAM_INIT_VAL, sizeof(MemoryWord) * im->counter);
+    im->counter = 0;
 }
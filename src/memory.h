@@ -7,19 +7,9 @@
 */
 
 #include "constants.h"
+#include "utils.h"
 
-#define SIZEOF_MEMORY_WORD 2 /* We only need 14 bits, so we will use an array of 2 chars. */
-
-/**
-* @brief Useful constants for using the 'set' functions.
-*/
-#define FLAG_ERA     0x01
-#define FLAG_SOURCE  0x02
-#define FLAG_DEST    0x04
-#define FLAG_OPCODE1 0x08
-#define FLAG_OPCODE2 0x10
-#define FLAG_PARAM1  0x20
-#define FLAG_PARAM2  0x40
+#define SIZEOF_MEMORY_WORD WORD_FORMAT_BYTES /* A word is kept in as many chars as its bits take, the lowest first. */
 
 /**
 * @brief This enumeration is used to represent each encoding type with a specific numeric constant. 
@@ -61,14 +51,6 @@ typedef struct memoryBuffer memoryBuffer;
 */
 memoryBuffer* memory_buffer_get_new();
 
-/** 
-* @brief This function sets bytes appropriately in a memoryWord according to the specified flags.
-* @param mem - The imageMemory
-* @param bytes - The byte.
-* @param flags - The flags.
-*/
-void set_image_memory(imageMemory* mem, unsigned char byte, int flags);
-
 /**
 * @breif This is an internal function that creates a new image memory object. 
 * @return A new image memory structure.
@@ -109,6 +91,45 @@ int img_memory_get_counter(imageMemory* im);
 */
 void img_memory_set_counter(imageMemory* im, int cnt);
 
+/**
+@brief Checks that an imageMemory has room for more words, so bulk writers can check the capacity once.
+@param im The imageMemory.
+@param count The amount of words that are about to be written.
+@return TRUE if the words fit, FALSE otherwise.
+*/
+bool img_memory_reserve(imageMemory* im, int count);
+
+/**
+@brief Writes a whole packed word at the counter and advances it.
+The caller must check the capacity with img_memory_reserve first.
+@param im The imageMemory.
+@param value The word, only the low WORD_FORMAT_BITS bits are kept.
+*/
+void img_memory_push_word(imageMemory* im, unsigned int value);
+
+/**
+@brief Reads a whole packed word, the reverse of img_memory_push_word.
+@param im The imageMemory.
+@param offset The offset of the word.
+@return The word.
+*/
+unsigned int img_memory_get_word(imageMemory* im, int offset);
+
+/**
+@brief ORs a whole packed word into the word at an offset, the counter is left as is.
+Writers of different words don't share any state, so they may run on different threads.
+@param im The imageMemory.
+@param offset The offset of the word.
+@param value The bits to set, only the low WORD_FORMAT_BITS bits are kept.
+*/
+void img_memory_or_word(imageMemory* im, int offset, unsigned int value);
+
+/**
+@brief Zeroes the words up to the counter and resets the counter, cheaper than image_memory_init for an image that is reused for a few words at a time.
+@param im The imageMemory.
+*/
+void img_memory_clear(imageMemory* im);
+
 /**
 @brief Returns a pointer to a specific MemoryWord within an imageMemory structure.
 @param im The imageMemory structure to access.
@@ -138,71 +159,4 @@ unsigned char* memory_word_get_memory(MemoryWord* mw);
 */
 void memory_buffer_destroy(memoryBuffer** ptr);
 
-/**
-*  The memory word structure:
-
-*  Param2 | Param 1 | Opcode | Dest Operand | Source Operand | E.R.A
-* ---------------------------------------------------------------------
-* | 2 bits | 2 bits | 4 bits |     2 bits   |      2 bits    | 2 bits |
-* ---------------------------------------------------------------------
-* We divided the Opcode to 2 parts, Op1 and Op2 to align each section on 1 byte:
-
-* Param2 | Param 1  |   Op1  |   Op2  | Dest Operand | Source Operand | E.R.A
-* -----------------------------------------------------------------------------
-* | 2 bits | 2 bits | 2 bits | 2 bits |     2 bits   |      2 bits    | 2 bits |
-* ------------------------------------------------------------------------------
-* ---------second byte------- ------------------first byte --------------------
-
-* This way its easier to set the bits using our 'set' functions.
-*/
-
-/** 
-* @brief This function is for setting the e.r.a flag to the value of byte.
-* @param mem - The image memory.
-* @param byte - The byte.
-*/
-void set_era_bits(MemoryWord* mem, unsigned char byte);
-
-/**
-* @brief This function is for setting the source flag to the value of byte.
-* @param mem - The image memory.
-* @param byte - The byte.
-*/
-void set_source_bits(MemoryWord* mem, unsigned char byte);
-
-/**
-* @brief This function is for setting the dest flag to the value of byte.
-* @param mem - The image memory.
-* @param byte - The byte.
-*/
-void set_dest_bits(MemoryWord* mem,  unsigned char byte);
-
-/**
-* @brief This function is for setting the opcode_1 flag to the value of byte.
-* @param mem - The image memory.
-* @param byte - The byte.
-*/
-void set_opcode_cell_1_bits(MemoryWord* mem, unsigned char byte);
-
-/**
-* @brief This function is for setting the opcode_2 flag to the value of byte.
-* @param mem - The image memory.
-* @param byte - The byte.
-*/
-void set_opcode_cell_2_bits(MemoryWord* mem, unsigned char byte);
-
-/**
-* @brief This function is for setting the param_1 flag to the value of byte.
-* @param mem - The image memory.
-* @param byte - The byte.
-*/
-void set_param1_bits(MemoryWord* mem, unsigned char byte);
-
-/**
-* @brief This function is for setting the param_2 flag to the value of byte.
-* @param mem - The image memory.
-* @param byte - The byte.
-*/
-void set_param2_bits(MemoryWord* mem, unsigned char byte);
-
 #endif
@@ -0,0 +1,233 @@
+#include "object_codec.h"
+
+#define COMPACT_MAGIC "A14Z"
+#define COMPACT_MAGIC_LENGTH 4
+#define COMPACT_WORD_SIZE WORD_FORMAT_BYTES
+/* A shorter repetition is cheaper to keep in a literal run than to break it. */
+#define COMPACT_MIN_REPEAT 3
+#define VARINT_MAX_LENGTH 5
+#define VARINT_BITS 7
+#define VARINT_MASK 0x7F
+#define VARINT_MORE 0x80
+#define DECIMAL_BASE 10
+
+/* The words of an object, the instruction image followed by the data image. */
+typedef struct
+{
+	imageMemory* inst;
+	imageMemory* data;
+	int inst_count;
+	int count;
+} objectWords;
+
+void object_codec_format_line(char* out, int address, unsigned int bits)
+{
+	int i;
+
+	for (i = OBJECT_ADDRESS_DIGITS - 1; i >= 0; i--, address /= DECIMAL_BASE)
+		out[i] = '0' + address % DECIMAL_BASE;
+
+	out[OBJECT_ADDRESS_DIGITS] = TAB_CHAR;
+
+	/*translated the memory from binary to slashes and dots*/
+	for (i = 0; i < WORD_FORMAT_BITS; i++)
+		out[OBJECT_ADDRESS_DIGITS + 1 + i] = (bits & (1U << (WORD_FORMAT_BITS - 1 - i))) ? OBJECT_PRINT_SLASH : OBJECT_PRINT_DOT;
+
+	out[OBJECT_LINE_LENGTH - 1] = NEW_LINE_CHAR;
+}
+
+static void object_words_init(objectWords* words, memoryBuffer* memory)
+{
+	words->inst = memory_buffer_get_inst_img(memory);
+	words->data = memory_buffer_get_data_img(memory);
+	words->inst_count = img_memory_get_counter(words->inst);
+	words->count = words->inst_count + img_memory_get_counter(words->data);
+}
+
+static unsigned int object_words_get(objectWords* words, int index)
+{
+	if (index < words->inst_count)
+		return img_memory_get_word(words->inst, index);
+
+	return img_memory_get_word(words->data, index - words->inst_count);
+}
+
+/* Returns the amount of times the word at 'index' repeats, up to 'max'. */
+static int get_repeat_length(objectWords* words, int index, int max)
+{
+	unsigned int word = object_words_get(words, index);
+	int length = 1;
+
+	while (length < max && index + length < words->count && object_words_get(words, index + length) == word)
+		length++;
+
+	return length;
+}
+
+/* Both write_* functions only count the bytes when 'out' is NULL, so the size and the encoding walk the runs the same way. */
+static size_t write_varint(unsigned char* out, unsigned long value)
+{
+	size_t length = 0;
+
+	do {
+		if (out)
+			out[length] = (unsigned char)((value & VARINT_MASK) | (value > VARINT_MASK ? VARINT_MORE : 0));
+		value >>= VARINT_BITS;
+		length++;
+	} while (value > 0);
+
+	return length;
+}
+
+static size_t write_word(unsigned char* out, unsigned int word)
+{
+	int i;
+
+	/* The lowest byte first, as many bytes as a word takes. */
+	for (i = 0; out && i < COMPACT_WORD_SIZE; i++)
+		out[i] = (unsigned char)((word >> (i * WORD_FORMAT_BYTE_BITS)) & BYTE_MASK);
+
+	return COMPACT_WORD_SIZE;
+}
+
+static size_t encode_runs(objectWords* words, unsigned char* out)
+{
+	size_t size = COMPACT_MAGIC_LENGTH;
+	int i = 0, start, length;
+
+	if (out)
+		memcpy(out, COMPACT_MAGIC, COMPACT_MAGIC_LENGTH);
+	size += write_varint(out ? out + size : NULL, (unsigned long)words->inst_count);
+	size += write_varint(out ? out + size : NULL, (unsigned long)(words->count - words->inst_count));
+
+	while (i < words->count) {
+		length = get_repeat_length(words, i, words->count);
+		if (length >= COMPACT_MIN_REPEAT) {
+			size += write_varint(out ? out + size : NULL, ((unsigned long)length << 1) | 1);
+			size += write_word(out ? out + size : NULL, object_words_get(words, i));
+			i += length;
+			continue;
+		}
+
+		/* A literal run ends where a repetition that is worth its own run starts. */
+		for (start = i; i < words->count && get_repeat_length(words, i, COMPACT_MIN_REPEAT) < COMPACT_MIN_REPEAT; i++)
+			;
+
+		size += write_varint(out ? out + size : NULL, (unsigned long)(i - start) << 1);
+		for (; start < i; start++)
+			size += write_word(out ? out + size : NULL, object_words_get(words, start));
+	}
+
+	return size;
+}
+
+size_t object_codec_get_compact_size(memoryBuffer* memory)
+{
+	objectWords words;
+
+	object_words_init(&words, memory);
+	return encode_runs(&words, NULL);
+}
+
+void object_codec_encode_compact(memoryBuffer* memory, char* out)
+{
+	objectWords words;
+
+	object_words_init(&words, memory);
+	encode_runs(&words, (unsigned char*)out);
+}
+
+/* Reads a varint at '*offset' and advances it, FALSE if the data ends first or the value is too long. */
+static bool read_varint(unsigned char* data, size_t size, size_t* offset, unsigned long* value)
+{
+	int i;
+
+	*value = 0;
+	for (i = 0; i < VARINT_MAX_LENGTH && *offset < size; i++) {
+		*value |= (unsigned long)(data[*offset] & VARINT_MASK) << (i * VARINT_BITS);
+		if (!(data[(*offset)++] & VARINT_MORE))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static bool read_word(unsigned char* data, size_t size, size_t* offset, unsigned int* word)
+{
+	int i;
+
+	if (*offset + COMPACT_WORD_SIZE > size)
+		return FALSE;
+
+	for (*word = 0, i = COMPACT_WORD_SIZE - 1; i >= 0; i--)
+		*word = (*word << WORD_FORMAT_BYTE_BITS) | data[*offset + i];
+	*offset += COMPACT_WORD_SIZE;
+
+	return (*word & ~WORD_FORMAT_MASK) == 0;
+}
+
+/* Decodes the runs into 'words', they must cover exactly 'count' words and the whole data. */
+static bool decode_runs(unsigned char* data, size_t size, size_t offset, unsigned int* words, unsigned long count)
+{
+	unsigned long filled = 0, header, length, i;
+	unsigned int word;
+
+	while (filled < count) {
+		if (!read_varint(data, size, &offset, &header))
+			return FALSE;
+
+		length = header >> 1;
+		if (length == 0 || length > count - filled)
+			return FALSE;
+
+		if (header & 1) {
+			if (!read_word(data, size, &offset, &word))
+				return FALSE;
+			for (i = 0; i < length; i++)
+				words[filled++] = word;
+		}
+		else {
+			for (i = 0; i < length; i++)
+				if (!read_word(data, size, &offset, &words[filled++]))
+					return FALSE;
+		}
+	}
+
+	return offset == size;
+}
+
+bool object_codec_decode_compact(char* data, size_t size, char** text, size_t* text_size)
+{
+	unsigned char* bytes = (unsigned char*)data;
+	unsigned long inst_count, data_count, i;
+	size_t offset = COMPACT_MAGIC_LENGTH, header_length;
+	char header[OBJECT_HEADER_MAX_LENGTH];
+	unsigned int* words;
+
+	if (size < COMPACT_MAGIC_LENGTH || memcmp(data, COMPACT_MAGIC, COMPACT_MAGIC_LENGTH) != 0)
+		return FALSE;
+
+	/* An image never holds more than RAM_MEMORY_SZ words, a larger counter is a corrupt file. */
+	if (!read_varint(bytes, size, &offset, &inst_count) || !read_varint(bytes, size, &offset, &data_count) ||
+	    inst_count > RAM_MEMORY_SZ || data_count > RAM_MEMORY_SZ)
+		return FALSE;
+
+	words = (unsigned int*)xcalloc(inst_count + data_count + 1, sizeof(unsigned int));
+	if (!decode_runs(bytes, size, offset, words, inst_count + data_count)) {
+		free(words);
+		return FALSE;
+	}
+
+	sprintf(header, OBJECT_HEADER_FORMAT, (int)inst_count, (int)data_count);
+	header_length = strlen(header);
+
+	*text_size = header_length + (size_t)(inst_count + data_count) * OBJECT_LINE_LENGTH;
+	*text = (char*)xmalloc(*text_size + 1);
+	memcpy(*text, header, header_length);
+	for (i = 0; i < inst_count + data_count; i++)
+		object_codec_format_line(*text + header_length + i * OBJECT_LINE_LENGTH, DECIMAL_ADDRESS_BASE + (int)i, words[i]);
+	(*text)[*text_size] = BACKSLASH_ZERO;
+
+	free(words);
+	return TRUE;
+}
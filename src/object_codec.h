@@ -0,0 +1,56 @@
+#ifndef OBJECT_CODEC_H
+#define OBJECT_CODEC_H
+
+/** @file
+*	This header declares the object encodings. The text object lists every word on its own line after its address,
+*   the compact object is a binary form of the same image for archiving: the addresses are left out, since every word follows the one before it,
+*   and the words are split into runs, a run of a repeated word (i.e a zero initialised table) is stored once with its length.
+*
+*   The compact object is the magic "A14Z", the instruction and the data counters as varints, then runs until all the words are covered.
+*   A run is a varint of its length shifted left once with the low bit set for a repeated word, followed by the single word of a repeated run
+*   or by all the words of a literal run. A word is WORD_FORMAT_BYTES bytes, low byte first. The varints are 7 bits per byte, low bits first, the high bit marks more bytes.
+*/
+
+#include "utils.h"
+#include "memory.h"
+#include "constants.h"
+#include <stddef.h>
+
+/**
+* @brief The encodings of the object file.
+*/
+typedef enum { OBJECT_FORMAT_TEXT, OBJECT_FORMAT_COMPACT } ObjectFormat;
+
+/**
+* @brief This function formats a single line of the text object, the address as 4 digits, a tab, the WORD_FORMAT_BITS bits as slashes and dots and a '\n'.
+* @param out - Where the line is formatted, OBJECT_LINE_LENGTH chars, it's not terminated.
+* @param address - The address of the word, with the DECIMAL_ADDRESS_BASE.
+* @param bits - The word.
+*/
+void object_codec_format_line(char* out, int address, unsigned int bits);
+
+/**
+* @brief This function returns the size of the compact object of an image.
+* @param memory - The memory buffer, the instruction image followed by the data image.
+* @return The size in bytes.
+*/
+size_t object_codec_get_compact_size(memoryBuffer* memory);
+
+/**
+* @brief This function encodes the compact object of an image.
+* @param memory - The memory buffer, the instruction image followed by the data image.
+* @param out - Where the object is encoded, object_codec_get_compact_size bytes.
+*/
+void object_codec_encode_compact(memoryBuffer* memory, char* out);
+
+/**
+* @brief This function decodes a compact object into the text object of the same image, the same bytes the assembler writes to a '.object' file.
+* @param data - The compact object.
+* @param size - The size of the compact object.
+* @param text - Receives the text object, allocated with an extra terminating byte, it belongs to the caller.
+* @param text_size - Receives the size of the text object.
+* @return TRUE if the object was decoded, FALSE if it isn't a valid compact object.
+*/
+bool object_codec_decode_compact(char* data, size_t size, char** text, size_t* text_size);
+
+#endif
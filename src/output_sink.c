@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "output_sink.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+
+typedef enum { SINK_FILES, SINK_NULL, SINK_MEMORY, SINK_FD } OutputSinkKind;
+
+struct outputSink
+{
+	OutputSinkKind kind;
+	int fd;
+	bool is_framed;
+	pthread_mutex_t lock; /* Guards the outputs of a memory sink, and keeps the frames of an fd sink whole. */
+	FileBuffer* files; /* A dynamic array of the outputs of a memory sink. */
+	int log_sz;
+	int phy_sz;
+};
+
+/* The files and the null sinks have no state, a single instance of each is shared. */
+static OutputSink files_sink = { SINK_FILES };
+static OutputSink null_sink = { SINK_NULL };
+
+OutputSink* output_sink_get_files()
+{
+	return &files_sink;
+}
+
+OutputSink* output_sink_get_null()
+{
+	return &null_sink;
+}
+
+static OutputSink* output_sink_new(OutputSinkKind kind)
+{
+	OutputSink* sink = (OutputSink*)xcalloc(1, sizeof(OutputSink));
+
+	sink->kind = kind;
+	sink->fd = -1;
+	pthread_mutex_init(&sink->lock, NULL);
+
+	return sink;
+}
+
+OutputSink* output_sink_new_memory()
+{
+	OutputSink* sink = output_sink_new(SINK_MEMORY);
+
+	sink->phy_sz = INIT_PHY_SZ;
+	sink->files = (FileBuffer*)xcalloc(INIT_PHY_SZ, sizeof(FileBuffer));
+
+	return sink;
+}
+
+OutputSink* output_sink_new_fd(int fd, bool is_framed)
+{
+	OutputSink* sink = output_sink_new(SINK_FD);
+
+	sink->fd = fd;
+	sink->is_framed = is_framed;
+
+	return sink;
+}
+
+bool output_sink_is_files(OutputSink* sink)
+{
+	return sink->kind == SINK_FILES;
+}
+
+static bool write_file(char* path, char* data, size_t size)
+{
+	FILE* out = open_file(path, MODE_WRITE);
+	bool is_written = (out && fwrite(data, sizeof(char), size, out) == size) ? TRUE : FALSE;
+
+	if (out && fclose(out) != 0)
+		is_written = FALSE;
+
+	return is_written;
+}
+
+/* Writes all the bytes, a pipe may take them in parts. */
+static bool write_fd(int fd, char* data, size_t size)
+{
+	ssize_t ret;
+
+	while (size > 0) {
+		ret = write(fd, data, size);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return FALSE;
+
+		data += ret;
+		size -= (size_t)ret;
+	}
+
+	return TRUE;
+}
+
+static void keep_file(OutputSink* sink, char* path, char* data, size_t size)
+{
+	FileBuffer* file;
+
+	if (sink->log_sz + 1 >= sink->phy_sz) {
+		GROW_CAPACITY(sink->phy_sz);
+		sink->files = GROW_ARRAY(FileBuffer*, sink->files, sink->phy_sz, sizeof(FileBuffer));
+	}
+
+	file = &sink->files[sink->log_sz++];
+	file->path = get_copy_string(path);
+	file->data = (char*)xmalloc(size + 1);
+	memcpy(file->data, data, size);
+	file->size = size;
+	file->is_done = TRUE;
+}
+
+bool output_sink_write(OutputSink* sink, char* path, char* data, size_t size)
+{
+	char* header;
+	bool is_written = TRUE;
+
+	switch (sink->kind) {
+	case SINK_FILES:
+		return write_file(path, data, size);
+	case SINK_NULL:
+		return TRUE;
+	case SINK_MEMORY:
+		pthread_mutex_lock(&sink->lock);
+		keep_file(sink, path, data, size);
+		pthread_mutex_unlock(&sink->lock);
+		return TRUE;
+	case SINK_FD:
+		/* The size fits in the digits of an unsigned long, the header is "path size\n". */
+		header = (char*)xcalloc(strlen(path) + 3 * sizeof(unsigned long) + 3, sizeof(char));
+		sprintf(header, "%s %lu\n", path, (unsigned long)size);
+
+		pthread_mutex_lock(&sink->lock);
+		if (sink->is_framed)
+			is_written = write_fd(sink->fd, header, strlen(header));
+		is_written = is_written && write_fd(sink->fd, data, size);
+		pthread_mutex_unlock(&sink->lock);
+
+		free(header);
+		return is_written;
+	}
+
+	return FALSE;
+}
+
+int output_sink_get_count(OutputSink* sink)
+{
+	return sink->log_sz;
+}
+
+void output_sink_get_file(OutputSink* sink, int index, FileBuffer* file)
+{
+	*file = sink->files[index];
+}
+
+void output_sink_destroy(OutputSink** sink)
+{
+	int i;
+
+	if (*sink == &files_sink || *sink == &null_sink)
+		return;
+
+	for (i = 0; i < (*sink)->log_sz; i++) {
+		free((*sink)->files[i].path);
+		free((*sink)->files[i].data);
+	}
+
+	pthread_mutex_destroy(&(*sink)->lock);
+	free((*sink)->files);
+	free(*sink);
+	*sink = NULL;
+}
@@ -0,0 +1,94 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+/** @file
+*	This header declares the output sinks, where the output files of an assembly end up once they are complete.
+*   The files sink writes every output to the disk at its path, the memory sink keeps them for the caller, the fd sink streams them
+*   to a file descriptor (i.e a pipe) and the null sink discards them, i.e to measure the assembly without the cost of the filesystem.
+*   A sink may be shared by several assemblies that run at once, it's locked.
+*/
+
+#include "utils.h"
+#include <stddef.h>
+
+/**
+* @brief A forward declaration of the output sink, declaration in the '.c' file.
+*/
+typedef struct outputSink OutputSink;
+
+/**
+* @brief This data structure holds the contents of a single file, i.e to read or write many files of several stores in one batch.
+*/
+typedef struct
+{
+	char* path;
+	char* data;
+	size_t size;
+	bool is_done; /* TRUE once the file was read or written. */
+} FileBuffer;
+
+/**
+* @brief This function returns the files sink, it writes every output to the disk at its path. It's shared and must not be destroyed.
+* @return The files sink.
+*/
+OutputSink* output_sink_get_files();
+
+/**
+* @brief This function returns the null sink, it discards every output. It's shared and must not be destroyed.
+* @return The null sink.
+*/
+OutputSink* output_sink_get_null();
+
+/**
+* @brief This function creates a sink that keeps a copy of every output in memory.
+* @return A new memory sink.
+*/
+OutputSink* output_sink_new_memory();
+
+/**
+* @brief This function creates a sink that writes every output to a file descriptor, i.e a pipe.
+* @param fd - The file descriptor, it's not closed by the sink.
+* @param is_framed - TRUE to write every output after a header line of its path and its size in bytes, i.e "x.entry 24", FALSE to write only the contents.
+* @return A new fd sink.
+*/
+OutputSink* output_sink_new_fd(int fd, bool is_framed);
+
+/**
+* @brief This function returns whether a sink is the files sink, the outputs of a store that writes to the disk may be written as they are made.
+* @param sink - The sink.
+* @return TRUE for the files sink, FALSE otherwise.
+*/
+bool output_sink_is_files(OutputSink* sink);
+
+/**
+* @brief This function hands a complete output to a sink.
+* @param sink - The sink.
+* @param path - The path of the output.
+* @param data - The contents, the sink copies what it keeps.
+* @param size - The size of the contents.
+* @return TRUE if the output was written, FALSE otherwise.
+*/
+bool output_sink_write(OutputSink* sink, char* path, char* data, size_t size);
+
+/**
+* @brief This function returns the amount of outputs a memory sink holds.
+* @param sink - The sink.
+* @return The amount of outputs, 0 for the other sinks.
+*/
+int output_sink_get_count(OutputSink* sink);
+
+/**
+* @brief This function returns an output a memory sink holds, in the order they were written.
+* @param sink - The sink.
+* @param index - The index of the output, below output_sink_get_count.
+* @param file - Receives the output, it points into the sink and is valid until the sink is destroyed.
+*/
+void output_sink_get_file(OutputSink* sink, int index, FileBuffer* file);
+
+/**
+* @brief This function frees a sink that was created by output_sink_new_memory or output_sink_new_fd, the shared sinks are left as is.
+* @param sink - The sink to free.
+*/
+void output_sink_destroy(OutputSink** sink);
+
+#endif
@@ -0,0 +1,74 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "parallel.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+typedef struct
+{
+	ParallelTask task;
+	void* item;
+} parallelJob;
+
+static void* parallel_job_main(void* arg)
+{
+	parallelJob* job = (parallelJob*)arg;
+
+	job->task(job->item);
+	return NULL;
+}
+
+int parallel_get_cpu_count()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (count > 0) ? (int)count : 1;
+}
+
+double parallel_get_time()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void parallel_run_tasks(void* items, int count, size_t item_size, ParallelTask task)
+{
+	pthread_t* threads = NULL;
+	parallelJob* jobs = NULL;
+	bool* is_started = NULL;
+	int i;
+
+	if (count <= 0)
+		return;
+
+	if (count == 1) {
+		task(items);
+		return;
+	}
+
+	threads = (pthread_t*)xcalloc(count, sizeof(pthread_t));
+	jobs = (parallelJob*)xcalloc(count, sizeof(parallelJob));
+	is_started = (bool*)xcalloc(count, sizeof(bool));
+
+	for (i = 1; i < count; i++) {
+		jobs[i].task = task;
+		jobs[i].item = (char*)items + i * item_size;
+		is_started[i] = (pthread_create(&threads[i], NULL, parallel_job_main, &jobs[i]) == 0) ? TRUE : FALSE;
+	}
+
+	task(items);
+
+	for (i = 1; i < count; i++) {
+		if (is_started[i])
+			pthread_join(threads[i], NULL);
+		else
+			task(jobs[i].item);
+	}
+
+	free(is_started);
+	free(jobs);
+	free(threads);
+}
@@ -0,0 +1,38 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/** @file
+*	This header declares a minimal fork/join helper, the passes use it to process independent parts of a file on several threads.
+*   A task must not touch state that another task writes, the results are merged by the caller after the join.
+*/
+
+#include "utils.h"
+
+/**
+* @brief A task that is run on a single item.
+*/
+typedef void (*ParallelTask)(void* item);
+
+/**
+* @brief This function returns the amount of online cpus.
+* @return The amount of cpus, at least 1.
+*/
+int parallel_get_cpu_count();
+
+/**
+* @brief This function returns the time of a monotonic clock, for measuring how long the work of a thread takes.
+* @return The time in seconds, from an arbitrary point.
+*/
+double parallel_get_time();
+
+/**
+* @brief This function runs a task on every item of an array, each item on its own thread, and waits for all of them.
+* The first item is run on the calling thread, if a thread can't be created its item is run on the calling thread as well.
+* @param items - The array of items.
+* @param count - The amount of items.
+* @param item_size - The size of a single item.
+* @param task - The task.
+*/
+void parallel_run_tasks(void* items, int count, size_t item_size, ParallelTask task);
+
+#endif
@@ -1,42 +1,206 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "pre_assembler.h"
+#include "parallel.h"
+#include "include_cache.h"
+#include "syntactical_analysis.h"
 #include <string.h>
 #include <ctype.h>
 
+/* A chunk holds at least this many lines, smaller files are expanded on the calling thread. */
+#define PRE_ASSEMBLER_MIN_CHUNK_LINES 512
+/* The deepest chain of macros that expand other macros, a macro without any is 1 deep. */
+#define MACRO_MAX_NESTING_DEPTH 64
+
+typedef enum { SPAN_TEXT, SPAN_MACRO, SPAN_PARAM } MacroSpanKind;
+
+/* A part of a macro body, either literal text, another macro that is expanded in its place or a slot that is replaced by an argument.
+*  The body is compiled into spans when it's defined, so an expansion only copies the literal text and the arguments. */
+typedef struct macro_span
+{
+    MacroSpanKind kind;
+    char* text; /* The literal text of a SPAN_TEXT, its lines are each followed by a '\n'. */
+    size_t log_sz;
+    size_t phy_sz;
+    MacroListNode* macro; /* The macro of a SPAN_MACRO, owned by the list. */
+    int param; /* The index of the parameter of a SPAN_PARAM. */
+    struct macro_span* arguments; /* The arguments of a SPAN_MACRO, a template of text and parameter slots. NULL if it has none. */
+    int arguments_log_sz;
+    int arguments_phy_sz;
+    int arguments_count; /* How many arguments the template splits to. */
+} macroSpan;
+
+/* An argument of an invocation, a part of a line. */
+typedef struct
+{
+    char* text;
+    size_t length;
+} macroArgument;
+
+typedef enum { MACRO_UNCHECKED, MACRO_CHECKING, MACRO_CHECKED } MacroCheckState;
+
 struct macro_list_node
 {
     int log_sz;
     int phy_sz;
     char* macro_name;
-    char** macro_expension; /* A dynamic array of strings. */
+    macroSpan* spans; /* A dynamic array of the parts of the body. */
+    char** params; /* The names of the parameters, in order. */
+    int params_count;
+    MacroCheckState check_state;
+    int depth; /* The nesting depth of the body, valid once it's checked. */
+    errorCodes err_code; /* Whether the body can be expanded, valid once it's checked. A definition with invalid parameters sets it before. */
     struct macro_list_node* next;
 };
 
+/* A file that the source includes, its macros are visible to the whole source and its lines are expanded in place of every '.include' of it. */
+typedef struct
+{
+    char* name; /* The path as it's written in the source. */
+    IncludedFile* file; /* The entry of the include cache of a file on the disk, NULL if the file couldn't be read or isn't on the disk. */
+    struct included_source* source; /* A file of a sealed store, read from the store and owned by the list. NULL if there is none. */
+    bool is_available; /* FALSE if a sealed store doesn't have the file. */
+} macroInclude;
+
 struct macro_list
 {
     MacroListNode* head;
     MacroListNode* tail;
+    macroInclude* includes; /* A dynamic array of the files the source includes, in the order they are first included. */
+    int includes_count;
+    int includes_phy_sz;
+    bool can_include; /* FALSE for the macros of an included file, it can't include other files. */
 };
 
-void macro_list_fill_list_from_file(FILE* in, MacroList* in_list)
+/* What the include cache keeps for an included file, it's shared by every source that includes it so it's only read. */
+typedef struct included_source
+{
+    MacroList* list; /* Its macros, already checked. */
+    char* text; /* Its lines outside of the macro definitions, expanded. */
+    size_t size;
+    errorCodes err_code; /* Why it can't be included, ERROR_CODE_OK if it can. */
+} includedSource;
+
+/* What the expansion does with a line, resolved in the order of the lines since it depends on the macro definitions before it. */
+typedef enum { EMIT_NONE, EMIT_LINE, EMIT_MACRO, EMIT_INCLUDE } EmitAction;
+
+typedef struct
+{
+    SourceLine* source;
+    ReadState state;
+    MacroListNode* macro; /* The macro named by the line, NULL if there is no such macro. */
+    char* name;
+    macroArgument* arguments; /* The arguments of an invocation, they point into the line. */
+    int arguments_count;
+    bool is_include; /* TRUE for an '.include' line. */
+    char* include_name; /* The path of an '.include' line, NULL if it isn't a single quoted path. */
+    includedSource* include; /* The file of an EMIT_INCLUDE. */
+    EmitAction action;
+} preAssemblerLine;
+
+typedef struct
+{
+    preAssemblerLine* lines; /* A range of the lines of the file. */
+    int count;
+    MacroList* list;
+    size_t log_sz;
+    size_t phy_sz;
+    char* text; /* The expanded lines of the chunk. */
+} preAssemblerChunk;
+
+static void macro_list_add_include(MacroList* list, FileStore* store, char* includer, char* name);
+
+/* Returns whether the iterator is at an '.include' directive, and moves it after the directive if it is. */
+static bool is_include_directive(LineIterator* it)
+{
+    size_t i, length = strlen(DOT_INCLUDE_STRING);
+    char next;
+
+    if (strncmp(it->current, DOT_INCLUDE_STRING, length) != 0)
+        return FALSE;
+
+    next = it->current[length];
+    if (next != '\0' && next != INCLUDE_QUOTE_CHAR && !isspace((unsigned char)next))
+        return FALSE;
+
+    for (i = 0; i < length; i++)
+        line_iterator_advance(it);
+    return TRUE;
+}
+
+/* Reads the quoted path of an '.include' directive, the iterator is after the directive. Returns NULL if the rest of the line isn't a single quoted path. */
+static char* get_include_name(LineIterator* it)
+{
+    char* end, * name;
+
+    line_iterator_consume_blanks(it);
+    if (line_iterator_peek(it) != INCLUDE_QUOTE_CHAR)
+        return NULL;
+
+    line_iterator_advance(it);
+    end = strchr(it->current, INCLUDE_QUOTE_CHAR);
+    if (!end || end == it->current)
+        return NULL;
+
+    name = (char*)xcalloc(end - it->current + 1, sizeof(char));
+    memcpy(name, it->current, end - it->current);
+
+    it->current = end + 1;
+    line_iterator_consume_blanks(it);
+    if (!line_iterator_is_end(it)) {
+        free(name);
+        return NULL;
+    }
+
+    return name;
+}
+
+/* Returns the path of an included file, relative to the directory of the file that includes it unless it's absolute. */
+static char* get_include_path(char* includer, char* name)
 {
-    char* line, * name;
+    char* separator = strrchr(includer, PATH_SEPARATOR_CHAR), * path;
+    size_t directory_length = (separator && name[0] != PATH_SEPARATOR_CHAR) ? (size_t)(separator - includer + 1) : 0;
+
+    path = (char*)xcalloc(directory_length + strlen(name) + 1, sizeof(char));
+    memcpy(path, includer, directory_length);
+    strcpy(path + directory_length, name);
+
+    return path;
+}
+
+void macro_list_fill_list_from_file(FILE* in, char* path, FileStore* store, MacroList* in_list)
+{
+    char* line, * name, * include_name;
+    LineReader* reader = line_reader_new(in);
+    SourceLine source;
     LineIterator it;
     MacroListNode* node;
     ReadState current_state = READ_UNKNOWN;
     bool did_started_reading = FALSE;
 
-    while ((line = get_line(in)) != NULL) {
+    in_list->can_include = (path != NULL && store != NULL);
+
+    while (line_reader_next(reader, &source)) {
         name = NULL;
+        line = source.text;
         line_iterator_put_line(&it, line);
 
         if (line_iterator_is_end(&it)) {
-            free(line);
             continue;
         }
 
         /* If blanks are encountered, consume them. */
         line_iterator_consume_blanks(&it);
 
+        /* An included file is read here, once, so its macros are visible to the whole file the same as the macros of the file. */
+        if (!did_started_reading && is_include_directive(&it)) {
+            if (in_list->can_include && (include_name = get_include_name(&it)) != NULL) {
+                macro_list_add_include(in_list, store, path, include_name);
+                free(include_name);
+            }
+            continue;
+        }
+
         /* Get the current state. */
         current_state = get_current_reading_state(&it);
 
@@ -45,7 +209,10 @@ void macro_list_fill_list_from_file(FILE* in, MacroList* in_list)
             name = get_macro_name(&it);
 
             if (current_state == READ_START_MACRO && !did_started_reading) {
-                macro_list_insert_node(in_list, macro_list_new_node(name));
+                /* The parameters follow the name, the body is compiled against them line by line. */
+                node = macro_list_new_node(name);
+                macro_list_node_set_params(node, it.current);
+                macro_list_insert_node(in_list, node);
                 did_started_reading = TRUE;
             }
             else if (current_state == READ_END_MACRO) {
@@ -55,7 +222,7 @@ void macro_list_fill_list_from_file(FILE* in, MacroList* in_list)
                 /* A macro declaration inside of the macro, we need to insert all of it's source line to those of the current macro. */
                 node = macro_list_get_node(in_list, name);
                 if (node) {
-                    macro_list_node_insert_macro(in_list->tail, node);
+                    macro_list_node_insert_macro(in_list->tail, node, it.current);
                 }
                 else {
                     macro_list_node_insert_source(in_list->tail, line);
@@ -64,31 +231,94 @@ void macro_list_fill_list_from_file(FILE* in, MacroList* in_list)
         }
 
         free(name);
-        free(line);
     }
+
+    line_reader_destroy(&reader);
+}
+
+char** pre_assembler_list_includes(FILE* in, char* path, int* count)
+{
+    LineReader* reader = line_reader_new(in);
+    SourceLine source;
+    LineIterator it;
+    ReadState current_state;
+    char** paths = NULL, * name, * include_path;
+    int phy_sz = 0, i;
+    bool did_started_reading = FALSE;
+
+    *count = 0;
+    while (line_reader_next(reader, &source)) {
+        line_iterator_put_line(&it, source.text);
+        if (line_iterator_is_end(&it))
+            continue;
+        line_iterator_consume_blanks(&it);
+
+        /* The same lines macro_list_fill_list_from_file includes. */
+        if (!did_started_reading && is_include_directive(&it)) {
+            if ((name = get_include_name(&it)) != NULL) {
+                include_path = get_include_path(path, name);
+                for (i = 0; i < *count && strcmp(paths[i], include_path) != 0; i++);
+
+                if (i < *count) {
+                    free(include_path);
+                }
+                else {
+                    if (*count + 1 >= phy_sz) {
+                        phy_sz = phy_sz ? phy_sz * 2 : INIT_PHY_SZ;
+                        paths = GROW_ARRAY(char**, paths, phy_sz, sizeof(char*));
+                    }
+                    paths[(*count)++] = include_path;
+                }
+                free(name);
+            }
+            continue;
+        }
+
+        current_state = get_current_reading_state(&it);
+        if (current_state == READ_START_MACRO)
+            did_started_reading = TRUE;
+        else if (current_state == READ_END_MACRO)
+            did_started_reading = FALSE;
+    }
+
+    line_reader_destroy(&reader);
+    return paths;
 }
 
-void start_pre_assembler(char* path)
+bool start_pre_assembler(char* path, int jobs, FileStore* store, debugList* dbg_list)
 {
-    FILE* in = open_file(path, MODE_READ), * out = NULL;
-    MacroList* list = macro_list_new_list();
+    FILE* in = file_store_open_read(store, path, dbg_list), * out = NULL;
+    MacroList* list = NULL;
     char* out_name = NULL;
+    bool is_expanded;
+
+    if (!in)
+        return FALSE;
 
-    macro_list_fill_list_from_file(in, list);
+    out_name = get_outfile_name(path, PRE_ASSEMBLER_FILE_EXTENSTION);
+    out = file_store_open_write(store, out_name, dbg_list);
+    if (!out) {
+        free(out_name);
+        fclose(in);
+        return FALSE;
+    }
+
+    list = macro_list_new_list();
+    debug_list_set_file(dbg_list, path);
+    macro_list_fill_list_from_file(in, path, store, list);
 
     /* Moves the file pointer back to the starting of the file. */
     rewind(in);
 
-    out_name = get_outfile_name(path, PRE_ASSEMBLER_FILE_EXTENSTION);
-    out = open_file(out_name, MODE_WRITE);
-
-    create_pre_assembler_file(in, out, list);
+    is_expanded = create_pre_assembler_file(in, out, list, jobs, dbg_list);
 
     /* Cleaning up. */
     macro_list_free(&list);
     free(out_name);
     fclose(out);
     fclose(in);
+
+    return is_expanded;
 }
 
 ReadState get_current_reading_state(LineIterator* it)
@@ -151,6 +381,10 @@ MacroList* macro_list_new_list()
 {
     MacroList* new_list = (MacroList*)xmalloc(sizeof(MacroList));
     new_list->head = new_list->tail = NULL;
+    new_list->includes_count = 0;
+    new_list->includes_phy_sz = INIT_PHY_SZ;
+    new_list->includes = (macroInclude*)xcalloc(INIT_PHY_SZ, sizeof(macroInclude));
+    new_list->can_include = FALSE;
     return new_list;
 }
 
@@ -169,26 +403,169 @@ MacroListNode* macro_list_new_node(char* name)
     new_node->log_sz = INIT_LOG_SZ;
     new_node->phy_sz = INIT_PHY_SZ;
 
-    new_node->macro_expension = (char**)xcalloc(INIT_PHY_SZ, sizeof(char*));
+    new_node->spans = (macroSpan*)xcalloc(INIT_PHY_SZ, sizeof(macroSpan));
+    new_node->params = NULL;
+    new_node->params_count = 0;
+    new_node->check_state = MACRO_UNCHECKED;
+    new_node->depth = 0;
+    new_node->err_code = ERROR_CODE_OK;
     new_node->next = NULL;
 
     return new_node;
 }
 
-void expand_macro_to_file(FILE* out, MacroList* list, char* name)
+/* Appends text to a growing buffer, with room for one more char after it. */
+static char* append_text(char* buffer, size_t* log_sz, size_t* phy_sz, char* text, size_t length)
 {
+    if (*log_sz + length + 1 >= *phy_sz) {
+        while (*log_sz + length + 1 >= *phy_sz)
+            GROW_CAPACITY(*phy_sz);
+        buffer = GROW_ARRAY(char*, buffer, *phy_sz, sizeof(char));
+    }
+
+    memcpy(buffer + *log_sz, text, length);
+    *log_sz += length;
+
+    return buffer;
+}
+
+/* Appends a string and a '\n' to the text of a chunk. */
+static void chunk_append_line(preAssemblerChunk* chunk, char* line)
+{
+    chunk->text = append_text(chunk->text, &chunk->log_sz, &chunk->phy_sz, line, strlen(line));
+    chunk->text[chunk->log_sz++] = NEW_LINE_CHAR;
+}
+
+/* Returns whether a char is a part of a word, a parameter is replaced only where a whole word is its name. */
+static bool is_word_char(char ch)
+{
+    return isalnum((unsigned char)ch) || ch == UNDERSCORE_CHAR;
+}
+
+/* Trims the blanks around a part of a line. */
+static void trim_blanks(char** text, size_t* length)
+{
+    while (*length > 0 && isspace((unsigned char)**text)) {
+        (*text)++;
+        (*length)--;
+    }
+    while (*length > 0 && isspace((unsigned char)(*text)[*length - 1]))
+        (*length)--;
+}
+
+/* Splits the arguments of an invocation at the commas outside of parentheses and quotes, so an operand such as 'L1(#-1,r6)' is a single argument.
+*  The arguments are trimmed and point into the text. Returns their amount, a blank text has none. */
+static int split_arguments(char* text, size_t length, macroArgument** arguments)
+{
+    int count = 0, phy_sz = INIT_PHY_SZ, depth = 0;
+    bool is_quoted = FALSE;
+    size_t i, start = 0;
+
+    *arguments = NULL;
+    trim_blanks(&text, &length);
+    if (length == 0)
+        return 0;
+
+    *arguments = (macroArgument*)xcalloc(phy_sz, sizeof(macroArgument));
+
+    for (i = 0; i <= length; i++) {
+        if (i == length || (text[i] == MACRO_ARGUMENT_SEPARATOR_CHAR && depth == 0 && !is_quoted)) {
+            if (count + 1 >= phy_sz) {
+                GROW_CAPACITY(phy_sz);
+                *arguments = GROW_ARRAY(macroArgument*, *arguments, phy_sz, sizeof(macroArgument));
+            }
+            (*arguments)[count].text = text + start;
+            (*arguments)[count].length = i - start;
+            trim_blanks(&(*arguments)[count].text, &(*arguments)[count].length);
+            count++;
+            start = i + 1;
+        }
+        else if (text[i] == MACRO_ARGUMENT_QUOTE_CHAR) {
+            is_quoted = !is_quoted;
+        }
+        else if (!is_quoted && text[i] == MACRO_ARGUMENT_OPEN_PAREN_CHAR) {
+            depth++;
+        }
+        else if (!is_quoted && text[i] == MACRO_ARGUMENT_CLOSE_PAREN_CHAR && depth > 0) {
+            depth--;
+        }
+    }
+
+    return count;
+}
+
+static void expand_node_to_chunk(preAssemblerChunk* chunk, MacroListNode* node, macroArgument* arguments, int arguments_count);
+
+/* Expands a macro that a body invokes, its arguments are built from the arguments of the body first. */
+static void expand_span_to_chunk(preAssemblerChunk* chunk, macroSpan* span, macroArgument* arguments, int arguments_count)
+{
+    size_t log_sz = 0, phy_sz = INIT_PHY_SZ;
+    char* text;
+    macroArgument* inner = NULL;
+    macroSpan* part;
+    int i, inner_count;
+
+    if (!span->arguments) {
+        expand_node_to_chunk(chunk, span->macro, NULL, 0);
+        return;
+    }
+
+    text = (char*)xcalloc(phy_sz, sizeof(char));
+    for (i = 0; i < span->arguments_log_sz; i++) {
+        part = &span->arguments[i];
+        if (part->kind == SPAN_TEXT)
+            text = append_text(text, &log_sz, &phy_sz, part->text, part->log_sz);
+        else if (part->param < arguments_count)
+            text = append_text(text, &log_sz, &phy_sz, arguments[part->param].text, arguments[part->param].length);
+    }
+
+    inner_count = split_arguments(text, log_sz, &inner);
+    expand_node_to_chunk(chunk, span->macro, inner, inner_count);
+
+    free(inner);
+    free(text);
+}
+
+/* Flattens a body into the text of a chunk, the macros it refers to were checked so the recursion is bounded. */
+static void expand_node_to_chunk(preAssemblerChunk* chunk, MacroListNode* node, macroArgument* arguments, int arguments_count)
+{
+    macroSpan* span;
     int i;
+
+    for (i = 0; i < node->log_sz; i++) {
+        span = &node->spans[i];
+        if (span->kind == SPAN_TEXT)
+            chunk->text = append_text(chunk->text, &chunk->log_sz, &chunk->phy_sz, span->text, span->log_sz);
+        else if (span->kind == SPAN_PARAM && span->param < arguments_count)
+            chunk->text = append_text(chunk->text, &chunk->log_sz, &chunk->phy_sz, arguments[span->param].text, arguments[span->param].length);
+        else
+            expand_span_to_chunk(chunk, span, arguments, arguments_count);
+    }
+}
+
+/* Returns the included file at an index of the list, NULL if it couldn't be read. */
+static includedSource* macro_list_get_include(MacroList* list, int index)
+{
+    return list->includes[index].file ? (includedSource*)include_cache_get_data(list->includes[index].file) : list->includes[index].source;
+}
+
+/* Expands every macro with the given name, i.e a macro that was defined twice is expanded twice. The macros of the included files come after those of the file. */
+static void expand_macro_to_chunk(preAssemblerChunk* chunk, MacroList* list, preAssemblerLine* line)
+{
     MacroListNode* head = list->head;
+    includedSource* include;
+    int i;
 
     while (head) {
-        if (strcmp(head->macro_name, name) == 0) {
-            for (i = 0; i < head->log_sz; i++) {
-                fputs(head->macro_expension[i], out);
-                fputc('\n', out);
-            }
+        if (strcmp(head->macro_name, line->name) == 0) {
+            expand_node_to_chunk(chunk, head, line->arguments, line->arguments_count);
         }
         head = head->next;
     }
+
+    for (i = 0; i < list->includes_count; i++)
+        if ((include = macro_list_get_include(list, i)) != NULL)
+            expand_macro_to_chunk(chunk, include->list, line);
 }
 
 void macro_list_insert_node(MacroList* list, MacroListNode* node)
@@ -202,105 +579,548 @@ void macro_list_insert_node(MacroList* list, MacroListNode* node)
     }
 }
 
+/* Adds a span to a dynamic array of spans, a body or the arguments of an invocation. */
+static macroSpan* add_span(macroSpan** spans, int* log_sz, int* phy_sz, MacroSpanKind kind)
+{
+    macroSpan* span;
+
+    if (*log_sz + 1 >= *phy_sz) {
+        GROW_CAPACITY(*phy_sz);
+        *spans = GROW_ARRAY(macroSpan*, *spans, *phy_sz, sizeof(macroSpan));
+    }
+
+    span = &(*spans)[(*log_sz)++];
+    span->kind = kind;
+    span->text = NULL;
+    span->log_sz = span->phy_sz = 0;
+    span->macro = NULL;
+    span->param = 0;
+    span->arguments = NULL;
+    span->arguments_log_sz = span->arguments_phy_sz = span->arguments_count = 0;
+
+    return span;
+}
+
+/* Appends literal text to spans, consecutive text shares a span so it's expanded with a single copy. */
+static void add_text(macroSpan** spans, int* log_sz, int* phy_sz, char* text, size_t length)
+{
+    macroSpan* span = *log_sz > 0 ? &(*spans)[*log_sz - 1] : NULL;
+
+    if (!span || span->kind != SPAN_TEXT) {
+        span = add_span(spans, log_sz, phy_sz, SPAN_TEXT);
+        span->phy_sz = INIT_PHY_SZ;
+        span->text = (char*)xcalloc(INIT_PHY_SZ, sizeof(char));
+    }
+
+    span->text = append_text(span->text, &span->log_sz, &span->phy_sz, text, length);
+}
+
+/* Returns the index of the parameter of a node that a word names, -1 if there is none. */
+static int macro_list_node_find_param(MacroListNode* node, char* word, size_t length)
+{
+    int i;
+
+    for (i = 0; i < node->params_count; i++)
+        if (strlen(node->params[i]) == length && strncmp(node->params[i], word, length) == 0)
+            return i;
+
+    return -1;
+}
+
+/* Compiles a text of the body of a node into literal spans and parameter slots, the words are only searched once, when the macro is defined.
+*  The text of a string, a comment and the name of a directive are kept as they are. */
+static void add_template(macroSpan** spans, int* log_sz, int* phy_sz, MacroListNode* node, char* text, size_t length)
+{
+    size_t i = 0, start = 0, word;
+    bool is_quoted = FALSE;
+    int param;
+
+    while (node->params_count > 0 && i < length) {
+        if (text[i] == MACRO_ARGUMENT_QUOTE_CHAR)
+            is_quoted = !is_quoted;
+        if (!is_quoted && text[i] == START_COMMENT_CHAR)
+            break;
+        if (is_quoted || !is_word_char(text[i])) {
+            i++;
+            continue;
+        }
+
+        for (word = i; i < length && is_word_char(text[i]); i++);
+
+        if ((word == 0 || text[word - 1] != POSTFIX_DOT_CHAR) && (param = macro_list_node_find_param(node, text + word, i - word)) >= 0) {
+            if (word > start)
+                add_text(spans, log_sz, phy_sz, text + start, word - start);
+            add_span(spans, log_sz, phy_sz, SPAN_PARAM)->param = param;
+            start = i;
+        }
+    }
+
+    if (length > start)
+        add_text(spans, log_sz, phy_sz, text + start, length - start);
+}
+
+bool macro_list_node_set_params(MacroListNode* node, char* params)
+{
+    macroArgument* names = NULL;
+    int i, j, count = split_arguments(params, strlen(params), &names);
+    bool is_valid = TRUE;
+
+    node->params_count = count;
+    node->params = count > 0 ? (char**)xcalloc(count, sizeof(char*)) : NULL;
+    for (i = 0; i < count; i++) {
+        node->params[i] = (char*)xcalloc(names[i].length + 1, sizeof(char));
+        memcpy(node->params[i], names[i].text, names[i].length);
+    }
+
+    /* A parameter is a name, a letter followed by letters, digits and underscores, that isn't a reserved word (an opcode or a register,
+    *  the same as a label) and that no other parameter of the macro has. */
+    for (i = 0; i < count && is_valid; i++) {
+        is_valid = isalpha((unsigned char)node->params[i][0]) && !is_reserved_word(node->params[i]);
+        for (j = 1; node->params[i][j] && is_valid; j++)
+            is_valid = is_word_char(node->params[i][j]);
+        for (j = 0; j < i && is_valid; j++)
+            is_valid = strcmp(node->params[j], node->params[i]) != 0;
+    }
+
+    if (!is_valid) {
+        node->err_code = ERROR_CODE_MACRO_PARAMETERS;
+        for (i = 0; i < count; i++)
+            free(node->params[i]);
+        free(node->params);
+        node->params = NULL;
+        node->params_count = 0;
+    }
+
+    free(names);
+    return is_valid;
+}
+
 void macro_list_node_insert_source(MacroListNode* node, char* line)
 {
-    size_t text_length = strlen(line);
+    add_template(&node->spans, &node->log_sz, &node->phy_sz, node, line, strlen(line));
+    add_text(&node->spans, &node->log_sz, &node->phy_sz, NEW_LINE_STRING, 1);
+}
+
+void macro_list_node_insert_macro(MacroListNode* tail, MacroListNode* node, char* arguments)
+{
+    macroSpan* span = add_span(&tail->spans, &tail->log_sz, &tail->phy_sz, SPAN_MACRO);
+    macroArgument* split = NULL;
+
+    span->macro = node;
+    span->arguments_count = arguments ? split_arguments(arguments, strlen(arguments), &split) : 0;
 
-    if (node->log_sz + 1 >= node->phy_sz) {
-        GROW_CAPACITY(node->phy_sz);
-        node->macro_expension = GROW_ARRAY(char**, node->macro_expension, node->phy_sz, sizeof(char*));
+    /* The arguments are compiled against the parameters of the body that invokes the macro, and split again on every expansion. */
+    if (span->arguments_count > 0) {
+        span->arguments_phy_sz = INIT_PHY_SZ;
+        span->arguments = (macroSpan*)xcalloc(INIT_PHY_SZ, sizeof(macroSpan));
+        add_template(&span->arguments, &span->arguments_log_sz, &span->arguments_phy_sz, tail, arguments, strlen(arguments));
     }
 
-    node->macro_expension[node->log_sz] = (char*)xcalloc(text_length + 1, sizeof(char));
-    sprintf(node->macro_expension[node->log_sz], "%s", line);
-    node->log_sz++;
+    free(split);
 }
 
-void macro_list_node_insert_macro(MacroListNode* tail, MacroListNode* node)
+/* Finds whether a body can be expanded, a macro that expands itself (directly or through other macros), is nested too deep or is invoked
+*  with the wrong amount of arguments can't be. */
+static errorCodes macro_list_check_node(MacroListNode* node)
 {
+    errorCodes err_code = node->err_code;
+    MacroListNode* inner;
     int i;
-    for (i = 0; i < node->log_sz; i++) {
-        macro_list_node_insert_source(tail, node->macro_expension[i]);
+
+    if (node->check_state == MACRO_CHECKED)
+        return node->err_code;
+    if (node->check_state == MACRO_CHECKING)
+        return ERROR_CODE_MACRO_CYCLE;
+
+    node->check_state = MACRO_CHECKING;
+    node->depth = 1;
+
+    for (i = 0; i < node->log_sz && err_code == ERROR_CODE_OK; i++) {
+        if (node->spans[i].kind != SPAN_MACRO)
+            continue;
+
+        inner = node->spans[i].macro;
+        err_code = macro_list_check_node(inner);
+        if (err_code == ERROR_CODE_OK && inner->params_count != node->spans[i].arguments_count)
+            err_code = ERROR_CODE_MACRO_ARGUMENTS;
+        if (err_code == ERROR_CODE_OK && inner->depth + 1 > node->depth)
+            node->depth = inner->depth + 1;
     }
+
+    if (err_code == ERROR_CODE_OK && node->depth > MACRO_MAX_NESTING_DEPTH)
+        err_code = ERROR_CODE_MACRO_TOO_DEEP;
+
+    node->check_state = MACRO_CHECKED;
+    node->err_code = err_code;
+    return err_code;
+}
+
+/* Returns why the macros of a name can't be expanded with an amount of arguments, ERROR_CODE_OK if they can. */
+static errorCodes macro_list_get_error(MacroList* list, char* name, int arguments_count)
+{
+    MacroListNode* head;
+    includedSource* include;
+    errorCodes err_code;
+    int i;
+
+    for (head = list->head; head; head = head->next) {
+        if (strcmp(head->macro_name, name) != 0)
+            continue;
+        if (head->err_code != ERROR_CODE_OK)
+            return head->err_code;
+        if (head->params_count != arguments_count)
+            return ERROR_CODE_MACRO_ARGUMENTS;
+    }
+
+    for (i = 0; i < list->includes_count; i++)
+        if ((include = macro_list_get_include(list, i)) != NULL && (err_code = macro_list_get_error(include->list, name, arguments_count)) != ERROR_CODE_OK)
+            return err_code;
+
+    return ERROR_CODE_OK;
 }
 
 MacroListNode* macro_list_get_node(MacroList* list, char* entry)
 {
     MacroListNode* head = list->head;
+    includedSource* include;
+    int i;
 
     while (head) {
         if (strcmp(head->macro_name, entry) == 0) return head;
         head = head->next;
     }
 
+    for (i = 0; i < list->includes_count; i++)
+        if ((include = macro_list_get_include(list, i)) != NULL && (head = macro_list_get_node(include->list, entry)) != NULL)
+            return head;
+
     return NULL;
 }
 
-void create_pre_assembler_file(FILE* in, FILE* out, MacroList* list)
+/* Returns why an '.include' line can't be expanded, or ERROR_CODE_OK and the file it includes. */
+static errorCodes macro_list_find_include(MacroList* list, char* name, includedSource** include)
 {
-    char* line, * name = NULL;
+    int i;
+
+    if (!name)
+        return ERROR_CODE_INCLUDE_SYNTAX;
+    if (!list->can_include)
+        return ERROR_CODE_INCLUDE_NESTED;
+
+    for (i = 0; i < list->includes_count && strcmp(list->includes[i].name, name) != 0; i++);
+
+    if (i < list->includes_count && !list->includes[i].is_available)
+        return ERROR_CODE_INCLUDE_UNAVAILABLE;
+    if (i == list->includes_count || (*include = macro_list_get_include(list, i)) == NULL)
+        return ERROR_CODE_INCLUDE_OPEN;
+
+    return (*include)->err_code;
+}
+
+/* A ParallelTask, reads the state and the macro name of every line of a chunk. */
+static void classify_chunk(void* item)
+{
+    preAssemblerChunk* chunk = (preAssemblerChunk*)item;
+    preAssemblerLine* line;
     LineIterator it;
-    ReadState current_state = READ_UNKNOWN;
-    bool did_started_reading = FALSE;
+    int i;
 
-    while ((line = get_line(in)) != NULL) {
-        name = NULL;
-        line_iterator_put_line(&it, line);
+    for (i = 0; i < chunk->count; i++) {
+        line = &chunk->lines[i];
+        line->state = READ_COMMENT;
+        line_iterator_put_line(&it, line->source->text);
 
         if (line_iterator_peek(&it) == '\0') {
-            free(line);
             continue;
         }
 
         /* If blanks are encountered, consume them. */
         line_iterator_consume_blanks(&it);
 
-        /* Get the current state. */
-        current_state = get_current_reading_state(&it);
+        if (is_include_directive(&it)) {
+            line->state = READ_UNKNOWN;
+            line->is_include = TRUE;
+            line->include_name = get_include_name(&it);
+            continue;
+        }
 
-        /* Skip comments, and if not a comment, copy macro (if the state is correct). */
-        if (current_state != READ_COMMENT) {
-            name = get_macro_name(&it);
+        /* Get the current state, comments are skipped. */
+        line->state = get_current_reading_state(&it);
 
-            /* Check wheter we encountered a valid macro name, and we did not started reading a macro. */
-            if (macro_list_get_node(list, name) && !did_started_reading) {
-                /* If the state is READ_START_MACRO, change the flag to reflect that we are inside a macro definition. */
-                if (current_state == READ_START_MACRO) {
-                    did_started_reading = TRUE;
-                }
-                else {
-                    /* Expand the macro.*/
-                    expand_macro_to_file(out, list, name);
-                }
+        if (line->state != READ_COMMENT) {
+            line->name = get_macro_name(&it);
+            line->macro = macro_list_get_node(chunk->list, line->name);
+
+            /* The rest of an invocation is its arguments. */
+            if (line->macro && line->state != READ_START_MACRO)
+                line->arguments_count = split_arguments(it.current, strlen(it.current), &line->arguments);
+        }
+    }
+}
+
+/* A ParallelTask, writes the expanded lines of a chunk into its text. */
+static void expand_chunk(void* item)
+{
+    preAssemblerChunk* chunk = (preAssemblerChunk*)item;
+    int i;
+
+    for (i = 0; i < chunk->count; i++) {
+        if (chunk->lines[i].action == EMIT_LINE)
+            chunk_append_line(chunk, chunk->lines[i].source->text);
+        else if (chunk->lines[i].action == EMIT_MACRO)
+            expand_macro_to_chunk(chunk, chunk->list, &chunk->lines[i]);
+        else if (chunk->lines[i].action == EMIT_INCLUDE)
+            chunk->text = append_text(chunk->text, &chunk->log_sz, &chunk->phy_sz, chunk->lines[i].include->text, chunk->lines[i].include->size);
+    }
+}
+
+/* Expands the lines of a file into the text of its chunks, in order. Returns ERROR_CODE_OK if every invocation and include was expanded, the first reason one wasn't otherwise. */
+static errorCodes expand_file(FILE* in, MacroList* list, int jobs, debugList* dbg_list, preAssemblerChunk** expanded, int* expanded_count)
+{
+    LineReader* reader = line_reader_new(in);
+    SourceFile source;
+    preAssemblerLine* lines = NULL, *line = NULL;
+    preAssemblerChunk* chunks = NULL;
+    MacroListNode* node;
+    errorCodes err_code, first_err_code = ERROR_CODE_OK;
+    bool did_started_reading = FALSE;
+    int i, chunks_count;
+
+    /* The bodies are checked once, in the order they were defined, so the expansion on the chunks only reads them. */
+    for (node = list->head; node; node = node->next)
+        macro_list_check_node(node);
+
+    line_reader_read_all(reader, &source);
+    line_reader_destroy(&reader);
+    lines = (preAssemblerLine*)xcalloc(source.count + 1, sizeof(preAssemblerLine));
+
+    for (i = 0; i < source.count; i++) {
+        lines[i].source = &source.lines[i];
+
+        /* The line is read whole, but it's still longer than the language allows. */
+        if (source.lines[i].is_too_long) {
+            debug_list_register_node(dbg_list, source.lines[i].text, NULL, source.lines[i].number, ERROR_CODE_LINE_TOO_LONG_WARN);
+        }
+    }
+
+    /* Split the lines into chunks, the macro lookups and later the expansion of a chunk run on their own thread. */
+    chunks_count = source.count / PRE_ASSEMBLER_MIN_CHUNK_LINES;
+    if (chunks_count > jobs)
+        chunks_count = jobs;
+    if (chunks_count < 1)
+        chunks_count = 1;
+
+    chunks = (preAssemblerChunk*)xcalloc(chunks_count, sizeof(preAssemblerChunk));
+    for (i = 0; i < chunks_count; i++) {
+        chunks[i].lines = lines + (long)source.count * i / chunks_count;
+        chunks[i].count = (int)((long)source.count * (i + 1) / chunks_count - (long)source.count * i / chunks_count);
+        chunks[i].list = list;
+        chunks[i].phy_sz = INIT_PHY_SZ;
+        chunks[i].text = (char*)xcalloc(INIT_PHY_SZ, sizeof(char));
+    }
+
+    parallel_run_tasks(chunks, chunks_count, sizeof(preAssemblerChunk), classify_chunk);
+
+    /* Whether a line is inside a macro definition depends on the lines before it, resolve the actions in order. */
+    for (i = 0; i < source.count; i++) {
+        line = &lines[i];
+
+        if (line->state == READ_COMMENT) {
+            continue;
+        }
+
+        /* Check wheter we encountered a valid macro name, and we did not started reading a macro. */
+        if (line->macro && !did_started_reading) {
+            /* If the state is READ_START_MACRO, change the flag to reflect that we are inside a macro definition. */
+            if (line->state == READ_START_MACRO) {
+                did_started_reading = TRUE;
             }
-            /* We reached an 'endmcr' thus the macro defintion has ended. Change the flag to reflect that. */
-            else if (current_state == READ_END_MACRO) {
-                did_started_reading = FALSE;
+            else if ((err_code = macro_list_get_error(list, line->name, line->arguments_count)) != ERROR_CODE_OK) {
+                /* The macro can't be expanded, the invocation is dropped. */
+                debug_list_register_node(dbg_list, line->source->text, NULL, line->source->number, err_code);
+                if (first_err_code == ERROR_CODE_OK)
+                    first_err_code = err_code;
             }
             else {
-                /*
-                    If we reached the end of a macro definitons, and we are not currently reading a macro.
-                    So the macro wont be copied twice.
-                */
-                if (!did_started_reading) {
-                    fputs(line, out);
-                    fputc('\n', out);
-                }
+                /* Expand the macro.*/
+                line->action = EMIT_MACRO;
             }
         }
+        /* We reached an 'endmcr' thus the macro defintion has ended. Change the flag to reflect that. */
+        else if (line->state == READ_END_MACRO) {
+            did_started_reading = FALSE;
+        }
+        /* An '.include' is expanded to the lines of the file, an include that can't be expanded is dropped. */
+        else if (line->is_include && !did_started_reading) {
+            if ((err_code = macro_list_find_include(list, line->include_name, &line->include)) != ERROR_CODE_OK) {
+                debug_list_register_node(dbg_list, line->source->text, NULL, line->source->number, err_code);
+                if (first_err_code == ERROR_CODE_OK)
+                    first_err_code = err_code;
+            }
+            else {
+                line->action = EMIT_INCLUDE;
+            }
+        }
+        /* A line outside of a macro definition is copied as is, so the macro won't be copied twice. */
+        else if (!did_started_reading) {
+            line->action = EMIT_LINE;
+        }
+    }
 
-        free(name);
-        free(line);
+    parallel_run_tasks(chunks, chunks_count, sizeof(preAssemblerChunk), expand_chunk);
+
+    for (i = 0; i < source.count; i++) {
+        free(lines[i].name);
+        free(lines[i].arguments);
+        free(lines[i].include_name);
     }
+
+    free(lines);
+    source_file_free(&source);
+
+    *expanded = chunks;
+    *expanded_count = chunks_count;
+    return first_err_code;
 }
 
-void macro_free_expension(char*** macro_expension, int size)
+bool create_pre_assembler_file(FILE* in, FILE* out, MacroList* list, int jobs, debugList* dbg_list)
 {
-    char** ptr = *macro_expension;
+    preAssemblerChunk* chunks = NULL;
+    int i, chunks_count;
+    bool is_expanded = (expand_file(in, list, jobs, dbg_list, &chunks, &chunks_count) == ERROR_CODE_OK);
+
+    /* The text of the chunks is written in order, without joining it to a single buffer first. */
+    for (i = 0; i < chunks_count; i++) {
+        fwrite(chunks[i].text, sizeof(char), chunks[i].log_sz, out);
+        free(chunks[i].text);
+    }
+
+    free(chunks);
+    return is_expanded;
+}
+
+/* Scans the macros of an included file and expands the rest of its lines. */
+static includedSource* read_included_source(FILE* in)
+{
+    includedSource* include = (includedSource*)xmalloc(sizeof(includedSource));
+    preAssemblerChunk* chunks = NULL;
+    debugList* dbg_list;
+    int chunks_count;
+
+    include->list = macro_list_new_list();
+    macro_list_fill_list_from_file(in, NULL, NULL, include->list);
+    rewind(in);
+
+    /* It's expanded once for every source that includes it, on a single thread. Its problems are reported at the '.include' lines. */
+    dbg_list = debug_list_new_list();
+    include->err_code = expand_file(in, include->list, 1, dbg_list, &chunks, &chunks_count);
+    include->text = chunks[0].text;
+    include->size = chunks[0].log_sz;
+
+    debug_list_destroy(&dbg_list);
+    free(chunks);
+
+    return include;
+}
+
+/* An IncludeLoadFunc, reads a file on the disk through the store of the assembly that includes it first. */
+static void* load_included_file(char* path, void* context)
+{
+    debugList* dbg_list = debug_list_new_list();
+    FILE* in = file_store_open_read((FileStore*)context, path, dbg_list);
+    includedSource* include = NULL;
+
+    /* The problems of the file are reported at the '.include' lines. */
+    debug_list_destroy(&dbg_list);
+    if (!in)
+        return NULL;
+
+    include = read_included_source(in);
+    fclose(in);
+
+    return include;
+}
+
+/* Reads a file that a sealed store holds or resolves, it's never looked up on the disk. */
+static includedSource* resolve_included_file(FileStore* store, char* path, bool* is_available)
+{
+    includedSource* include;
+    FileBuffer file;
+    FILE* in;
+
+    if (!(*is_available = file_store_resolve(store, path, &file)))
+        return NULL;
+
+    /* An empty file has no lines, and an empty stream can't be opened on it. */
+    if (file.size == 0) {
+        include = (includedSource*)xmalloc(sizeof(includedSource));
+        include->list = macro_list_new_list();
+        include->text = (char*)xcalloc(1, sizeof(char));
+        include->size = 0;
+        include->err_code = ERROR_CODE_OK;
+        return include;
+    }
+
+    if (!(in = fmemopen(file.data, file.size, MODE_READ)))
+        return NULL;
+
+    include = read_included_source(in);
+    fclose(in);
+
+    return include;
+}
+
+/* An IncludeFreeFunc. */
+static void free_included_file(void* data)
+{
+    includedSource* include = (includedSource*)data;
+
+    macro_list_free(&include->list);
+    free(include->text);
+    free(include);
+}
+
+/* Adds a file that the list includes, the path is relative to the directory of the file that includes it. A file that is included twice is added once.
+*  The files on the disk are shared through the include cache, a sealed store never looks them up on the disk. */
+static void macro_list_add_include(MacroList* list, FileStore* store, char* includer, char* name)
+{
+    char* path;
+    int i;
+
+    for (i = 0; i < list->includes_count; i++)
+        if (strcmp(list->includes[i].name, name) == 0)
+            return;
+
+    if (list->includes_count + 1 >= list->includes_phy_sz) {
+        GROW_CAPACITY(list->includes_phy_sz);
+        list->includes = GROW_ARRAY(macroInclude*, list->includes, list->includes_phy_sz, sizeof(macroInclude));
+    }
+
+    path = get_include_path(includer, name);
+    list->includes[list->includes_count].name = get_copy_string(name);
+    list->includes[list->includes_count].file = NULL;
+    list->includes[list->includes_count].source = NULL;
+    list->includes[list->includes_count].is_available = TRUE;
+
+    if (file_store_is_sealed(store))
+        list->includes[list->includes_count].source = resolve_included_file(store, path, &list->includes[list->includes_count].is_available);
+    else
+        list->includes[list->includes_count].file = include_cache_acquire(path, load_included_file, free_included_file, store);
+    list->includes_count++;
+
+    free(path);
+}
+
+/* The macros a body refers to belong to the list, only the text and the arguments are freed. */
+static void macro_free_spans(macroSpan** spans, int size)
+{
+    macroSpan* ptr = *spans;
     int i;
 
     for (i = 0; i < size; i++) {
-        free(ptr[i]);
+        free(ptr[i].text);
+        if (ptr[i].arguments)
+            macro_free_spans(&ptr[i].arguments, ptr[i].arguments_log_sz);
     }
 
     free(ptr);
@@ -309,13 +1129,28 @@ void macro_free_expension(char*** macro_expension, int size)
 void macro_list_free(MacroList** list)
 {
     MacroListNode* next, * current = (*list)->head;
+    int i;
 
     while (current) {
         next = current->next;
         free(current->macro_name);
-        macro_free_expension(&current->macro_expension, current->log_sz);
+        macro_free_spans(&current->spans, current->log_sz);
+        for (i = 0; i < current->params_count; i++)
+            free(current->params[i]);
+        free(current->params);
         free(current);
         current = next;
     }
+
+    /* The included files on the disk belong to the include cache, the files of a sealed store belong to the list. */
+    for (i = 0; i < (*list)->includes_count; i++) {
+        free((*list)->includes[i].name);
+        if ((*list)->includes[i].file)
+            include_cache_release(&(*list)->includes[i].file);
+        if ((*list)->includes[i].source)
+            free_included_file((*list)->includes[i].source);
+    }
+
+    free((*list)->includes);
     free(*list);
 }
@@ -5,6 +5,9 @@
 */
 
 #include "line_iterator.h"
+#include "line_reader.h"
+#include "debug.h"
+#include "file_store.h"
 
 /**
 * @brief Enum for the constans for the different reading states, it only used internally so it'll be declared inside the '.c' file.
@@ -24,16 +27,34 @@ typedef struct macro_list MacroList;
 /**
 * @brief This function starts the pre-assembler phase of expanding the macros.
 * @param path - The path of the source file.
+* @param jobs - The maximal amount of threads to expand the macros on.
+* @param store - The files of the assembly, the source is read from it and the '.am' file is written to it.
+* @param dbg_list - The debug list, used to register warnings about the source lines and a source that can't be read.
+* @return TRUE if the '.am' file was written, FALSE if the source couldn't be read, the '.am' file couldn't be created or a macro couldn't be expanded.
 */
-void start_pre_assembler(char* path);
+bool start_pre_assembler(char* path, int jobs, FileStore* store, debugList* dbg_list);
 
 /* Reads a file, fills 'in_list' with the macros data, if all is valid, it returns TRUE, otherwise FALSE. */
 /**
 * @brief This function creates the macro list from a given file.
+* The files it includes with '.include "path"' (outside of the macro definitions) are looked up in the store of the assembly, and their macros
+* are added to the list. The files on the disk are taken from the include cache, so a file is read once for the whole process, a sealed store
+* only includes the files it holds or resolves.
 * @param in - The input file.
+* @param path - The path of the file, the included paths are relative to its directory. NULL if the file can't include other files, i.e it's included itself.
+* @param store - The files of the assembly, NULL if the file can't include other files.
 * @param in_list - The list.
 */
-void macro_list_fill_list_from_file(FILE* in, MacroList* in_list);
+void macro_list_fill_list_from_file(FILE* in, char* path, FileStore* store, MacroList* in_list);
+
+/**
+* @brief This function lists the files a source includes, read the same way macro_list_fill_list_from_file reads them, i.e for the watch mode.
+* @param in - The source.
+* @param path - The path of the source, the included paths are relative to its directory.
+* @param count - Receives the amount of paths.
+* @return The paths of the included files, every file once. The paths and the array are freed by the caller, NULL if the source includes nothing.
+*/
+char** pre_assembler_list_includes(FILE* in, char* path, int* count);
 
 /**
 * @brief This function returns the current reading state.
@@ -68,14 +89,6 @@ bool macro_list_is_empty(MacroList* list);
 */
 MacroListNode* macro_list_new_node(char* name);
 
-/**
-* @brief This function expands a macro to the output file.
-* @param out - The output file.
-* @param list - The macros list.
-* @param name - The macros name.
-*/
-void expand_macro_to_file(FILE* out, MacroList* list, char* name);
-
 /**
 * @brief This function insert a node to the macro list.
 * @param list - The list.
@@ -84,18 +97,30 @@ void expand_macro_to_file(FILE* out, MacroList* list, char* name);
 void macro_list_insert_node(MacroList* list, MacroListNode* node);
 
 /**
-* @brief This function inserts a line into 'macro_list_node.macro_expension' member.
+* @brief This function sets the parameters of a macro, the names that follow its name in the definition ('mcr m_add dst, src').
+* An invocation passes as many arguments, separated by commas outside of parentheses and quotes ('m_add r1, #3').
+* It must be called before the body is inserted. Invalid parameters are reported at the invocations of the macro.
+* @param node - The node.
+* @param params - The rest of the definition line after the name, blank if the macro has no parameters.
+* @return TRUE if the parameters are distinct names, FALSE otherwise.
+*/
+bool macro_list_node_set_params(MacroListNode* node, char* params);
+
+/**
+* @brief This function appends a line to the body of a macro.
+* The line is compiled into literal text and slots for the words that are parameters of the macro, so an expansion only copies them.
 * @param node - The node.
 * @param line - The line.
 */
 void macro_list_node_insert_source(MacroListNode* node, char* line);
 
 /**
-* @brief This function insert all of the data inside the macro specified in 'line' to the current node.
-* @param tail - The lists tail.
-* @param node - The node.
+* @brief This function appends a macro that is expanded inside the body of the current macro, by reference, its lines are only copied by the expansion.
+* @param tail - The lists tail, the macro that is being defined.
+* @param node - The macro it expands.
+* @param arguments - The arguments it's invoked with, they may refer to the parameters of the tail. NULL or blank if there are none.
 */
-void macro_list_node_insert_macro(MacroListNode* tail, MacroListNode* node);
+void macro_list_node_insert_macro(MacroListNode* tail, MacroListNode* node, char* arguments);
 
 /**
 * @brief Returns the node in which its name matches to entry
@@ -107,18 +132,17 @@ MacroListNode* macro_list_get_node(MacroList* list, char* entry);
 
 /**
 * @brief Creates an expanded source file inside 'out'.
+* The macro lookups and the expansion run on chunks of lines in parallel, the chunks are written to 'out' in order.
+* A macro that expands itself, whose macros are nested too deep or that is invoked with the wrong amount of arguments is reported at its invocations, which are dropped.
+* An '.include' line is replaced by the expanded lines of the file, an include that can't be read or expanded is reported at the line and dropped.
 * @param in - The input file.
 * @param out - The output file.
-* @param list - The macros list.
-*/
-void create_pre_assembler_file(FILE* in, FILE* out, MacroList* list);
-
-/**
-* @brief This function frees the 'macro_expension' member
-* @param macro_expension - The macro to free.
-* @param size - The number of lines of the macro.
+* @param list - The macros list, it must be complete.
+* @param jobs - The maximal amount of threads to expand the macros on.
+* @param dbg_list - The debug list.
+* @return TRUE if all the invocations were expanded, FALSE otherwise.
 */
-void macro_free_expension(char*** macro_expension, int size);
+bool create_pre_assembler_file(FILE* in, FILE* out, MacroList* list, int jobs, debugList* dbg_list);
 
 /**
 * @brief This function frees a macro list.
@@ -0,0 +1,247 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "scheduler.h"
+#include "parallel.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+typedef struct
+{
+	long size;
+	int index;
+} sizedItem;
+
+typedef struct
+{
+	Scheduler* scheduler;
+	int id;
+	pthread_mutex_t lock;
+	int* items; /* The indexes of the items, largest first. */
+	int head; /* The owner takes its items from the head. */
+	int tail; /* Thieves take items from the tail, so the owner keeps its large items. */
+	pthread_t thread;
+	bool is_started;
+	SchedulerWorkerStats stats;
+} schedulerWorker;
+
+struct scheduler
+{
+	int count;
+	int workers_count;
+	schedulerWorker* workers;
+	int* order; /* The items largest first, the order they are dealt in. */
+	SchedulerTask task;
+	void* context;
+	pthread_mutex_t done_lock;
+	pthread_cond_t done_cond;
+	bool* is_done;
+	double start_time;
+};
+
+/* Largest first, items of the same size keep the order of the batch. */
+static int compare_sized_items(const void* a, const void* b)
+{
+	const sizedItem* first = (const sizedItem*)a;
+	const sizedItem* second = (const sizedItem*)b;
+
+	if (first->size != second->size)
+		return (first->size > second->size) ? -1 : 1;
+
+	return first->index - second->index;
+}
+
+Scheduler* scheduler_new(long* sizes, int count, int workers)
+{
+	Scheduler* scheduler = (Scheduler*)xmalloc(sizeof(Scheduler));
+	sizedItem* order = (sizedItem*)xcalloc(count > 0 ? count : 1, sizeof(sizedItem));
+	schedulerWorker* worker;
+	int i;
+
+	if (workers > count)
+		workers = count;
+	if (workers < 1)
+		workers = 1;
+
+	scheduler->count = count;
+	scheduler->workers_count = workers;
+	scheduler->workers = (schedulerWorker*)xcalloc(workers, sizeof(schedulerWorker));
+	scheduler->is_done = (bool*)xcalloc(count > 0 ? count : 1, sizeof(bool));
+	scheduler->order = (int*)xcalloc(count > 0 ? count : 1, sizeof(int));
+	scheduler->task = NULL;
+	scheduler->context = NULL;
+	scheduler->start_time = 0;
+	pthread_mutex_init(&scheduler->done_lock, NULL);
+	pthread_cond_init(&scheduler->done_cond, NULL);
+
+	for (i = 0; i < count; i++) {
+		order[i].size = sizes[i];
+		order[i].index = i;
+	}
+	qsort(order, count, sizeof(sizedItem), compare_sized_items);
+	for (i = 0; i < count; i++)
+		scheduler->order[i] = order[i].index;
+
+	for (i = 0; i < workers; i++) {
+		worker = &scheduler->workers[i];
+		worker->scheduler = scheduler;
+		worker->id = i;
+		worker->items = (int*)xcalloc(count / workers + 1, sizeof(int));
+		worker->head = worker->tail = 0;
+		worker->is_started = FALSE;
+		pthread_mutex_init(&worker->lock, NULL);
+	}
+
+	/* Deal the items round robin, every deque is ordered largest first and the workers start on the largest items of the batch. */
+	for (i = 0; i < count; i++) {
+		worker = &scheduler->workers[i % workers];
+		worker->items[worker->tail++] = order[i].index;
+	}
+
+	free(order);
+	return scheduler;
+}
+
+static bool scheduler_pop_own(schedulerWorker* worker, int* index)
+{
+	bool found = FALSE;
+
+	pthread_mutex_lock(&worker->lock);
+	if (worker->head < worker->tail) {
+		*index = worker->items[worker->head++];
+		found = TRUE;
+	}
+	pthread_mutex_unlock(&worker->lock);
+
+	return found;
+}
+
+static bool scheduler_steal(schedulerWorker* thief, int* index)
+{
+	Scheduler* scheduler = thief->scheduler;
+	schedulerWorker* victim;
+	int i;
+
+	/* Start with the next worker, so the thieves don't all fall on the same victim. */
+	for (i = 1; i < scheduler->workers_count; i++) {
+		victim = &scheduler->workers[(thief->id + i) % scheduler->workers_count];
+
+		pthread_mutex_lock(&victim->lock);
+		if (victim->head < victim->tail) {
+			*index = victim->items[--victim->tail];
+			pthread_mutex_unlock(&victim->lock);
+			return TRUE;
+		}
+		pthread_mutex_unlock(&victim->lock);
+	}
+
+	return FALSE;
+}
+
+static void* scheduler_worker_main(void* arg)
+{
+	schedulerWorker* worker = (schedulerWorker*)arg;
+	Scheduler* scheduler = worker->scheduler;
+	double begin;
+	int index;
+	bool is_stolen;
+
+	for (;;) {
+		is_stolen = FALSE;
+		if (!scheduler_pop_own(worker, &index)) {
+			if (!scheduler_steal(worker, &index))
+				break;
+			is_stolen = TRUE;
+		}
+
+		begin = parallel_get_time();
+		scheduler->task(scheduler->context, index);
+		worker->stats.busy_seconds += parallel_get_time() - begin;
+		worker->stats.items++;
+		if (is_stolen)
+			worker->stats.stolen++;
+
+		pthread_mutex_lock(&scheduler->done_lock);
+		scheduler->is_done[index] = TRUE;
+		pthread_cond_broadcast(&scheduler->done_cond);
+		pthread_mutex_unlock(&scheduler->done_lock);
+	}
+
+	return NULL;
+}
+
+void scheduler_start(Scheduler* scheduler, SchedulerTask task, void* context)
+{
+	schedulerWorker* worker;
+	bool any_started = FALSE;
+	int i;
+
+	scheduler->task = task;
+	scheduler->context = context;
+	scheduler->start_time = parallel_get_time();
+
+	for (i = 0; i < scheduler->workers_count; i++) {
+		worker = &scheduler->workers[i];
+		worker->is_started = (pthread_create(&worker->thread, NULL, scheduler_worker_main, worker) == 0) ? TRUE : FALSE;
+		if (worker->is_started)
+			any_started = TRUE;
+	}
+
+	/* The items of a worker that couldn't be started are stolen by the others, without any worker the caller runs the batch. */
+	if (!any_started)
+		scheduler_worker_main(&scheduler->workers[0]);
+}
+
+void scheduler_wait_item(Scheduler* scheduler, int index)
+{
+	pthread_mutex_lock(&scheduler->done_lock);
+	while (!scheduler->is_done[index])
+		pthread_cond_wait(&scheduler->done_cond, &scheduler->done_lock);
+	pthread_mutex_unlock(&scheduler->done_lock);
+}
+
+void scheduler_join(Scheduler* scheduler)
+{
+	double total;
+	int i;
+
+	for (i = 0; i < scheduler->workers_count; i++) {
+		if (scheduler->workers[i].is_started)
+			pthread_join(scheduler->workers[i].thread, NULL);
+	}
+
+	total = parallel_get_time() - scheduler->start_time;
+	for (i = 0; i < scheduler->workers_count; i++)
+		scheduler->workers[i].stats.total_seconds = total;
+}
+
+int scheduler_get_item_at(Scheduler* scheduler, int position)
+{
+	return scheduler->order[position];
+}
+
+int scheduler_get_workers_count(Scheduler* scheduler)
+{
+	return scheduler->workers_count;
+}
+
+void scheduler_get_stats(Scheduler* scheduler, int worker, SchedulerWorkerStats* stats)
+{
+	*stats = scheduler->workers[worker].stats;
+}
+
+void scheduler_destroy(Scheduler** scheduler)
+{
+	int i;
+
+	for (i = 0; i < (*scheduler)->workers_count; i++) {
+		pthread_mutex_destroy(&(*scheduler)->workers[i].lock);
+		free((*scheduler)->workers[i].items);
+	}
+
+	pthread_mutex_destroy(&(*scheduler)->done_lock);
+	pthread_cond_destroy(&(*scheduler)->done_cond);
+	free((*scheduler)->is_done);
+	free((*scheduler)->order);
+	free((*scheduler)->workers);
+	free(*scheduler);
+}
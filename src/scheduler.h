@@ -0,0 +1,94 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/** @file
+*	This header declares the batch scheduler, it runs a task on every item of a batch on a pool of worker threads.
+*   The items are dealt to the workers largest first, each worker has its own deque and a worker that runs out of items steals from the others,
+*   so one big item that is left for the end doesn't keep the rest of the workers idle.
+*/
+
+#include "utils.h"
+
+/**
+* @brief A task that is run on a single item of the batch.
+*/
+typedef void (*SchedulerTask)(void* context, int index);
+
+/**
+* @brief This data structure holds what a single worker did during a run.
+*/
+typedef struct
+{
+	int items; /* The amount of items the worker ran. */
+	int stolen; /* The amount of those items that were stolen from another worker. */
+	double busy_seconds; /* The time the worker spent in the task. */
+	double total_seconds; /* The time from the start of the run until its join. */
+} SchedulerWorkerStats;
+
+/**
+* @brief A forward declaration of the scheduler, declaration in the '.c' file.
+*/
+typedef struct scheduler Scheduler;
+
+/**
+* @brief This function creates a new scheduler for a batch.
+* @param sizes - The estimated cost of every item, i.e the size of a file, larger items are started first.
+* @param count - The amount of items.
+* @param workers - The amount of worker threads, it's clamped to the amount of items.
+* @return A new scheduler.
+*/
+Scheduler* scheduler_new(long* sizes, int count, int workers);
+
+/**
+* @brief This function starts running the task on every item, it returns once the workers are started.
+* If no worker thread can be created the whole batch is run on the calling thread before returning.
+* @param scheduler - The scheduler.
+* @param task - The task.
+* @param context - Passed as is to the task.
+*/
+void scheduler_start(Scheduler* scheduler, SchedulerTask task, void* context);
+
+/**
+* @brief This function waits until the task of an item returns, so the results can be consumed in the order of the batch.
+* @param scheduler - The scheduler.
+* @param index - The index of the item.
+*/
+void scheduler_wait_item(Scheduler* scheduler, int index);
+
+/**
+* @brief This function waits for all the workers to finish.
+* @param scheduler - The scheduler.
+*/
+void scheduler_join(Scheduler* scheduler);
+
+/**
+* @brief This function returns the items in the order they are started, largest first, as long as no worker steals.
+* i.e for a stage that prepares the items ahead of the workers.
+* @param scheduler - The scheduler.
+* @param position - The position in the order, 0 is started first.
+* @return The index of the item.
+*/
+int scheduler_get_item_at(Scheduler* scheduler, int position);
+
+/**
+* @brief This function returns the amount of workers of the scheduler.
+* @param scheduler - The scheduler.
+* @return The amount of workers.
+*/
+int scheduler_get_workers_count(Scheduler* scheduler);
+
+/**
+* @brief This function returns what a worker did, it's valid after scheduler_join.
+* @param scheduler - The scheduler.
+* @param worker - The index of the worker.
+* @param stats - Receives the stats.
+*/
+void scheduler_get_stats(Scheduler* scheduler, int worker, SchedulerWorkerStats* stats);
+
+/**
+* @brief This function frees a scheduler, it must be joined first.
+* @param scheduler - The scheduler to free.
+*/
+void scheduler_destroy(Scheduler** scheduler);
+
+#endif
@@ -3,15 +3,26 @@
 
 #include <ctype.h>
 
+#define DECIMAL_BASE 10
+
 struct flags
 {
 	bool dot_entry_exists;
 	bool dot_extern_exists;
 };
 
-struct TranslatedMachineData {
-	int address;
-	char translated[SINGLE_ORDER_SIZE + 1]; /* (+1) for '\0'. */
+typedef struct
+{
+	VarData* variables; /* The operands of the line. */
+	SyntaxGroups group;
+	int address; /* The offset of the first operand word in the instruction image. */
+} unresolvedLine;
+
+struct pendingOperands
+{
+	int log_sz;
+	int phy_sz;
+	unresolvedLine* lines; /* In the order of the lines. */
 };
 
 struct programFinalStatus
@@ -23,52 +34,100 @@ struct programFinalStatus
 		bool error_flag; /* A flag indicating whether an error occurred during assembly. */
 };
 
-bool initiate_second_pass(char* path, SymbolTable* table, memoryBuffer* memory)
+/* Resolves the operands of the pending lines, every line ORs into its own words. An image holds at most RAM_MEMORY_SZ words, too few lines
+*  to split between threads. */
+static void resolve_pending_operands(PendingOperands* pending, SymbolTable* table, imageMemory* img)
 {
-	FILE* in = open_file(path, MODE_READ);
+	imageMemory* scratch = image_memory_get_new();
+	int i, j;
+
+	for (i = 0; i < pending->log_sz; i++) {
+		encode_labels(pending->lines[i].variables, pending->lines[i].group, table, scratch);
+
+		for (j = 0; j < img_memory_get_counter(scratch); j++)
+			img_memory_or_word(img, pending->lines[i].address + j, img_memory_get_word(scratch, j));
+		img_memory_clear(scratch);
+	}
+
+	free(scratch);
+}
+
+bool initiate_second_pass(char* path, SymbolTable* table, memoryBuffer* memory, ObjectFormat format, FileStore* store, debugList* dbg_list)
+{
+	FILE* in = file_store_open_read(store, path, dbg_list);
 	programFinalStatus finalStatus = { 0 }; /*state manager*/
 	LineIterator curLine;
-	char* line = NULL;
-	long lineNum = 1;
+	LineReader* reader = NULL;
+	SourceLine line;
+	PendingOperands pending = { 0 };
+	int i;
+
+	if (!in)
+		return FALSE;
+
+	reader = line_reader_new(in);
 
+	debug_list_set_file(dbg_list, path);
 	add_label_base_address(table); /*adds +100 to each label address*/
 	img_memory_set_counter(memory_buffer_get_inst_img(memory), 0); /*inits counter*/
 
-	while ((line = get_line(in)) != NULL) { /*Goes over each line*/
-		line_iterator_put_line(&curLine, line);
+	pending.phy_sz = INIT_PHY_SZ;
+	pending.lines = (unresolvedLine*)xcalloc(INIT_PHY_SZ, sizeof(unresolvedLine));
+
+	while (!debug_list_reached_limit(dbg_list) && line_reader_next(reader, &line)) { /*Goes over each line, stops at the errors limit*/
+		line_iterator_put_line(&curLine, line.text);
 		line_iterator_jump_to(&curLine, COLON_CHAR); /*skips label*/
 
 		if (!directive_exists(&curLine)) { /*checks if any kind of instruction exists (.something)*/
-			execute_line(&curLine, table, memory, &finalStatus.error_flag, lineNum); /*exeutes line by verification -> enocding/error throw*/
+			execute_line(&curLine, table, memory, &finalStatus.error_flag, line.number, &pending, dbg_list); /*exeutes line by verification -> enocding/error throw*/
 		}
 		else {
 			extract_directive_type(&curLine, &finalStatus.entryAndExternFlag); /*in case line is a directive*/
 		}
-
-		lineNum++;
-		free(line);
 	}
 
+	line_reader_destroy(&reader);
+	fclose(in);
+
+	/* The symbol table is complete, the operands of all the lines are resolved at once. */
+	if (!finalStatus.error_flag)
+		resolve_pending_operands(&pending, table, memory_buffer_get_inst_img(memory));
+
+	for (i = 0; i < pending.log_sz; i++)
+		if (pending.lines[i].variables)
+			varData_destroy(&pending.lines[i].variables);
+	free(pending.lines);
+
 	if (finalStatus.error_flag) /*check if any error occured, if so, do not generate new files*/
 		return FALSE;
 
-	create_files(memory, path, &finalStatus, table);
-	fclose(in);
-
-	return TRUE;
+	return create_files(memory, path, &finalStatus, table, format, store, dbg_list);
 }
 
-void execute_line(LineIterator* it, SymbolTable* table, memoryBuffer* memory, bool* errorFlag, long line_num) {
+void execute_line(LineIterator* it, SymbolTable* table, memoryBuffer* memory, bool* errorFlag, long line_num, PendingOperands* pending, debugList* dbg_list) {
+	imageMemory* inst = memory_buffer_get_inst_img(memory);
+	unresolvedLine* unresolved = NULL;
+
 	if (line_iterator_word_includes(it, DOT_DATA_STRING) || line_iterator_word_includes(it, DOT_STRING_STRING)) {
 		return;
 	}
 
 	/* Increment counter by one, as every command has a preceding word. */
-	img_memory_set_counter(memory_buffer_get_inst_img(memory), img_memory_get_counter(memory_buffer_get_inst_img(memory)) + 1);
+	img_memory_set_counter(inst, img_memory_get_counter(inst) + 1);
 
-	if (is_label_exists_in_line(it, table, errorFlag, line_num)) { /*checks if label exists and valid*/
+	if (is_label_exists_in_line(it, table, errorFlag, line_num, dbg_list)) { /*checks if label exists and valid*/
 		update_symbol_address(*it, memory, table); /*updates the address of the symbol*/
-		encode_label_start_process(it, memory, table); /*encodes the mem cell according to the label*/
+
+		/* The words of the operands are resolved once all the lines were read, only the counter moves over them now. */
+		if (pending->log_sz + 1 >= pending->phy_sz) {
+			GROW_CAPACITY(pending->phy_sz);
+			pending->lines = GROW_ARRAY(unresolvedLine*, pending->lines, pending->phy_sz, sizeof(unresolvedLine));
+		}
+
+		unresolved = &pending->lines[pending->log_sz++];
+		unresolved->variables = extract_label_operands(it, &unresolved->group);
+		unresolved->address = img_memory_get_counter(inst);
+		img_memory_set_counter(inst, unresolved->address + encode_labels_get_words_count(unresolved->variables));
 	}
 	else {
 		skip_first_pass_mem(memory, it); /*if no label exists, skip calculated amount of cells*/
@@ -117,95 +176,83 @@ int find_amount_of_lines_to_skip(LineIterator* it) {
 	return total; /* 1 for the opcode, 2 for each individual memory word */
 }
 
-bool generate_object_file(memoryBuffer* memory, char* path)
+/* Formats the object lines of the words of an image, the first one is at 'address' (without the DECIMAL_ADDRESS_BASE). */
+static void format_object_lines(imageMemory* img, int address, char* out)
 {
-	char* outfileName = NULL;
-	FILE* out = NULL;
-	TranslatedMachineData* translatedMemory = NULL;
-	char placeholder[50] = { 0 };
 	int i;
 
-	translatedMemory = translate_to_machine_data(memory);
-	outfileName = get_outfile_name(path, ".object");
-	out = open_file(outfileName, MODE_WRITE);
-
-	/* Write the instruction and data image counters to the output file */
-	sprintf(placeholder, "%9d\t%4d\n", img_memory_get_counter(memory_buffer_get_inst_img(memory)), img_memory_get_counter(memory_buffer_get_data_img(memory)));
-	fputs(placeholder, out);
+	for (i = 0; i < img_memory_get_counter(img); i++)
+		object_codec_format_line(out + (size_t)(address + i) * OBJECT_LINE_LENGTH, DECIMAL_ADDRESS_BASE + address + i, img_memory_get_word(img, i));
+}
 
-	/* Iterate over the translated memory and write it to the output file */
-	for (i = 0; i < img_memory_get_counter(memory_buffer_get_inst_img(memory)) + img_memory_get_counter(memory_buffer_get_data_img(memory)); i++) {
-		sprintf(placeholder, "%04d\t%s\n", DECIMAL_ADDRESS_BASE + translatedMemory[i].address, translatedMemory[i].translated);
-		fputs(placeholder, out);
-	}
+bool generate_object_file(memoryBuffer* memory, char* path, FileStore* store, debugList* dbg_list)
+{
+	imageMemory* inst = memory_buffer_get_inst_img(memory), * data = memory_buffer_get_data_img(memory);
+	char header[OBJECT_HEADER_MAX_LENGTH] = { 0 };
+	char* outfileName = NULL, * out = NULL;
+	size_t header_length;
+	bool is_written;
 
-	free(translatedMemory);
-	free(outfileName);
-	fclose(out);
+	/* The instruction and data image counters, every line after them has the same length so the size of the file is known. */
+	sprintf(header, OBJECT_HEADER_FORMAT, img_memory_get_counter(inst), img_memory_get_counter(data));
+	header_length = strlen(header);
 
-	return TRUE;
-}
+	outfileName = get_outfile_name(path, OBJECT_ASSEMBLER_FILE_EXTENSTION);
+	out = file_store_create_sized(store, outfileName, header_length + (size_t)(img_memory_get_counter(inst) + img_memory_get_counter(data)) * OBJECT_LINE_LENGTH, dbg_list);
 
-TranslatedMachineData* translate_to_machine_data(memoryBuffer* memory)
-{
-	int i = 0, total = img_memory_get_counter(memory_buffer_get_data_img(memory)) + img_memory_get_counter(memory_buffer_get_inst_img(memory));
+	if (!out) {
+		free(outfileName);
+		return FALSE;
+	}
 
-	/* Allocate memory for the translated machine code */
-	TranslatedMachineData* translatedMemory = (TranslatedMachineData*)xmalloc(total * sizeof(TranslatedMachineData));
+	memcpy(out, header, header_length);
+	out += header_length;
 
-	img_memory_get_counter(memory_buffer_get_data_img(memory));
+	/* The data image follows the instruction image. */
+	format_object_lines(inst, 0, out);
+	format_object_lines(data, img_memory_get_counter(inst), out);
 
-	/* Decode the instruction and data memory buffers and store in the translated memory */
-	decode_memory(translatedMemory, memory_buffer_get_inst_img(memory), &i, img_memory_get_counter(memory_buffer_get_inst_img(memory)) + 1);
-	decode_memory(translatedMemory, memory_buffer_get_data_img(memory), &i, total);
+	is_written = file_store_close_sized(store, outfileName, dbg_list);
 
-	return translatedMemory;
+	free(outfileName);
 
+	return is_written;
 }
 
-void decode_memory(TranslatedMachineData* tmd, imageMemory* inst, int* startPos, int endPos)
+bool generate_compact_object_file(memoryBuffer* memory, char* path, FileStore* store, debugList* dbg_list)
 {
-	int i, j, k = *startPos;
-
-	for (i = 0; k < endPos; i++) {
-		/* Get the current memory word and set the address of the translated machine data */
-		unsigned int bits = (memory_word_get_memory(img_memory_get_memory_at(inst, i))[1] << 0x08) | memory_word_get_memory(img_memory_get_memory_at(inst, i))[0];
-		tmd[k].address = k;
-		memset(tmd[k].translated, 0, sizeof(tmd[k].translated));
-
-		 /*translated the memory from binary to slashes and dots*/
-		for (j = 13; j >= 0; j--) {
-			unsigned int mask = 1 << j;
-			if ((bits & mask) != 0) {
-				tmd[k].translated[13 - j] = OBJECT_PRINT_SLASH;
-			}
-			else {
-				tmd[k].translated[13 - j] = OBJECT_PRINT_DOT;
-			}
-		}
-		k++;
+	char* outfileName = get_outfile_name(path, COMPACT_OBJECT_ASSEMBLER_FILE_EXTENSTION), * out;
+	size_t size = object_codec_get_compact_size(memory);
+	bool is_written = FALSE;
+
+	/* The runs are counted first, so the file is created at its exact size and encoded straight into it. */
+	if ((out = file_store_create_sized(store, outfileName, size, dbg_list))) {
+		object_codec_encode_compact(memory, out);
+		is_written = file_store_close_sized(store, outfileName, dbg_list);
 	}
-	*startPos = k - 1;
+
+	free(outfileName);
+	return is_written;
 }
 
-bool generate_externals_file(SymbolTable* table, char* path) {
+bool generate_externals_file(SymbolTable* table, char* path, FileStore* store, debugList* dbg_list) {
 	char* outfileName = NULL;/* Pointer to the filename of the output file */
 	FILE* out = NULL;
 
 	SymbolTableNode* symTableHead = symbol_table_get_head(table);
-	char placeholder[20] = { 0 }; /* Placeholder string for writing data to the file */
 
 	/* Get the name of the output file */
 	outfileName = get_outfile_name(path, EXTERN_ASSEMBLER_FILE_EXTENSTION);
 	/* Open the output file for writing */
-	out = open_file(outfileName, MODE_WRITE);
+	if (!(out = file_store_open_write(store, outfileName, dbg_list))) {
+		free(outfileName);
+		return FALSE;
+	}
 
-	/* Iterate over the symbol table and write the names and addresses of external symbols to the file */
+	/* Iterate over the symbol table and write the names and addresses of external symbols to the file, a label may be up to LABEL_MAX_LENGTH chars */
 	while (symTableHead != NULL) {
-		if (symbol_get_type(symbol_node_get_sym(symTableHead)) == SYM_EXTERN) {
-			sprintf(placeholder, "%s\t%d\n", symbol_get_name(symbol_node_get_sym(symTableHead)), symbol_get_counter(symbol_node_get_sym(symTableHead)));
-			fputs(placeholder, out);
-		}
+		if (symbol_get_type(symbol_node_get_sym(symTableHead)) == SYM_EXTERN)
+			fprintf(out, "%s\t%d\n", symbol_get_name(symbol_node_get_sym(symTableHead)), symbol_get_counter(symbol_node_get_sym(symTableHead)));
 		symTableHead = symbol_node_get_next(symTableHead);
 	}
 
@@ -217,21 +264,21 @@ bool generate_externals_file(SymbolTable* table, char* path) {
 
 }
 
-bool generate_entries_file(SymbolTable* table, char* path) {
+bool generate_entries_file(SymbolTable* table, char* path, FileStore* store, debugList* dbg_list) {
 	char* outfileName = NULL;
 	FILE* out = NULL;
 	SymbolTableNode* symTableHead = symbol_table_get_head(table);
-	char placeholder[20] = { 0 };
 
 	outfileName = get_outfile_name(path, ENTRY_ASSEMBLER_FILE_EXTENSTION);
-	out = open_file(outfileName, MODE_WRITE);
+	if (!(out = file_store_open_write(store, outfileName, dbg_list))) {
+		free(outfileName);
+		return FALSE;
+	}
 
 	/* iterate over symbol table and write the entries to file */
 	while (symTableHead != NULL) {
-		if (symbol_get_type(symbol_node_get_sym(symTableHead)) == SYM_ENTRY) {
-			sprintf(placeholder, "%s\t%d\n", symbol_get_name(symbol_node_get_sym(symTableHead)), symbol_get_counter(symbol_node_get_sym(symTableHead)));
-			fputs(placeholder, out);
-		}
+		if (symbol_get_type(symbol_node_get_sym(symTableHead)) == SYM_ENTRY)
+			fprintf(out, "%s\t%d\n", symbol_get_name(symbol_node_get_sym(symTableHead)), symbol_get_counter(symbol_node_get_sym(symTableHead)));
 		symTableHead = symbol_node_get_next(symTableHead);
 	}
 
@@ -241,18 +288,30 @@ bool generate_entries_file(SymbolTable* table, char* path) {
 	return TRUE;
 }
 
-void create_files(memoryBuffer* memory, char* path, programFinalStatus* finalStatus, SymbolTable* table)
+bool create_files(memoryBuffer* memory, char* path, programFinalStatus* finalStatus, SymbolTable* table, ObjectFormat format, FileStore* store, debugList* dbg_list)
 {
+	bool is_written;
+
 	/*Generate object file and update finalStatus accordingly*/
-	finalStatus->createdObject = generate_object_file(memory, path);
+	if (format == OBJECT_FORMAT_COMPACT)
+		finalStatus->createdObject = generate_compact_object_file(memory, path, store, dbg_list);
+	else
+		finalStatus->createdObject = generate_object_file(memory, path, store, dbg_list);
+	is_written = finalStatus->createdObject;
 
 	/*If the symbol table has externals, generate external file and update finalStatus accordingly*/
-	if (symbol_table_get_hasExternals(table))
-		finalStatus->createdExternals = generate_externals_file(table, path);
+	if (symbol_table_get_hasExternals(table)) {
+		finalStatus->createdExternals = generate_externals_file(table, path, store, dbg_list);
+		is_written = is_written && finalStatus->createdExternals;
+	}
 
 	/*If the symbol table has entries, generate entry file and update finalStatus accordingly*/
-	if (symbol_table_get_hasEntries(table))
-		finalStatus->createdEntry = generate_entries_file(table, path);
+	if (symbol_table_get_hasEntries(table)) {
+		finalStatus->createdEntry = generate_entries_file(table, path, store, dbg_list);
+		is_written = is_written && finalStatus->createdEntry;
+	}
+
+	return is_written;
 }
 
 void extract_directive_type(LineIterator* line, flags* flag) {
@@ -294,7 +353,7 @@ VarData* extract_variables(LineIterator* it) {
 	return variables;
 }
 
-bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag, long line_num) {
+bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag, long line_num, debugList* dbg_list) {
 	VarData* variablesData = NULL;
 	bool ret_val = TRUE;
 	LineIterator itLeftVar, itRightVar, itLabel;
@@ -311,11 +370,11 @@ bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag,
 	case 1: /*group 3 and 6, left var*/
 		if (varData_get_leftVar(variablesData) != NULL) {
 			line_iterator_put_line(&itLeftVar, varData_get_leftVar(variablesData));
-			ret_val = investigate_word(line, &itLeftVar, table, flag, line_num, varData_get_leftVar(variablesData), 1);
+			ret_val = investigate_word(line, &itLeftVar, table, flag, line_num, varData_get_leftVar(variablesData), 1, dbg_list);
 		}
 		else {
 			line_iterator_put_line(&itLabel, varData_get_label(variablesData));
-			ret_val = investigate_word(line, &itLabel, table, flag, line_num, varData_get_label(variablesData), 1);
+			ret_val = investigate_word(line, &itLabel, table, flag, line_num, varData_get_label(variablesData), 1, dbg_list);
 		}
 		break;
 
@@ -324,8 +383,8 @@ bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag,
 
 		line_iterator_put_line(&itLeftVar, varData_get_leftVar(variablesData));
 		line_iterator_put_line(&itRightVar, varData_get_rightVar(variablesData));
-		ret_val = investigate_word(line, &itLeftVar, table, flag, line_num, varData_get_leftVar(variablesData), 2) |
-				  investigate_word(line, &itRightVar, table, flag, line_num, varData_get_rightVar(variablesData), 2);
+		ret_val = investigate_word(line, &itLeftVar, table, flag, line_num, varData_get_leftVar(variablesData), 2, dbg_list) |
+				  investigate_word(line, &itRightVar, table, flag, line_num, varData_get_rightVar(variablesData), 2, dbg_list);
 		break;
 
 	case 3: /*groups 5, labe, left var and right var*/
@@ -333,9 +392,9 @@ bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag,
 		line_iterator_put_line(&itRightVar, varData_get_rightVar(variablesData));
 		line_iterator_put_line(&itLabel, varData_get_label(variablesData));
 
-		ret_val = investigate_word(line, &itLeftVar, table, flag, line_num, varData_get_leftVar(variablesData), 3) |
-				  investigate_word(line, &itRightVar, table, flag, line_num, varData_get_rightVar(variablesData), 3) |
-				  investigate_word(line, &itLabel, table, flag, line_num, varData_get_label(variablesData), 3);
+		ret_val = investigate_word(line, &itLeftVar, table, flag, line_num, varData_get_leftVar(variablesData), 3, dbg_list) |
+				  investigate_word(line, &itRightVar, table, flag, line_num, varData_get_rightVar(variablesData), 3, dbg_list) |
+				  investigate_word(line, &itLabel, table, flag, line_num, varData_get_label(variablesData), 3, dbg_list);
 		break;
 	}
 
@@ -344,7 +403,7 @@ bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag,
 	return ret_val;
 }
 
-bool investigate_word(LineIterator* originalLine, LineIterator* wordIterator, SymbolTable* table, bool* flag, long line_num, char* wordToInvestigate, int amountOfVars) {
+bool investigate_word(LineIterator* originalLine, LineIterator* wordIterator, SymbolTable* table, bool* flag, long line_num, char* wordToInvestigate, int amountOfVars, debugList* dbg_list) {
 	if (is_register_name_whole(wordIterator)) /*If the word is a register name, return FALSE*/
 		return FALSE;
 
@@ -358,7 +417,7 @@ bool investigate_word(LineIterator* originalLine, LineIterator* wordIterator, Sy
 		}
 		else { /*If the word doesn't exist in the symbol table*/
 			find_word_start_point(originalLine, wordToInvestigate, amountOfVars);
-			print_error(originalLine->start, line_num, ERROR_CODE_LABEL_DOES_NOT_EXISTS);
+			debug_list_register_node(dbg_list, originalLine->start, originalLine->current, line_num, ERROR_CODE_LABEL_DOES_NOT_EXISTS);
 			(*flag) = TRUE; /*sets errors flag to true*/
 			return FALSE;
 		}
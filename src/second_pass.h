@@ -5,6 +5,8 @@
 */
 
 #include "encoding.h"
+#include "file_store.h"
+#include "object_codec.h"
 
 /*
 * @brief A structure which indicates wheter .extern or/and .entry files exists, so corresponding files will be created.
@@ -12,60 +14,68 @@
 typedef struct flags flags;
 
 /**
-@brief A structure representing a translated machine code instruction, which being printed in the end of the prorgam @ object file
+@brief A structure representing the final status of the program, being updated during second pass.
 */
-typedef struct TranslatedMachineData TranslatedMachineData;
+typedef struct programFinalStatus programFinalStatus;
 
 /**
-@brief A structure representing the final status of the program, being updated during second pass.
+@brief A forward declaration of the lines whose label operands are waiting to be resolved, declaration in the '.c' file.
 */
-typedef struct programFinalStatus programFinalStatus;
+typedef struct pendingOperands PendingOperands;
 
 
 /**
 @brief Initiates the second pass of the assembler.
 This function is responsible for executing the second pass of the assembly process. It reads each line from the input file,
 sets a base address for the symbol table, initializes the instruction image counter to 0, and then executes the line by
-calling execute_line() if it's not a directive or extracts the directive type if it is. Finally, it creates output files
+calling execute_line(, dbg_list) if it's not a directive or extracts the directive type if it is. Finally, it creates output files
 for the assembly code.
+The label operands of the lines are collected while the lines are read, and resolved once all of them were read
+(the symbol table is only read by then).
 @param path The path of the input file.
 @param table A pointer to the symbol table.
 @param memory A pointer to the memory buffer.
+@param format The encoding of the object file.
+@param store The files of the assembly, the pre-assembled file is read from it and the outputs are written to it.
 @param dbg_list A pointer to the debug list.
-@return TRUE if the function executed successfully, FALSE otherwise.
+@return TRUE if the function executed successfully and the output files were written, FALSE otherwise.
 */
-bool initiate_second_pass(char* path, SymbolTable* table, memoryBuffer* memory);
+bool initiate_second_pass(char* path, SymbolTable* table, memoryBuffer* memory, ObjectFormat format, FileStore* store, debugList* dbg_list);
 
 /**
  * @brief Generates an object file from the data in a memory buffer.
  *
- * This function takes a `memoryBuffer` structure and a file path, and generates an object file
- * containing the data from the memory buffer. The object file is created using the `translate_to_machine_data()`
- * and `get_outfile_name()` functions, and it is written to the specified path.
+ * Every line of the object file has the same length, so the size of the file and the offset of every word are known
+ * from the image counters. The file is created at its size and the lines are formatted straight into it.
  *
  * @param memory The memory buffer to generate the object file from.
  * @param path The path to the output file.
- * @param err A pointer to a `debugList` structure that will be used to store any errors that occur.
+ * @param store The files of the assembly, the object file is written to it.
+ * @param dbg_list The debug list a file that can't be written is reported to.
  * @return true if the object file was generated successfully, or false if an error occurred.
  */
-bool generate_object_file(memoryBuffer* memory, char* path);
+bool generate_object_file(memoryBuffer* memory, char* path, FileStore* store, debugList* dbg_list);
 
 /**
-@brief Translates the content of a memory buffer to machine code.
-@param memory A pointer to the memory buffer to be translated.
-@return TranslatedMachineData* A pointer to a translated machine data struct.
-The struct contains the machine code equivalent of the given memory buffer.
-Returns NULL if the memory buffer is empty or cannot be translated.
-*/
-TranslatedMachineData* translate_to_machine_data(memoryBuffer* memory);
+ * @brief Generates a compact object file ('.cobject') from the data in a memory buffer, see 'object_codec.h' for its encoding.
+ *
+ * @param memory The memory buffer to generate the object file from.
+ * @param path The path to the output file.
+ * @param store The files of the assembly, the object file is written to it.
+ * @param dbg_list The debug list a file that can't be written is reported to.
+ * @return true if the object file was generated successfully, or false if an error occurred.
+ */
+bool generate_compact_object_file(memoryBuffer* memory, char* path, FileStore* store, debugList* dbg_list);
 
 /**
 @brief Generates an externals file containing the names and addresses of external symbols
 @param table Pointer to the symbol table containing the external symbols
 @param path Pointer to the path of the original source file
+@param store The files of the assembly, the file is written to it
+@param dbg_list The debug list a file that can't be written is reported to
 @return TRUE if the file was generated successfully, FALSE otherwise
 */
-bool generate_externals_file(SymbolTable* table, char* path);
+bool generate_externals_file(SymbolTable* table, char* path, FileStore* store, debugList* dbg_list);
 
 /**
 @brief Generates an entries file containing the entry symbols and their addresses
@@ -73,9 +83,11 @@ The function generates an entries file by iterating over the symbol table nodes
 writing to file the name and address of each symbol with type SYM_ENTRY.
 @param table Pointer to the symbol table
 @param path Path to the source file
+@param store The files of the assembly, the file is written to it
+@param dbg_list The debug list a file that can't be written is reported to
 @return Returns TRUE if the file generation was successful, FALSE otherwise
 */
-bool generate_entries_file(SymbolTable* table, char* path);
+bool generate_entries_file(SymbolTable* table, char* path, FileStore* store, debugList* dbg_list);
 
 /**
 @brief Creates output files based on the given memory buffer, path, final program status, and symbol table.
@@ -83,8 +95,12 @@ bool generate_entries_file(SymbolTable* table, char* path);
 @param path Path to the file without the extension
 @param finalStatus Pointer to a programFinalStatus struct to update the status of the program's output files
 @param table Pointer to a SymbolTable struct representing the symbol table of the program
+@param format The encoding of the object file
+@param store The files of the assembly, the files are written to it
+@param dbg_list The debug list the files that can't be written are reported to
+@return TRUE if all the files were written, FALSE otherwise
 */
-void create_files(memoryBuffer* memory, char* path, programFinalStatus* finalStatus, SymbolTable* table);
+bool create_files(memoryBuffer* memory, char* path, programFinalStatus* finalStatus, SymbolTable* table, ObjectFormat format, FileStore* store, debugList* dbg_list);
 
 /**
  * @brief Sets the dot_extern_exists flag in the given flags struct to TRUE.
@@ -114,8 +130,9 @@ void extract_directive_type(LineIterator* line, flags* flag);
 @param dbg_list a pointer to the debug list, which prints the error after program stops
 @param errorFlag turns true in case when error found, so files won't be created
 @param line_num used to indicates the line where error has been occured
+@param pending the lines whose label operands are resolved after all the lines were read, the line is added to it if it has labels
 */
-void execute_line(LineIterator* it, SymbolTable* table, memoryBuffer* memory, bool* errorFlag, long line_num);
+void execute_line(LineIterator* it, SymbolTable* table, memoryBuffer* memory, bool* errorFlag, long line_num, PendingOperands* pending, debugList* dbg_list);
 
 /**
 @brief Counts the amount of lines without any labels, which are needed to be skiped, and updates the original memory
@@ -139,7 +156,7 @@ int find_amount_of_lines_to_skip(LineIterator* it);
 @param line_num The number of the line being checked.
 @return True if the label exists and is defined in the symbol table, false otherwise.
 */
-bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag, long line_num);
+bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag, long line_num, debugList* dbg_list);
 
 /**
 
@@ -151,7 +168,7 @@ bool is_label_exists_in_line(LineIterator* line, SymbolTable* table, bool* flag,
 @param line_num The current line number.
 @return A boolean indicating if a label exists in the given line.
 */
-bool investigate_word(LineIterator* originalLine, LineIterator* wordIterator, SymbolTable* table, bool* flag, long line_num, char* wordToInvestigate, int amoutOfVars);
+bool investigate_word(LineIterator* originalLine, LineIterator* wordIterator, SymbolTable* table, bool* flag, long line_num, char* wordToInvestigate, int amoutOfVars, debugList* dbg_list);
 
 /**
 
@@ -194,15 +211,6 @@ This is used in assembly programming to set the base address of the program's me
 */
 void add_label_base_address(SymbolTable* table);
 
-/**
-@brief Decodes memory so it would be suitable for printing to the object file.
-@param tmd Pointer to the translated memory structure contains the memory suitable for printing
-@param inst pointer to the memory used during the program
-@param startPos starting position of the memory at the start of func
-@param endPos ending position of the memory counter during the end of func
-*/
-void decode_memory(TranslatedMachineData* tmd, imageMemory* inst, int* startPos, int endPos);
-
 /**
 
 @brief Extracts the variables from the current line of assembly code.
@@ -102,429 +102,287 @@ Opcodes get_opcode(char* str)
 }
 
 
-bool validate_syntax(LineIterator it, firstPassStates state, long line)
+/* The tokens of the line that is validated, the validators walk them from the mnemonic or the directive on. */
+typedef struct
 {
-    switch (state) {
-    case FP_SYM_DEF:
-    case FP_OPCODE: return validate_syntax_opcode(&it, line);
-    case FP_SYM_DATA: return validate_syntax_data(&it, line);
-    case FP_SYM_STR: return validate_syntax_string(&it, line);
-    case FP_SYM_ENT:
-    case FP_SYM_EXT: return validate_syntax_extern_and_entry(&it, line);
-    default: break;
-    }
-
-    return TRUE;
+    Token* tokens;
+    int count;
+    int current; /* The index of the next token to match. */
+    char* line_start; /* The columns of the diagnostics are the offsets of the tokens from the start of the line. */
+} SyntaxCursor;
+
+/* The token 'offset' tokens after the next one, NULL past the end of the line. */
+static Token* cursor_peek(SyntaxCursor* cur, int offset)
+{
+    return (cur->current + offset < cur->count) ? &cur->tokens[cur->current + offset] : NULL;
 }
 
-bool validate_syntax_string(LineIterator* it, long line)
+/* Where the next token starts, the end of the last token if the line ended. */
+static char* cursor_position(SyntaxCursor* cur)
 {
-    char* closeQuote = strrchr(it->start, QUOTE_CHAR);
-
-    /* Consume all preceding blanks */
-    line_iterator_consume_blanks(it);
+    Token* last = &cur->tokens[cur->count - 1];
+    return (cur->current < cur->count) ? cur->tokens[cur->current].start : last->start + last->length;
+}
 
-    /* Next char of a valid string must be '"' */
-    if (line_iterator_peek(it) != QUOTE_CHAR) {
-        print_error(it->start, line, ERROR_CODE_MISSING_OPEN_QUOTES);
-        return FALSE;
-    }
+static bool is_punctuation(Token* token, char punctuation)
+{
+    return (token && token->type == TOKEN_PUNCTUATION && token->value == punctuation) ? TRUE : FALSE;
+}
 
-    /* Consume quotes*/
-    line_iterator_advance(it);
+/* Registers the error at the given position of the line, always returns FALSE. */
+static bool report_syntax_error(SyntaxCursor* cur, char* err_pos, long line, errorCodes err_code, debugList* dbg_list)
+{
+    debug_list_register_node(dbg_list, cur->line_start, err_pos, line, err_code);
+    return FALSE;
+}
 
-    /* Iterate until closing quote */
-    while (!line_iterator_is_end(it) && it->current < closeQuote) {
-        line_iterator_advance(it);
-    }
+/* A label starts with a letter and the rest of its chars are letters or digits, the lexer already told the opcodes and the registers apart. */
+static bool is_label_token(Token* token)
+{
+    int i;
 
-    /* Check closing quotes */
-    if (line_iterator_peek(it) != QUOTE_CHAR) {
-        print_error(it->start, line, ERROR_CODE_MISSING_CLOSE_QUOTES);
+    if (token->type != TOKEN_IDENTIFIER || !isalpha((unsigned char)*token->start))
         return FALSE;
-    }
-
-    /* Consume quotes*/
-    line_iterator_advance(it);
 
-    /* Consume all blanks */
-    line_iterator_consume_blanks(it);
-
-    if (!line_iterator_is_end(it)) {
-        print_error(it->start, line, ERROR_CODE_TEXT_AFTER_END);
-        return FALSE;
+    for (i = 1; i < token->length; i++) {
+        if (!isalnum((unsigned char)token->start[i]))
+            return FALSE;
     }
 
     return TRUE;
 }
 
-bool validate_syntax_data(LineIterator* it, long line)
+/* Matches the next token as an operand of one of the kinds in 'flags', a punctuation or a string can't be an operand. */
+static bool match_operand(SyntaxCursor* cur, long line, int flags, debugList* dbg_list)
 {
-    bool is_valid = TRUE;
-
-    /* Consume blanks */
-    line_iterator_consume_blanks(it);
+    Token* token = cursor_peek(cur, 0);
+    errorCodes err_code = ERROR_CODE_OK;
+    char* err_pos = cursor_position(cur);
+    int value;
 
-    /* Routine to check digit list */
-    while (!line_iterator_is_end(it) && is_valid) {
-        line_iterator_consume_blanks(it);
-        is_valid = verify_int(it, line, COMMA_STRING);
-        /* Will jump to the closest comma and consume it. */
-        line_iterator_jump_to(it, COMMA_CHAR);
+    if (!token) {
+        err_code = ERROR_CODE_INVALID_OPERAND;
     }
-
-    if (!is_valid) {
-        return FALSE;
+    /* Check if immediate number, +1 to skip the '#' */
+    else if (token->type == TOKEN_IMMEDIATE && *token->start == HASH_CHAR && (flags & FLAG_NUMBER)) {
+        err_code = scan_int(token->start + 1, NUMBER_SEPS_STRING, IMMEDIATE_BITS, &value, &err_pos);
     }
-
-    /* Go backwards */
-    while (isspace(line_iterator_peek(it)) || line_iterator_peek(it) == BACKSLASH_ZERO) {
-        line_iterator_backwards(it);
+    /* Check if register */
+    else if (token->type == TOKEN_REGISTER && (flags & FLAG_REGISTER)) {
+        err_code = ERROR_CODE_OK;
     }
-
-    /* Check last char.*/
-    if (!isdigit(line_iterator_peek(it))) {
-        print_error(it->start, line, ERROR_CODE_TEXT_AFTER_END);
-        return FALSE;
+    /* Check if label name, an opcode or a register is a reserved word */
+    else if ((token->type == TOKEN_IDENTIFIER || token->type == TOKEN_MNEMONIC || token->type == TOKEN_REGISTER) && (flags & FLAG_LABEL)) {
+        err_code = is_label_token(token) ? ERROR_CODE_OK : ERROR_CODE_INVALID_NAME;
     }
+    else {
+        err_code = ERROR_CODE_INVALID_OPERAND;
+    }
+
+    if (err_code != ERROR_CODE_OK)
+        return report_syntax_error(cur, err_pos, line, err_code, dbg_list);
 
+    cur->current++;
     return TRUE;
 }
 
-bool validate_syntax_extern_and_entry(LineIterator* it, long line)
+/* Matches the comma between two operands. */
+static bool match_comma(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    line_iterator_consume_blanks(it);
+    Token* token = cursor_peek(cur, 0);
 
-    if (!line_iterator_is_end(it)) {
-        print_error(it->start, it->current, line, ERROR_CODE_TEXT_AFTER_END);
-        return FALSE;
-    }
+    if (!is_punctuation(token, COMMA_CHAR))
+        return report_syntax_error(cur, cursor_position(cur), line, token ? ERROR_CODE_MISSING_COMMA : ERROR_CODE_INVALID_OPERAND, dbg_list);
 
+    cur->current++;
     return TRUE;
 }
 
-bool validate_syntax_opcode(LineIterator* it, long line)
+static bool match_syntax_group_1_2(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    char* word = NULL;
-    char* errLocation = it->current;
-
-    /* typedef for the dispatch table. */
-    typedef bool (*dispatch_table)(LineIterator* it, long line);
-    dispatch_table table[SG_TOTAL] = {
-        match_syntax_group_1_2, match_syntax_group_1_2, match_syntax_group_3, match_syntax_group_4,
-        match_syntax_group_5, match_syntax_group_6, match_syntax_group_7
-    };
-
-    if ((word = line_iterator_next_word(it, SPACE_STRING)) != NULL) {
-        SyntaxGroups sg = get_syntax_group(word);
-
-        /* Check if the syntax ground is valid, if not register an error, otherwise execute the appropriate handler. */
-        if (sg == SG_GROUP_INVALID) {
-            free(word);
-            print_error(it->start, errLocation, line, ERROR_CODE_LABEL_MISSING_OR_NON_EXISTS_OPCODE);
-            return FALSE;
-        }
+    return match_operand(cur, line, FLAG_NUMBER | FLAG_REGISTER | FLAG_LABEL, dbg_list)
+        && match_comma(cur, line, dbg_list)
+        && match_operand(cur, line, FLAG_NUMBER | FLAG_REGISTER | FLAG_LABEL, dbg_list);
+}
 
-        free(word);
-        return table[sg](it, line);
-    }
+static bool match_syntax_group_3(SyntaxCursor* cur, long line, debugList* dbg_list)
+{
+    return match_operand(cur, line, FLAG_REGISTER | FLAG_LABEL, dbg_list);
+}
 
+static bool match_syntax_group_4(SyntaxCursor* cur, long line, debugList* dbg_list)
+{
+    /* rts and stop don't get any operand, the tokens that follow are reported by the caller. */
     return TRUE;
 }
 
-bool match_operands_for_sg_1_2(LineIterator* it, long line)
+static bool match_syntax_group_5(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    line_iterator_consume_blanks(it);
+    Token* label = cursor_peek(cur, 0);
+    int i, first = cur->current;
 
-    /* Check if immediate number */
-    if (line_iterator_peek(it) == HASH_CHAR) {
-        if (!match_operand(it, line, FLAG_NUMBER))
-            return FALSE;
-    }
-    /* Check if register */
-    else if (line_iterator_peek(it) == REG_BEG_CHAR) {
-        if (!match_operand(it, line, FLAG_REGISTER))
-            return FALSE;
-    }
-    /* Check if label name */
-    else if (isalpha(line_iterator_peek(it))) {
-        if (!match_operand(it, line, FLAG_LABEL))
-            return FALSE;
-    }
-    else {
-        print_error(it->start, line, ERROR_CODE_INVALID_OPERAND);
-        return FALSE;
-    }
+    /* A label without parameters. */
+    if (!label || !is_punctuation(cursor_peek(cur, 1), OPEN_PAREN_CHAR))
+        return match_operand(cur, line, FLAG_LABEL, dbg_list);
 
-    return TRUE;
-}
+    if (label->type == TOKEN_REGISTER)
+        return report_syntax_error(cur, label->start, line, ERROR_CODE_RESERVED_KEYWORD_DEF, dbg_list);
+    if (!is_label_token(label))
+        return report_syntax_error(cur, label->start, line, ERROR_CODE_INVALID_LABEL_DEF, dbg_list);
 
-bool match_syntax_group_1_2(LineIterator* it, long line)
-{
-    if (!match_operands_for_sg_1_2(it, line))
+    /* The label and the '(' */
+    cur->current += 2;
+
+    /* The label takes exactly two parameters. */
+    if (!match_operand(cur, line, FLAG_NUMBER | FLAG_REGISTER | FLAG_LABEL, dbg_list))
         return FALSE;
-    if (!match_operands_for_sg_1_2(it, line))
+    if (is_punctuation(cursor_peek(cur, 0), CLOSE_PAREN_CHAR))
+        return report_syntax_error(cur, cursor_position(cur), line, ERROR_CODE_MISSING_OPERAND, dbg_list);
+    if (!match_comma(cur, line, dbg_list) || !match_operand(cur, line, FLAG_NUMBER | FLAG_REGISTER | FLAG_LABEL, dbg_list))
         return FALSE;
 
-    return TRUE;
-}
-
-bool match_syntax_group_3(LineIterator* it, long line)
-{
-    line_iterator_consume_blanks(it);
+    if (!is_punctuation(cursor_peek(cur, 0), CLOSE_PAREN_CHAR))
+        return report_syntax_error(cur, cursor_position(cur), line, is_punctuation(cursor_peek(cur, 0), COMMA_CHAR) ? ERROR_CODE_TO_MANY_OPERANDS : ERROR_CODE_SYNTAX_ERROR, dbg_list);
+    cur->current++;
 
-    /* Check if register */
-    if (line_iterator_peek(it) == REG_BEG_CHAR) {
-        if (!match_operand(it, line, FLAG_REGISTER))
-            return FALSE;
-    }
-    /* Check if label name */
-    else if (isalpha(line_iterator_peek(it))) {
-        if (!match_operand(it, line, FLAG_LABEL))
-            return FALSE;
-    }
-    else {
-        print_error(it->start, line, ERROR_CODE_INVALID_OPERAND);
-        return FALSE;
+    /* The label and its parameters are a single operand, there can't be blanks between their tokens. */
+    for (i = first + 1; i < cur->current; i++) {
+        if (cur->tokens[i].start != cur->tokens[i - 1].start + cur->tokens[i - 1].length)
+            return report_syntax_error(cur, cur->tokens[i - 1].start + cur->tokens[i - 1].length, line, ERROR_CODE_INVALID_WHITE_SPACE, dbg_list);
     }
 
     return TRUE;
 }
 
-bool match_syntax_group_4(LineIterator* it, long line)
+static bool match_syntax_group_6(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    /* Check that they dont get any operand. */
-    char* op = line_iterator_next_word(it, SPACE_STRING);
-
-    if (op != NULL) {
-        free(op);
-        print_error(it->start, line, ERROR_CODE_INVALID_OPERAND);
-        return FALSE;
-    }
-
-    free(op);
-    return TRUE;
+    return match_operand(cur, line, FLAG_NUMBER | FLAG_REGISTER | FLAG_LABEL, dbg_list);
 }
 
-bool match_syntax_group_5(LineIterator* it, long line)
+static bool match_syntax_group_7(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    char* open_paren_loc = strchr(it->current, OPEN_PAREN_CHAR);
+    return match_operand(cur, line, FLAG_LABEL, dbg_list)
+        && match_comma(cur, line, dbg_list)
+        && match_operand(cur, line, FLAG_REGISTER | FLAG_LABEL, dbg_list);
+}
 
-    line_iterator_consume_blanks(it);
+static bool validate_syntax_opcode(SyntaxCursor* cur, long line, debugList* dbg_list)
+{
+    Token* token = cursor_peek(cur, 0);
 
-    /* Check if label name */
-    if (!open_paren_loc && isalpha(line_iterator_peek(it))) {
-        if (!match_operand(it, line, FLAG_LABEL))
-            return FALSE;
-    }
-    else if (open_paren_loc) {
-        if (line_iterator_peek(it) == REG_BEG_CHAR) {
-            if (is_register_name(it)) {
-                print_error(it->start, line, ERROR_CODE_RESERVED_KEYWORD_DEF);
-                return FALSE;
-            }
-            line_iterator_backwards(it);
-        }
-        if (!is_label_name(it)) {
-            print_error(it->start, it->current, line, ERROR_CODE_INVALID_LABEL_DEF);
-            return FALSE;
-        }
+    /* typedef for the dispatch table. */
+    typedef bool (*dispatch_table)(SyntaxCursor* cur, long line, debugList* dbg_list);
+    dispatch_table table[SG_TOTAL] = {
+        match_syntax_group_1_2, match_syntax_group_1_2, match_syntax_group_3, match_syntax_group_4,
+        match_syntax_group_5, match_syntax_group_6, match_syntax_group_7
+    };
 
-        line_iterator_jump_to(it, '(');
+    /* A label definition must be followed by an opcode. */
+    if (token->type != TOKEN_MNEMONIC)
+        return report_syntax_error(cur, token->start, line, ERROR_CODE_LABEL_MISSING_OR_NON_EXISTS_OPCODE, dbg_list);
 
-        if (!match_operand(it, line, FLAG_PARAM_LABEL)) {
-            return FALSE;
-        }
-    }
-    else {
-        print_error(it->start, line, ERROR_CODE_INVALID_OPERAND);
+    cur->current++;
+    if (!table[get_opcode_syntax_group((Opcodes)token->value)](cur, line, dbg_list))
         return FALSE;
+
+    /* Every token of the line must belong to an operand. */
+    if ((token = cursor_peek(cur, 0)) != NULL) {
+        return report_syntax_error(cur, token->start, line, (is_punctuation(token, OPEN_PAREN_CHAR) || is_punctuation(token, CLOSE_PAREN_CHAR)) ? ERROR_CODE_EXTRA_PAREN : ERROR_CODE_TO_MANY_OPERANDS, dbg_list);
     }
 
     return TRUE;
 }
 
-bool match_syntax_group_6(LineIterator* it, long line)
+static bool validate_syntax_data(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    line_iterator_consume_blanks(it);
+    Token* token = NULL;
+    errorCodes err_code;
+    char* end = NULL;
+    int value;
 
-    /* Check if immediate number */
-    if (line_iterator_peek(it) == HASH_CHAR) {
-        if (!match_operand(it, line, FLAG_NUMBER))
-            return FALSE;
-    }
-    /* Check if register */
-    else if (line_iterator_peek(it) == REG_BEG_CHAR) {
-        if (!match_operand(it, line, FLAG_REGISTER))
-            return FALSE;
-    }
-    /* Check if label name */
-    else if (isalpha(line_iterator_peek(it))) {
-        if (!match_operand(it, line, FLAG_LABEL))
-            return FALSE;
-    }
-    else {
-        print_error(it->start, it->current, line, ERROR_CODE_INVALID_OPERAND);
-        return FALSE;
+    /* Skip the directive. */
+    cur->current++;
+
+    if (!cursor_peek(cur, 0))
+        return report_syntax_error(cur, cursor_position(cur), line, ERROR_CODE_MISSING_OPERAND, dbg_list);
+
+    /* Routine to check the list of integers, separated by single commas. */
+    while ((token = cursor_peek(cur, 0)) != NULL) {
+        if (is_punctuation(token, COMMA_CHAR))
+            return report_syntax_error(cur, token->start, line, ERROR_CODE_EXTRA_COMMA, dbg_list);
+        if (token->type != TOKEN_IMMEDIATE)
+            return report_syntax_error(cur, token->start, line, ERROR_CODE_INVALID_INT, dbg_list);
+        if ((err_code = scan_int(token->start, NUMBER_SEPS_STRING, DATA_WORD_BITS, &value, &end)) != ERROR_CODE_OK)
+            return report_syntax_error(cur, end, line, err_code, dbg_list);
+
+        cur->current++;
+        if ((token = cursor_peek(cur, 0)) == NULL)
+            break;
+
+        if (!is_punctuation(token, COMMA_CHAR))
+            return report_syntax_error(cur, token->start, line, ERROR_CODE_MISSING_COMMA, dbg_list);
+
+        /* A comma must be followed by another integer. */
+        cur->current++;
+        if (!cursor_peek(cur, 0))
+            return report_syntax_error(cur, token->start, line, ERROR_CODE_TEXT_AFTER_END, dbg_list);
     }
 
     return TRUE;
 }
 
-bool match_syntax_group_7(LineIterator* it, long line)
+static bool validate_syntax_string(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    line_iterator_consume_blanks(it);
-
-    /************************* Match operand 1 ****************************/
+    Token* token = NULL;
 
-    if (isalpha(line_iterator_peek(it))) {
-        if (!match_operand(it, line, FLAG_LABEL))
-            return FALSE;
-    }
-    else {
-        print_error(it->start, line, ERROR_CODE_INVALID_OPERAND);
-        return FALSE;
-    }
+    /* Skip the directive. */
+    cur->current++;
+    token = cursor_peek(cur, 0);
 
-    line_iterator_consume_blanks(it);
+    /* The lexer makes a single token of the text between the first and the last quotes. */
+    if (!token || token->type != TOKEN_STRING)
+        return report_syntax_error(cur, cursor_position(cur), line, ERROR_CODE_MISSING_OPEN_QUOTES, dbg_list);
 
-    /************************* Match operand 2 ****************************/
+    if (token->length < 2 || token->start[token->length - 1] != QUOTE_CHAR)
+        return report_syntax_error(cur, token->start, line, ERROR_CODE_MISSING_CLOSE_QUOTES, dbg_list);
 
-    /* Check if register */
-    if (line_iterator_peek(it) == REG_BEG_CHAR) {
-        if (!match_operand(it, line, FLAG_REGISTER))
-            return FALSE;
-    }
-    /* Check if label name */
-    else if (isalpha(line_iterator_peek(it))) {
-        if (!match_operand(it, line, FLAG_LABEL))
-            return FALSE;
-    }
-    else {
-        print_error(it->start, it->current, line, ERROR_CODE_INVALID_OPERAND);
-        return FALSE;
-    }
+    cur->current++;
+    if ((token = cursor_peek(cur, 0)) != NULL)
+        return report_syntax_error(cur, token->start, line, ERROR_CODE_TEXT_AFTER_END, dbg_list);
 
     return TRUE;
 }
 
-bool match_operand(LineIterator* it, long line, int flags)
+static bool validate_syntax_extern_and_entry(SyntaxCursor* cur, long line, debugList* dbg_list)
 {
-    switch (flags) {
-    case FLAG_LABEL:
-        if (!is_label_name(it)) {
-            print_error(it->start, it->current, line, ERROR_CODE_INVALID_NAME);
-            return FALSE;
-        }
-        break;
-    case FLAG_NUMBER:
-        /* Consume the '#' */
-        line_iterator_advance(it);
-        if (!verify_int(it, line, ", ")) {
-            return FALSE;
-        }
-        break;
-    case FLAG_REGISTER:
-        if (is_register_name_heuristic(*it)) {
-            if (!is_register_name(it)) {
-                print_error(it->start, line, ERROR_CODE_INVALID_NAME);
-                return FALSE;
-            }
-            /* Consume the number. */
-            line_iterator_advance(it);
-        }
-        break;
-    case FLAG_PARAM_LABEL:
-        if (!match_pamaetrized_label(it, line)) {
-            return FALSE;
-        }
-        break;
-    default:
-        break;
-    }
+    Token* token = NULL;
+
+    /* Skip the directive and the name, the name is checked against the symbols by the first pass. */
+    cur->current += 2;
 
-    /* Comsume comma */
-    line_iterator_jump_to(it, COMMA_CHAR);
+    if ((token = cursor_peek(cur, 0)) != NULL)
+        return report_syntax_error(cur, token->start, line, ERROR_CODE_TEXT_AFTER_END, dbg_list);
 
     return TRUE;
 }
 
-bool match_pamaetrized_label(LineIterator* it, long line)
+bool validate_syntax(Token* tokens, int count, firstPassStates state, char* line_start, long line, debugList* dbg_list)
 {
-    int comma_counter = 0, close_paren_counter = 0, args_count = 0;
-
-    while (!line_iterator_is_end(it) && line_iterator_peek(it) != CLOSE_PAREN_CHAR) {
-        if (line_iterator_peek(it) == HASH_CHAR) {
-            line_iterator_advance(it);
-            if (!verify_int(it, line, ",)")) {
-                return FALSE;
-            }
-            args_count++;
-        }
-        else if (isalpha(line_iterator_peek(it))) {
-            if (line_iterator_peek(it) == REG_BEG_CHAR) {
-                if (!is_register_name(it)) {
-                    return FALSE;
-                }
-                /* Consume the digit. */
-                line_iterator_advance(it);
-                args_count++;
-            }
-            else {
-                if (!is_label_name(it)) {
-                    return FALSE;
-                }
-                args_count++;
-            }
-        }
-        else if (line_iterator_peek(it) == COMMA_CHAR && comma_counter < 1) {
-            line_iterator_advance(it);
-            comma_counter++;
-        }
-        else {
-            if (line_iterator_peek(it) == COMMA_CHAR && comma_counter > 1) {
-                print_error(it->start, it->current, line, ERROR_CODE_EXTRA_COMMA);
-                return FALSE;
-            }
-            else if (!isalpha(line_iterator_peek(it))) {
-                print_error(it->start, it->current, line, ERROR_CODE_INVALID_OPERAND);
-                return FALSE;
-            }
-            else if (isspace(line_iterator_peek(it))) {
-                print_error(it->start, it->current, line, ERROR_CODE_INVALID_WHITE_SPACE);
-                return FALSE;
-            }
-            else if (line_iterator_peek(it) == COMMA_CHAR) {
-                print_error(it->start, it->current, line, ERROR_CODE_EXTRA_COMMA);
-                return FALSE;
-            }
-            else if (line_iterator_peek(it) == CLOSE_PAREN_CHAR || line_iterator_peek(it) == OPEN_PAREN_CHAR) {
-                print_error(it->start, it->current, line, ERROR_CODE_EXTRA_PAREN);
-                return FALSE;
-            }
-        }
-    }
-
-    if (args_count != 2) {
-        print_error(it->start, it->current, line, ERROR_CODE_MISSING_OPERAND);
-        return FALSE;
-    }
+    SyntaxCursor cur;
 
-    while (!line_iterator_is_end(it)) {
-        if (line_iterator_peek(it) == CLOSE_PAREN_CHAR) {
-            close_paren_counter++;
-        }
-        if (!line_iterator_match_any(it, " )")) {
-            print_error(it->start, it->current, line, ERROR_CODE_TEXT_AFTER_END);
-            return FALSE;
-        }
-
-        line_iterator_advance(it);
-    }
+    cur.tokens = tokens;
+    cur.count = count;
+    cur.current = 0;
+    cur.line_start = line_start;
 
-    if (close_paren_counter > 1) {
-        print_error(it->start, it->current, line, ERROR_CODE_EXTRA_PAREN);
-        return FALSE;
+    switch (state) {
+    case FP_SYM_DEF:
+    case FP_OPCODE: return validate_syntax_opcode(&cur, line, dbg_list);
+    case FP_SYM_DATA: return validate_syntax_data(&cur, line, dbg_list);
+    case FP_SYM_STR: return validate_syntax_string(&cur, line, dbg_list);
+    case FP_SYM_ENT:
+    case FP_SYM_EXT: return validate_syntax_extern_and_entry(&cur, line, dbg_list);
+    default: break;
     }
 
     return TRUE;
@@ -571,23 +429,6 @@ bool validate_label_ending(LineIterator* it)
     return line_iterator_is_end(it);
 }
 
-bool is_register_name_heuristic(LineIterator it)
-{
-    int len = 0;
-    while (!line_iterator_is_end(&it) && line_iterator_peek(&it) != COMMA_CHAR && line_iterator_peek(&it) != CLOSE_PAREN_CHAR) {
-        len++;
-        line_iterator_advance(&it);
-    }
-    return len == 2;
-}
-
-bool is_register_name(LineIterator* it)
-{
-    /* Skip the 'r' */
-    line_iterator_advance(it);
-    return REG_MIN_NUM <= line_iterator_peek(it) && line_iterator_peek(it) <= REG_MAX_NUM;
-}
-
 bool is_register_name_whole(LineIterator* it)
 {
     bool charFlag = FALSE;
@@ -601,54 +442,65 @@ bool is_register_name_whole(LineIterator* it)
 }
 
 
-bool verify_int(LineIterator* it, long line, char* seps)
+errorCodes scan_int(char* str, char* seps, int bits, int* out, char** end)
 {
-    if (line_iterator_peek(it) == NEG_SIGN_CHAR || line_iterator_peek(it) == POS_SIGN_CHAR) {
-        line_iterator_advance(it);
-    }
-    else if (line_iterator_peek(it) == COMMA_CHAR) {
-        print_error(it->start, it->current, line, ERROR_CODE_EXTRA_COMMA);
-        return FALSE;
+    long limit = 1L << (bits - 1), value = 0;
+    char* num_start = str;
+    bool negative = FALSE, overflow = FALSE;
+    int digits = 0;
+
+    *end = str;
+
+    if (*str == NEG_SIGN_CHAR || *str == POS_SIGN_CHAR) {
+        negative = (*str == NEG_SIGN_CHAR) ? TRUE : FALSE;
+        str++;
     }
-    else if (!isdigit(line_iterator_peek(it))) {
-        print_error(it->start, it->current, line, ERROR_CODE_INVALID_INT);
-        return FALSE;
+    else if (*str == COMMA_CHAR) {
+        return ERROR_CODE_EXTRA_COMMA;
     }
 
-    while (!line_iterator_is_end(it) && !line_iterator_match_any(it, seps)) {
-        if (!isdigit(line_iterator_peek(it))) {
-            print_error(it->start, it->current, line, ERROR_CODE_INVALID_INT);
-            return FALSE;
+    /* Validate and convert in the same scan, the accumulation stops once the value is out of range. */
+    for (; *str && !strchr(seps, *str); str++, digits++) {
+        if (!isdigit((unsigned char)*str)) {
+            *end = str;
+            return ERROR_CODE_INVALID_INT;
         }
-        line_iterator_advance(it);
+        if (!overflow && (value = value * 10 + (*str - '0')) > limit)
+            overflow = TRUE;
     }
 
-    return TRUE;
+    *end = str;
+
+    if (digits == 0)
+        return ERROR_CODE_INVALID_INT;
+
+    /* A two's complement field of 'bits' bits holds -2^(bits-1) up to 2^(bits-1)-1. */
+    if (overflow || value > (negative ? limit : limit - 1)) {
+        *end = num_start;
+        return (bits == IMMEDIATE_BITS) ? ERROR_CODE_IMMEDIATE_OUT_OF_RANGE : ERROR_CODE_DATA_OUT_OF_RANGE;
+    }
+
+    *out = (int)(negative ? -value : value);
+    return ERROR_CODE_OK;
 }
 
+SyntaxGroups get_opcode_syntax_group(Opcodes op)
+{
+    switch (op) {
+    case OP_MOV: case OP_ADD: case OP_SUB: return SG_GROUP_1;
+    case OP_CMP: return SG_GROUP_2;
+    case OP_NOT: case OP_CLR: case OP_INC: case OP_DEC: case OP_RED: return SG_GROUP_3;
+    case OP_RTS: case OP_STOP: return SG_GROUP_4;
+    case OP_JMP: case OP_BNE: case OP_JSR: return SG_GROUP_5;
+    case OP_PRN: return SG_GROUP_6;
+    case OP_LEA: return SG_GROUP_7;
+    default: return SG_GROUP_INVALID;
+    }
+}
 
 SyntaxGroups get_syntax_group(char* name)
 {
-    if (!name)
-        return SG_GROUP_INVALID;
-
-    if (strcmp(name, "mov") == 0 || strcmp(name, "add") == 0 || strcmp(name, "sub") == 0)
-        return SG_GROUP_1;
-    if (strcmp(name, "cmp") == 0)
-        return SG_GROUP_2;
-    if (strcmp(name, "not") == 0 || strcmp(name, "clr") == 0 || strcmp(name, "inc") == 0 ||
-        strcmp(name, "dec") == 0 || strcmp(name, "red") == 0)
-        return SG_GROUP_3;
-    if (strcmp(name, "rts") == 0 || strcmp(name, "stop") == 0)
-        return SG_GROUP_4;
-    if (strcmp(name, "jmp") == 0 || strcmp(name, "bne") == 0 || strcmp(name, "jsr") == 0)
-        return SG_GROUP_5;
-    if (strcmp(name, "prn") == 0)
-        return SG_GROUP_6;
-    if (strcmp(name, "lea") == 0)
-        return SG_GROUP_7;
-
-    return SG_GROUP_INVALID;
+    return get_opcode_syntax_group(get_opcode(name));
 }
 
 bool directive_exists(LineIterator* line) {
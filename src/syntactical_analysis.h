@@ -49,7 +49,6 @@ typedef enum
 #define FLAG_NUMBER      1
 #define FLAG_LABEL       2
 #define FLAG_REGISTER    4
-#define FLAG_PARAM_LABEL 8
 
 /**
 * @brief Get opcode from string. This is used to parse opcodes that are passed to libc functions.
@@ -128,155 +127,31 @@ void trim_symbol_name(char* sym);
 bool is_reserved_word(char* name);
 
 /**
-* @brief Validate the syntax at the current position. This is a wrapper around validate_syntax_opcode () validate_syntax_data () and validate_syntax_string () to allow custom code to be added to the debugList
+* @brief Validate the syntax of the tokens of a line, the validators walk the tokens and report the columns of the tokens that break the syntax.
 *
-* @param it - Iterator over the line to be validated
-* @param state - The first pass state of the syntax
+* @param tokens - The tokens of the line past its label definition, the first one is the mnemonic or the directive
+* @param count - The amount of tokens, at least one
+* @param state - The first pass state of the line
+* @param line_start - The start of the line the tokens point into
 * @param line - The line number at which the syntax is being validated
 * @param dbg_list - The list of debuggers to which warnings / errors are added
 *
-* @return TRUE if the syntax is valid FALSE if it is
+* @return TRUE if the syntax is valid FALSE if it isn't
 */
-bool validate_syntax(LineIterator it, firstPassStates state, long line);
+bool validate_syntax(Token* tokens, int count, firstPassStates state, char* line_start, long line, debugList* dbg_list);
 
 /**
-* @brief Validate a syntax opcode. This is a helper function for validate_opcode ().
+* @brief Validates, converts and range checks an integer in a single scan, i.e '-5' or '+12' or '7'.
 *
-* @param it
-* @param line - Line number on which the parser was started.
-* @param dbg_list - Debug list to add warnings / errors to.
-*
-* @return true if the opcode is valid false otherwise. Note that it is up to the caller to free it
-*/
-bool validate_syntax_opcode(LineIterator* it, long line);
-
-/**
-* @brief Verifies that the next character is a valid integer. This is done by examining the characters that begin with a digit followed by a comma or a comma and verifying that it is a valid integer.
-*
-* @param it
-* @param line - Line in which the string was read. Used for error reporting.
-* @param seps - String of digits to be checked for validity.
-* @param dbg_list - Debug list to be populated with nodes.
-*
-* @return TRUE if the integer is valid FALSE otherwise. On failure the iterator is left pointing at the character that failed
-*/
-bool verify_int(LineIterator* it, long line, char* seps);
-
-/**
-* @brief This function reduce repetative code in the match_syntax_group_1 and match_syntax_group_2 functions.
-* It checks if their operands are valid.
-* @return True if valid, false otherwise.
-*/
-bool match_operands_for_sg_1_2(LineIterator* it, long line);
-
-/**
-* @brief Matches a syntax group 1 & 2. This is the first part of the syntax group : it must be at the start of a variable or variable declaration.
-*
-* @param it
-* @param line - The current line number being matched. Used for error reporting.
-* @param dbg_list - The debug list to add debug nodes to.
-*
-* @return TRUE if a match was found FALSE otherwise. The match is terminated by a newline
-*/
-bool match_syntax_group_1_2(LineIterator* it, long line);
-
-/**
-* @brief Matches a syntax group 3. This is the third part of the syntax group matching algorithm.
-*
-* @param it
-* @param line - Line number being matched. Used for error reporting.
-* @param dbg_list - Debug list for the matched nodes.
+* @param str - The first char of the integer (its sign or its first digit).
+* @param seps - The chars that end the integer, the end of the line ends it as well.
+* @param bits - The width of the two's complement field the value must fit in, IMMEDIATE_BITS or DATA_WORD_BITS.
+* @param out - Receives the value, only written on success.
+* @param end - Receives the char that ended the scan, on failure the offending char (or the start of the integer if it's out of range).
 *
-* @return TRUE if a match was found FALSE otherwise. When false the iterator is left pointing at the character immediately following the end of the syntax group
+* @return ERROR_CODE_OK on success, otherwise ERROR_CODE_EXTRA_COMMA, ERROR_CODE_INVALID_INT, ERROR_CODE_IMMEDIATE_OUT_OF_RANGE or ERROR_CODE_DATA_OUT_OF_RANGE
 */
-bool match_syntax_group_3(LineIterator* it, long line);
-
-/**
-* @brief Matches a syntax group 4. This is used to check if there is a'%'followed by an operand.
-*
-* @param it
-* @param line - Line number where the token begins. This is used for reporting errors.
-* @param dbg_list - Debug list to add matched nodes to.
-*
-* @return TRUE if a match was found FALSE otherwise. If FALSE is returned the iterator is not advanced
-*/
-bool match_syntax_group_4(LineIterator* it, long line);
-
-/**
-* @brief Matches a syntax group 5 starting at the current position. This is used to implement the syntax group 5 ( and below ) as well as the syntax group 5 ( and below ).
-*
-* @param it
-* @param line - Line number of the current position
-* @param dbg_list - Debug list for the matched nodes
-*
-* @return TRUE if a match was found FALSE if not ( or an error occurred
-*/
-bool match_syntax_group_5(LineIterator* it, long line);
-
-/**
-* @brief Matches a syntax group 6 starting at the current position. This is used for variable and variable references.
-*
-* @param it
-* @param line - Line in the source file being scanned
-* @param dbg_list - Debug list for the matches.
-*
-* @return TRUE if a match was found FALSE otherwise ( an error has been reported
-*/
-bool match_syntax_group_6(LineIterator* it, long line);
-
-/**
-* @brief Matches a syntax group 7. In this case we are interested in the name of a register or a label.
-*
-* @param it
-* @param line - Line number where the syntax group starts. Used for error reporting.
-* @param dbg_list - Debug list for all matches.
-*
-* @return TRUE if a match was found FALSE otherwise. This function is called by match_syntax_group ()
-*/
-bool match_syntax_group_7(LineIterator* it, long line);
-
-/**
-* @brief Validates a syntax string.
-*
-* @param it
-* @param line - Line number of the string being validated
-* @param dbg_list - Debug list to add nodes to
-*
-* @return TRUE if the string is valid FALSE if it is isn't
-*/
-bool validate_syntax_string(LineIterator* it, long line);
-
-/**
-* @brief Validates a syntax data. 
-*
-* @param it
-* @param line - Line number of the string being validated
-* @param dbg_list - Debug list to add nodes to
-*
-* @return TRUE if the data is valid FALSE if it isn't
-*/
-bool validate_syntax_data(LineIterator* it, long line);
-
-/**
-* @brief Validates the syntax extern and entry. This is used to validate the syntax extern and entry in a macro expansion.
-*
-* @param it
-* @param line - Line number of the comment
-* @param dbg_list
-*
-* @return TRUE if there is at least one error FALSE if isn't
-*/
-bool validate_syntax_extern_and_entry(LineIterator* it, long line);
-
-
-/**
-* @brief Check if the next character is a register name.
-*
-* @param it
-*
-* @return True if the next character is a register name false otherwise
-*/
-bool is_register_name(LineIterator* it);
+errorCodes scan_int(char* str, char* seps, int bits, int* out, char** end);
 
 /**
 * @brief Validate that the iterator is at the end of a label. This is used to determine whether or not we should stop at the end of an already - processed label or not.
@@ -287,18 +162,6 @@ bool is_register_name(LineIterator* it);
 */
 bool validate_label_ending(LineIterator* it);
 
-/**
-* @brief Matches an operand and returns TRUE if it matches. This is a low - level function used by match_operand_p () and match_operand_p2 ().
-*
-* @param it
-* @param line - Line number of the operand. This is used for error reporting.
-* @param flags - Flags to match the operand with. Flags can be FLAG_LABEL FLAG_NUMBER FLAG_REAL_REG and FLAG_REG_NEAREST
-* @param dbg_list - Debug list to fill with nodes.
-*
-* @return TRUE if the operand matches FALSE otherwise. On failure the iterator is left pointing at the end of the operand
-*/
-bool match_operand(LineIterator* it, long line, int flags);
-
 /**
 * @brief Get the syntax group of a name. This is used to distinguish groups of syntaxes that are different from each other.
 *
@@ -309,24 +172,13 @@ bool match_operand(LineIterator* it, long line, int flags);
 SyntaxGroups get_syntax_group(char* name);
 
 /**
-* @brief Matches pamaetrized labels. This is a bit tricky because we don't know the number of arguments to a label.
-*
-* @param it
-* @param line - Line number where the pattern was found. Used for error reporting.
-* @param dbg_list - Debug list to add warnings to.
-*
-* @return TRUE if it succeeds FALSE otherwise. Note that it does not check for syntax errors
-*/
-bool match_pamaetrized_label(LineIterator* it, long line);
-
-/**
-* @brief Check if we are looking for a heuristics to be used in register names.
+* @brief Get the syntax group of an opcode, used when the mnemonic was already resolved by the lexer.
 *
-* @param it - Iterator on the line to check. Must be at the start of a register name.
+* @param op
 *
-* @return true if it is false otherwise. This is a heuristic
+* @return The syntax group of the opcode, @c SG_GROUP_INVALID for @c OP_UNKNOWN
 */
-bool is_register_name_heuristic(LineIterator it);
+SyntaxGroups get_opcode_syntax_group(Opcodes op);
 
 /**
 * @brief Checks if a directive exists. This is a basic check that doesn't look for ". " and it's the only way to check for it.
@@ -0,0 +1,444 @@
+/* io_uring has no libc wrappers, the rings are set up with the raw system calls. */
+#define _GNU_SOURCE
+
+#include "uring_io.h"
+
+#ifdef __linux__
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+/* The submissions of a single phase, larger batches are split. */
+#define URING_IO_ENTRIES 128
+#define URING_IO_FILE_MODE 0666
+
+struct uringIO
+{
+	int fd;
+	unsigned entries;
+	void* sq_ring;
+	size_t sq_ring_size;
+	void* cq_ring;
+	size_t cq_ring_size;
+	struct io_uring_sqe* sqes;
+	size_t sqes_size;
+	unsigned* sq_tail;
+	unsigned* sq_mask;
+	unsigned* sq_array;
+	unsigned* cq_head;
+	unsigned* cq_tail;
+	unsigned* cq_mask;
+	struct io_uring_cqe* cqes;
+	unsigned pending; /* The submissions that were prepared since the last submit. */
+	bool is_broken; /* A submit failed, the state of the rings is unknown. */
+};
+
+/* The state of a file during a batch. */
+typedef struct
+{
+	int fd;
+	int result;
+	struct statx st;
+} uringFile;
+
+static int uring_setup(unsigned entries, struct io_uring_params* params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/* The opcodes of a batch were all added in Linux 5.6, an older kernel rejects the probe or lacks some of them. */
+static bool uring_supports_batches(int fd)
+{
+	static const int opcodes[] = { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE };
+	size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+	struct io_uring_probe* probe = (struct io_uring_probe*)xcalloc(1, size);
+	bool is_supported = TRUE;
+	int i;
+
+	if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+		free(probe);
+		return FALSE;
+	}
+
+	for (i = 0; i < (int)(sizeof(opcodes) / sizeof(opcodes[0])); i++)
+		if (opcodes[i] > probe->last_op || !(probe->ops[opcodes[i]].flags & IO_URING_OP_SUPPORTED))
+			is_supported = FALSE;
+
+	free(probe);
+	return is_supported;
+}
+
+static void uring_unmap(UringIO* uring)
+{
+	if (uring->sqes != MAP_FAILED)
+		munmap(uring->sqes, uring->sqes_size);
+	if (uring->cq_ring != MAP_FAILED && uring->cq_ring != uring->sq_ring)
+		munmap(uring->cq_ring, uring->cq_ring_size);
+	if (uring->sq_ring != MAP_FAILED)
+		munmap(uring->sq_ring, uring->sq_ring_size);
+}
+
+UringIO* uring_io_new()
+{
+	UringIO* uring;
+	struct io_uring_params params;
+	char* sq;
+	char* cq;
+	int fd;
+
+	memset(&params, 0, sizeof(params));
+	if ((fd = uring_setup(URING_IO_ENTRIES, &params)) < 0)
+		return NULL;
+
+	if (!uring_supports_batches(fd)) {
+		close(fd);
+		return NULL;
+	}
+
+	uring = (UringIO*)xcalloc(1, sizeof(UringIO));
+	uring->fd = fd;
+	uring->entries = params.sq_entries;
+	uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	/* Newer kernels map both rings at once. */
+	if ((params.features & IORING_FEAT_SINGLE_MMAP) && uring->cq_ring_size > uring->sq_ring_size)
+		uring->sq_ring_size = uring->cq_ring_size;
+
+	uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		uring->cq_ring = uring->sq_ring;
+	else
+		uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	uring->sqes = (struct io_uring_sqe*)mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+	if (uring->sq_ring == MAP_FAILED || uring->cq_ring == MAP_FAILED || uring->sqes == MAP_FAILED) {
+		uring_unmap(uring);
+		close(fd);
+		free(uring);
+		return NULL;
+	}
+
+	sq = (char*)uring->sq_ring;
+	cq = (char*)uring->cq_ring;
+	uring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+	uring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+	uring->sq_array = (unsigned*)(sq + params.sq_off.array);
+	uring->cq_head = (unsigned*)(cq + params.cq_off.head);
+	uring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+	uring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+	uring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+	uring->pending = 0;
+	uring->is_broken = FALSE;
+
+	return uring;
+}
+
+/* The next submission of the phase, the caller never prepares more than 'entries' at once. */
+static struct io_uring_sqe* uring_get_sqe(UringIO* uring, int user_data)
+{
+	unsigned tail = *uring->sq_tail + uring->pending;
+	unsigned slot = tail & *uring->sq_mask;
+	struct io_uring_sqe* sqe = &uring->sqes[slot];
+
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->user_data = (__u64)user_data;
+	uring->sq_array[slot] = slot;
+	uring->pending++;
+
+	return sqe;
+}
+
+/* Submits the prepared phase and waits for all of it, 'results' receives the result of every submission by its user data. */
+static bool uring_submit_and_wait(UringIO* uring, int* results)
+{
+	unsigned count = uring->pending, submitted = 0, completed = 0, head, tail;
+	struct io_uring_cqe* cqe;
+	int ret;
+
+	/* The kernel reads the submissions once it sees the new tail. */
+	__atomic_store_n(uring->sq_tail, *uring->sq_tail + count, __ATOMIC_RELEASE);
+	uring->pending = 0;
+
+	while (completed < count) {
+		ret = uring_enter(uring->fd, count - submitted, count - completed, IORING_ENTER_GETEVENTS);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			uring->is_broken = TRUE;
+			return FALSE;
+		}
+		submitted += (unsigned)ret;
+
+		head = *uring->cq_head;
+		tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++, completed++) {
+			cqe = &uring->cqes[head & *uring->cq_mask];
+			results[cqe->user_data] = cqe->res;
+		}
+		__atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	return TRUE;
+}
+
+/* Closes the files of a batch that were opened, a file whose close fails is reported by 'results'. */
+static void uring_close_files(UringIO* uring, uringFile* states, int* results, int count)
+{
+	struct io_uring_sqe* sqe;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		results[i] = 0;
+		if (states[i].fd < 0)
+			continue;
+
+		if (uring->is_broken) {
+			results[i] = (close(states[i].fd) == 0) ? 0 : -errno;
+			continue;
+		}
+
+		sqe = uring_get_sqe(uring, i);
+		sqe->opcode = IORING_OP_CLOSE;
+		sqe->fd = states[i].fd;
+	}
+
+	if (uring->pending > 0)
+		uring_submit_and_wait(uring, results);
+}
+
+/* Reads the rest of a short read. */
+static bool finish_read(int fd, char* data, size_t size, size_t* done)
+{
+	ssize_t ret;
+
+	while (*done < size) {
+		ret = pread(fd, data + *done, size - *done, (off_t)*done);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret < 0)
+			return FALSE;
+		if (ret == 0)
+			break;
+		*done += (size_t)ret;
+	}
+
+	return TRUE;
+}
+
+/* Writes the rest of a short write. */
+static bool finish_write(int fd, char* data, size_t size, size_t done)
+{
+	ssize_t ret;
+
+	while (done < size) {
+		ret = pwrite(fd, data + done, size - done, (off_t)done);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return FALSE;
+		done += (size_t)ret;
+	}
+
+	return TRUE;
+}
+
+/* Reads at most 'entries' / 2 files, every file takes an open and a statx at once. */
+static int uring_read_chunk(UringIO* uring, FileBuffer* files, uringFile* states, int* results, int count)
+{
+	struct io_uring_sqe* sqe;
+	size_t done;
+	int i, read_count = 0;
+
+	for (i = 0; i < count; i++) {
+		files[i].is_done = FALSE;
+		files[i].data = NULL;
+		states[i].fd = -1;
+
+		sqe = uring_get_sqe(uring, 2 * i);
+		sqe->opcode = IORING_OP_OPENAT;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (__u64)(unsigned long)files[i].path;
+		sqe->open_flags = O_RDONLY;
+
+		sqe = uring_get_sqe(uring, 2 * i + 1);
+		sqe->opcode = IORING_OP_STATX;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (__u64)(unsigned long)files[i].path;
+		sqe->len = STATX_SIZE;
+		sqe->off = (__u64)(unsigned long)&states[i].st;
+	}
+	if (!uring_submit_and_wait(uring, results))
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		states[i].fd = results[2 * i];
+		if (states[i].fd < 0 || results[2 * i + 1] < 0)
+			continue;
+
+		files[i].size = (size_t)states[i].st.stx_size;
+		files[i].data = (char*)xmalloc(files[i].size + 1);
+		results[i] = 0;
+		if (files[i].size == 0)
+			continue;
+
+		sqe = uring_get_sqe(uring, i);
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = states[i].fd;
+		sqe->addr = (__u64)(unsigned long)files[i].data;
+		sqe->len = (__u32)files[i].size;
+		sqe->off = 0;
+	}
+	if (uring->pending > 0 && !uring_submit_and_wait(uring, results))
+		uring->is_broken = TRUE;
+
+	for (i = 0; i < count; i++) {
+		if (!files[i].data)
+			continue;
+
+		/* A file that shrank since the statx is read up to its end. */
+		done = (results[i] > 0) ? (size_t)results[i] : 0;
+		if (!uring->is_broken && results[i] >= 0 && finish_read(states[i].fd, files[i].data, files[i].size, &done)) {
+			files[i].size = done;
+			files[i].is_done = TRUE;
+			read_count++;
+		}
+		else {
+			free(files[i].data);
+			files[i].data = NULL;
+		}
+	}
+
+	uring_close_files(uring, states, results, count);
+	return read_count;
+}
+
+/* Writes at most 'entries' files. */
+static int uring_write_chunk(UringIO* uring, FileBuffer* files, uringFile* states, int* results, int count)
+{
+	struct io_uring_sqe* sqe;
+	int i, written_count = 0;
+
+	for (i = 0; i < count; i++) {
+		files[i].is_done = FALSE;
+		states[i].fd = -1;
+
+		sqe = uring_get_sqe(uring, i);
+		sqe->opcode = IORING_OP_OPENAT;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (__u64)(unsigned long)files[i].path;
+		sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+		sqe->len = URING_IO_FILE_MODE;
+	}
+	if (!uring_submit_and_wait(uring, results))
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		states[i].fd = results[i];
+		states[i].result = 0;
+		if (states[i].fd < 0 || files[i].size == 0)
+			continue;
+
+		sqe = uring_get_sqe(uring, i);
+		sqe->opcode = IORING_OP_WRITE;
+		sqe->fd = states[i].fd;
+		sqe->addr = (__u64)(unsigned long)files[i].data;
+		sqe->len = (__u32)files[i].size;
+		sqe->off = 0;
+	}
+	if (uring->pending > 0 && !uring_submit_and_wait(uring, results))
+		uring->is_broken = TRUE;
+
+	for (i = 0; i < count; i++) {
+		if (states[i].fd < 0)
+			continue;
+
+		if (files[i].size > 0)
+			states[i].result = (!uring->is_broken && results[i] >= 0 &&
+			                    finish_write(states[i].fd, files[i].data, files[i].size, (size_t)results[i])) ? 0 : -1;
+	}
+
+	/* A failed close may lose the contents too, the same as a failed fclose. */
+	uring_close_files(uring, states, results, count);
+	for (i = 0; i < count; i++) {
+		if (states[i].fd >= 0 && states[i].result == 0 && results[i] == 0) {
+			files[i].is_done = TRUE;
+			written_count++;
+		}
+	}
+
+	return written_count;
+}
+
+static int uring_run(UringIO* uring, FileBuffer* files, int count, bool is_read)
+{
+	int chunk_size = is_read ? (int)uring->entries / 2 : (int)uring->entries;
+	uringFile* states = (uringFile*)xcalloc(chunk_size, sizeof(uringFile));
+	int* results = (int*)xcalloc(uring->entries, sizeof(int));
+	int i, chunk, done = 0;
+
+	for (i = 0; i < count; i++)
+		files[i].is_done = FALSE;
+
+	for (i = 0; i < count && !uring->is_broken; i += chunk) {
+		chunk = (count - i < chunk_size) ? count - i : chunk_size;
+		done += is_read ? uring_read_chunk(uring, files + i, states, results, chunk) :
+		                  uring_write_chunk(uring, files + i, states, results, chunk);
+	}
+
+	free(results);
+	free(states);
+	return done;
+}
+
+int uring_io_read_files(UringIO* uring, FileBuffer* files, int count)
+{
+	return uring_run(uring, files, count, TRUE);
+}
+
+int uring_io_write_files(UringIO* uring, FileBuffer* files, int count)
+{
+	return uring_run(uring, files, count, FALSE);
+}
+
+void uring_io_destroy(UringIO** uring)
+{
+	uring_unmap(*uring);
+	close((*uring)->fd);
+	free(*uring);
+}
+
+#else
+
+/* Only Linux has io_uring, the batches keep the stdio path. */
+UringIO* uring_io_new()
+{
+	return NULL;
+}
+
+int uring_io_read_files(UringIO* uring, FileBuffer* files, int count)
+{
+	return 0;
+}
+
+int uring_io_write_files(UringIO* uring, FileBuffer* files, int count)
+{
+	return 0;
+}
+
+void uring_io_destroy(UringIO** uring)
+{
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef URING_IO_H
+#define URING_IO_H
+
+/** @file
+*	This header declares the batched file I/O of a batch, it opens, reads and writes many small files with a few system calls on Linux io_uring.
+*   The opens of all the files are submitted at once, then all the reads (or the writes), then all the closes, instead of several calls per file.
+*   io_uring is optional: where it's missing (an old kernel, a sandbox or another system) uring_io_new fails and the caller keeps the stdio path,
+*   and a single file that fails here is left for the stdio path to read, write or report.
+*   A uring belongs to a single thread, it's not locked.
+*/
+
+#include "utils.h"
+#include "file_store.h"
+
+/**
+* @brief A forward declaration of the uring, declaration in the '.c' file.
+*/
+typedef struct uringIO UringIO;
+
+/**
+* @brief This function creates a new uring.
+* @return A new uring, NULL if io_uring isn't available.
+*/
+UringIO* uring_io_new();
+
+/**
+* @brief This function reads whole files.
+* @param uring - The uring.
+* @param files - The files, the path of every file is set. The contents of a file that is read are allocated with one extra byte, the caller frees them.
+* @param count - The amount of files.
+* @return The amount of files that were read, every file that was read is marked done.
+*/
+int uring_io_read_files(UringIO* uring, FileBuffer* files, int count);
+
+/**
+* @brief This function creates (or truncates) files and writes their contents.
+* @param uring - The uring.
+* @param files - The files.
+* @param count - The amount of files.
+* @return The amount of files that were written, every file that was written is marked done.
+*/
+int uring_io_write_files(UringIO* uring, FileBuffer* files, int count);
+
+/**
+* @brief This function frees a uring.
+* @param uring - The uring to free.
+*/
+void uring_io_destroy(UringIO** uring);
+
+#endif
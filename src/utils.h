@@ -81,7 +81,7 @@ char* get_outfile_name(char* path, char* postfix);
 
 
 /**
-* @brief Opens a file for reading. If there is an error the program exits with EXIT_FAILURE. This is a wrapper around fopen ( 3 )
+* @brief Opens a file. This is a wrapper around fopen ( 3 ), nothing is printed on failure, the caller reports it.
 *
 * @param path - The path to the file to open
 * @param mode - The mode to open the file with
@@ -91,15 +91,6 @@ char* get_outfile_name(char* path, char* postfix);
 FILE* open_file(char* path, char* mode);
 
 
-/**
-* @brief Read a line from a file. This is used to read the source file from the command line.
-*
-* @param in - Pointer to the file to read from. Must be open for reading.
-*
-* @return A pointer to the line read or NULL if there was no line to read from the file. The caller is responsible for freeing the buffer
-*/
-char* get_line(FILE* in);
-
 /**
 * @brief Copy a string to a new memory block. The copy is allocated in xcalloc () so you must free it yourself before using it.
 *
@@ -118,13 +109,6 @@ char* get_copy_string(char* str);
 */
 bool is_line_only_blanks(char* line);
 
-/**
-* @brief Get number from string. This is used to parse numbers that are stored in the DB. The format is " %u "
-*
-* @param num
-*/
-unsigned int get_num(char* num);
-
 /*
 * @brief This function check if a file is empty.
 * @param fHandle The file pointer.
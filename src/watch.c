@@ -0,0 +1,376 @@
+/* inotify and poll are not part of C90, the GNU names are needed for them. */
+#define _GNU_SOURCE
+
+#include "watch.h"
+#include "pre_assembler.h"
+
+#ifdef __linux__
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+/* A save either writes the source in place or renames a new file over it. */
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO)
+/* The events of a save are collected until none came for this long. */
+#define WATCH_QUIET_MS 5
+#define WATCH_EVENTS_BUFFER_SIZE 65536
+#define WATCH_CURRENT_DIR "."
+#define WATCH_PATH_SEPARATOR '/'
+#define WATCH_MISSING_SIZE -1L
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
+#define FNV_MASK 0xFFFFFFFFUL
+
+/* A source, or a file that the sources include. */
+typedef struct
+{
+	char* name; /* The name of a source as it was given, the path of an included file. */
+	char* base; /* The name of the file inside its directory, the name inotify reports. */
+	int wd; /* The watch of its directory, -1 if the directory couldn't be watched. */
+	unsigned long hash; /* The contents the last time the file was seen, the hash and the size together. */
+	long size;
+	bool is_pending; /* An event was reported for the file and it wasn't read since. */
+	bool is_changed; /* The contents differ from the last time, only while the changes are collected. */
+	bool is_include;
+	int* includes; /* The indexes of the files the source includes, as it included them the last time it was read. */
+	int includes_count;
+} watchedSource;
+
+struct watcher
+{
+	int fd;
+	watchedSource* sources; /* The sources in the order they were given, then the files they include. */
+	int sources_count;
+	int count;
+	int phy_sz;
+	watchedSource** lookup; /* The files ordered by their watch and name, the events are matched by a binary search. */
+	char* contents; /* The last contents that were read, the buffer is reused for every source. */
+	size_t contents_size;
+	int events[WATCH_EVENTS_BUFFER_SIZE / sizeof(int)]; /* Ints, the events are aligned as their fields. */
+};
+
+static int compare_sources(const void* a, const void* b)
+{
+	watchedSource* first = *(watchedSource**)a, *second = *(watchedSource**)b;
+
+	if (first->wd != second->wd)
+		return (first->wd < second->wd) ? -1 : 1;
+
+	return strcmp(first->base, second->base);
+}
+
+/* Reads a source into the reused buffer and hashes it (FNV-1a), the size is WATCH_MISSING_SIZE if it can't be read. */
+static void read_source(Watcher* watcher, char* path, unsigned long* hash, long* size)
+{
+	FILE* in = open_file(path, MODE_READ);
+	size_t i;
+
+	*hash = FNV_OFFSET_BASIS;
+	*size = WATCH_MISSING_SIZE;
+	if (!in)
+		return;
+
+	fseek(in, 0, SEEK_END);
+	*size = ftell(in);
+	rewind(in);
+
+	if (*size < 0) {
+		*size = WATCH_MISSING_SIZE;
+		fclose(in);
+		return;
+	}
+
+	if ((size_t)*size + 1 > watcher->contents_size) {
+		watcher->contents_size = (size_t)*size + 1;
+		watcher->contents = GROW_ARRAY(char*, watcher->contents, watcher->contents_size, sizeof(char));
+	}
+
+	*size = (long)fread(watcher->contents, sizeof(char), (size_t)*size, in);
+	fclose(in);
+
+	for (i = 0; i < (size_t)*size; i++)
+		*hash = ((*hash ^ (unsigned char)watcher->contents[i]) * FNV_PRIME) & FNV_MASK;
+}
+
+/* Returns the path of a file, a source is named without its extension. The path is freed by the caller. */
+static char* get_source_path(watchedSource* source)
+{
+	return source->is_include ? get_copy_string(source->name) : get_outfile_name(source->name, SRC_ASSEMBLER_FILE_EXTENSTION);
+}
+
+/* Splits the path of a file into its directory and its name, and watches the directory. A directory that is watched already returns the same watch. */
+static void watch_source(Watcher* watcher, watchedSource* source)
+{
+	char* path = get_source_path(source);
+	char* separator = strrchr(path, WATCH_PATH_SEPARATOR);
+
+	if (!separator) {
+		source->base = get_copy_string(path);
+		source->wd = inotify_add_watch(watcher->fd, WATCH_CURRENT_DIR, WATCH_EVENTS);
+	}
+	else {
+		source->base = get_copy_string(separator + 1);
+		/* The root directory keeps its separator. */
+		*(separator == path ? separator + 1 : separator) = BACKSLASH_ZERO;
+		source->wd = inotify_add_watch(watcher->fd, path, WATCH_EVENTS);
+		*(separator == path ? separator + 1 : separator) = WATCH_PATH_SEPARATOR;
+	}
+
+	read_source(watcher, path, &source->hash, &source->size);
+	free(path);
+}
+
+/* Orders the files again, after files were added. */
+static void sort_sources(Watcher* watcher)
+{
+	int i;
+
+	watcher->lookup = GROW_ARRAY(watchedSource**, watcher->lookup, watcher->count, sizeof(watchedSource*));
+	for (i = 0; i < watcher->count; i++)
+		watcher->lookup[i] = &watcher->sources[i];
+
+	qsort(watcher->lookup, watcher->count, sizeof(watchedSource*), compare_sources);
+}
+
+/* Returns the index of an included file, it's watched from now on if no source included it before. */
+static int add_include(Watcher* watcher, char* path)
+{
+	watchedSource* include;
+	int i;
+
+	for (i = watcher->sources_count; i < watcher->count; i++)
+		if (strcmp(watcher->sources[i].name, path) == 0)
+			return i;
+
+	if (watcher->count + 1 >= watcher->phy_sz) {
+		GROW_CAPACITY(watcher->phy_sz);
+		watcher->sources = GROW_ARRAY(watchedSource*, watcher->sources, watcher->phy_sz, sizeof(watchedSource));
+	}
+
+	include = &watcher->sources[watcher->count];
+	memset(include, 0, sizeof(watchedSource));
+	include->name = get_copy_string(path);
+	include->is_include = TRUE;
+	watch_source(watcher, include);
+
+	return watcher->count++;
+}
+
+/* Reads the files a source includes, the files that weren't watched yet are added. Returns FALSE if no file was added. */
+static bool list_includes(Watcher* watcher, int index)
+{
+	char* path = get_source_path(&watcher->sources[index]), ** paths = NULL;
+	FILE* in = open_file(path, MODE_READ);
+	int i, count = 0, watched_count = watcher->count;
+
+	if (in) {
+		paths = pre_assembler_list_includes(in, path, &count);
+		fclose(in);
+	}
+
+	free(watcher->sources[index].includes);
+	watcher->sources[index].includes = (int*)xcalloc(count + 1, sizeof(int));
+	watcher->sources[index].includes_count = count;
+
+	/* The sources may move while the files are added, they are reached by their index. */
+	for (i = 0; i < count; i++) {
+		watcher->sources[index].includes[i] = add_include(watcher, paths[i]);
+		free(paths[i]);
+	}
+
+	free(paths);
+	free(path);
+	return watcher->count > watched_count;
+}
+
+Watcher* watcher_new(char** files, int count)
+{
+	Watcher* watcher;
+	int fd = inotify_init1(IN_CLOEXEC), i;
+	bool is_watching = FALSE;
+
+	if (fd < 0)
+		return NULL;
+
+	watcher = (Watcher*)xcalloc(1, sizeof(Watcher));
+	watcher->fd = fd;
+	watcher->sources_count = watcher->count = count;
+	watcher->phy_sz = count + INIT_PHY_SZ;
+	watcher->sources = (watchedSource*)xcalloc(watcher->phy_sz, sizeof(watchedSource));
+	watcher->contents_size = INIT_PHY_SZ;
+	watcher->contents = (char*)xcalloc(watcher->contents_size, sizeof(char));
+
+	for (i = 0; i < count; i++) {
+		watcher->sources[i].name = files[i];
+		watch_source(watcher, &watcher->sources[i]);
+		if (watcher->sources[i].wd >= 0)
+			is_watching = TRUE;
+	}
+
+	/* Nothing would ever be reported. */
+	if (!is_watching) {
+		watcher_destroy(&watcher);
+		return NULL;
+	}
+
+	for (i = 0; i < count; i++)
+		list_includes(watcher, i);
+
+	sort_sources(watcher);
+	return watcher;
+}
+
+static void mark_source(Watcher* watcher, int wd, char* name)
+{
+	watchedSource key, *key_ptr = &key, **found, **end = watcher->lookup + watcher->count;
+
+	key.wd = wd;
+	key.base = name;
+	if (!(found = (watchedSource**)bsearch(&key_ptr, watcher->lookup, watcher->count, sizeof(watchedSource*), compare_sources)))
+		return;
+
+	/* A source may also be included by another one, every entry of the file is marked. */
+	while (found > watcher->lookup && compare_sources(found - 1, &key_ptr) == 0)
+		found--;
+	for (; found < end && compare_sources(found, &key_ptr) == 0; found++)
+		(*found)->is_pending = TRUE;
+}
+
+/* Reads the events that are queued, blocking until there is one. Returns FALSE if inotify failed. */
+static bool read_events(Watcher* watcher)
+{
+	char* bytes = (char*)watcher->events, *at;
+	struct inotify_event* event;
+	ssize_t length;
+	int i;
+
+	while ((length = read(watcher->fd, bytes, sizeof(watcher->events))) < 0)
+		if (errno != EINTR)
+			return FALSE;
+
+	for (at = bytes; at < bytes + length; at += sizeof(struct inotify_event) + event->len) {
+		event = (struct inotify_event*)at;
+
+		/* Events were dropped, any source may have changed. */
+		if (event->mask & IN_Q_OVERFLOW) {
+			for (i = 0; i < watcher->count; i++)
+				watcher->sources[i].is_pending = TRUE;
+		}
+		else if (event->len > 0) {
+			mark_source(watcher, event->wd, event->name);
+		}
+	}
+
+	return length > 0;
+}
+
+/* Reads the files that had events, the ones whose contents differ are changed. A source is changed when it or a file it includes is,
+*  a source that changed is read for its includes again. A file that is missing now is compared again once it's back. */
+static int collect_changed(Watcher* watcher, char** changed)
+{
+	watchedSource* source;
+	unsigned long hash;
+	char* path;
+	long size;
+	int i, j, count = 0;
+	bool is_changed, is_added = FALSE;
+
+	for (i = 0; i < watcher->count; i++) {
+		source = &watcher->sources[i];
+		if (!source->is_pending)
+			continue;
+
+		source->is_pending = FALSE;
+		path = get_source_path(source);
+		read_source(watcher, path, &hash, &size);
+		free(path);
+
+		if (size != WATCH_MISSING_SIZE && (size != source->size || hash != source->hash)) {
+			source->hash = hash;
+			source->size = size;
+			source->is_changed = TRUE;
+		}
+	}
+
+	for (i = 0; i < watcher->sources_count; i++) {
+		is_changed = watcher->sources[i].is_changed;
+		for (j = 0; j < watcher->sources[i].includes_count; j++)
+			is_changed |= watcher->sources[watcher->sources[i].includes[j]].is_changed;
+
+		if (watcher->sources[i].is_changed && list_includes(watcher, i))
+			is_added = TRUE;
+		if (is_changed)
+			changed[count++] = watcher->sources[i].name;
+	}
+
+	for (i = 0; i < watcher->count; i++)
+		watcher->sources[i].is_changed = FALSE;
+	if (is_added)
+		sort_sources(watcher);
+
+	return count;
+}
+
+int watcher_wait(Watcher* watcher, char** changed)
+{
+	struct pollfd poll_fd;
+	int count, ready;
+
+	poll_fd.fd = watcher->fd;
+	poll_fd.events = POLLIN;
+
+	for (;;) {
+		if (!read_events(watcher))
+			return -1;
+
+		/* The rest of the burst. */
+		while ((ready = poll(&poll_fd, 1, WATCH_QUIET_MS)) != 0) {
+			if (ready < 0 && errno == EINTR)
+				continue;
+			if (ready < 0 || !read_events(watcher))
+				return -1;
+		}
+
+		if ((count = collect_changed(watcher, changed)) > 0)
+			return count;
+	}
+}
+
+void watcher_destroy(Watcher** watcher)
+{
+	int i;
+
+	for (i = 0; i < (*watcher)->count; i++) {
+		free((*watcher)->sources[i].base);
+		free((*watcher)->sources[i].includes);
+		if ((*watcher)->sources[i].is_include)
+			free((*watcher)->sources[i].name);
+	}
+
+	close((*watcher)->fd);
+	free((*watcher)->sources);
+	free((*watcher)->lookup);
+	free((*watcher)->contents);
+	free(*watcher);
+	*watcher = NULL;
+}
+
+#else
+
+Watcher* watcher_new(char** files, int count)
+{
+	return NULL;
+}
+
+int watcher_wait(Watcher* watcher, char** changed)
+{
+	return -1;
+}
+
+void watcher_destroy(Watcher** watcher)
+{
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+/** @file
+*	This header declares the watcher of the watch mode, it waits for the sources to change on Linux inotify.
+*   The directories of the sources are watched rather than every source, so a few watches cover thousands of files,
+*   and a source that an editor saves by renaming a new file over it is still seen. A source only counts as changed when its contents differ
+*   from the last time it was seen, a save that didn't change anything or a touch is ignored.
+*   The files a source includes are watched too, a source counts as changed when a file it includes changed. The includes of a source are read
+*   again whenever it changed.
+*   A watcher belongs to a single thread, it's not locked.
+*/
+
+#include "utils.h"
+
+/**
+* @brief A forward declaration of the watcher, declaration in the '.c' file.
+*/
+typedef struct watcher Watcher;
+
+/**
+* @brief This function starts watching sources and the files they include, their current contents are what later changes are compared with.
+* @param files - The names of the sources, with or without the '.as' extension, the watcher keeps the pointers.
+* @param count - The amount of sources.
+* @return A new watcher, NULL if inotify isn't available or none of the directories of the sources can be watched.
+*/
+Watcher* watcher_new(char** files, int count);
+
+/**
+* @brief This function waits until the contents of at least one source changed. The events of a save come in bursts,
+* they are collected until the sources were quiet for a few milliseconds, so a source is reported once per save.
+* @param watcher - The watcher.
+* @param changed - Receives the names of the changed sources and of the sources that include a changed file, in the order they were given to
+* watcher_new. It must fit all of them.
+* @return The amount of changed sources, -1 if the sources can't be watched anymore.
+*/
+int watcher_wait(Watcher* watcher, char** changed);
+
+/**
+* @brief This function frees a watcher.
+* @param watcher - The watcher to free.
+*/
+void watcher_destroy(Watcher** watcher);
+
+#endif
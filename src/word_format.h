@@ -0,0 +1,74 @@
+#ifndef WORD_FORMAT_H
+#define WORD_FORMAT_H
+
+/** @file
+*	This header describes the format of a machine word, once. The encoder builds the words from its fields, the images keep a word in as many
+*   bytes as it takes, and the object writers print and pack as many bits. Every shift and mask is an integer constant, so a build folds them
+*   and nothing branches on the format at runtime.
+*   The 14 bit machine is the default. A build for another machine of the family passes a spec header that defines the same names:
+*       make WORD_FORMAT_FLAGS='-DWORD_FORMAT_SPEC=\"word_format_16.h\"'
+*/
+
+#ifdef WORD_FORMAT_SPEC
+#include WORD_FORMAT_SPEC
+#else
+
+/**
+* @brief The width of a word in bits.
+*/
+#define WORD_FORMAT_BITS 14
+
+/**
+* @brief The fields of the words, X(name, shift, width), from the lowest bit up.
+* The first word of an instruction holds the E.R.A, the addressings of the operands, the opcode and the addressings of the parameters of a jump:
+*
+*  Param2 | Param 1 | Opcode | Dest Operand | Source Operand | E.R.A
+* ---------------------------------------------------------------------
+* | 2 bits | 2 bits | 4 bits |     2 bits   |      2 bits    | 2 bits |
+* ---------------------------------------------------------------------
+*
+* An extra word holds the E.R.A and either a value (an immediate or an address) or the registers of the operands.
+*/
+#define WORD_FORMAT_FIELDS(X) \
+	X(ERA, 0, 2) \
+	X(DEST, 2, 2) \
+	X(SOURCE, 4, 2) \
+	X(OPCODE, 6, 4) \
+	X(PARAM1, 10, 2) \
+	X(PARAM2, 12, 2) \
+	X(VALUE, 2, 12) \
+	X(REG_DEST, 2, 6) \
+	X(REG_SOURCE, 8, 6)
+
+#endif
+
+#define WORD_FORMAT_BYTE_BITS 8
+#define WORD_FORMAT_BYTES ((WORD_FORMAT_BITS + WORD_FORMAT_BYTE_BITS - 1) / WORD_FORMAT_BYTE_BITS)
+#define WORD_FORMAT_MASK ((1U << WORD_FORMAT_BITS) - 1U)
+
+/* The shift and the width of every field, i.e WORD_SHIFT_OPCODE and WORD_WIDTH_OPCODE. */
+#define WORD_FORMAT_SHIFT_OF(name, shift, width) WORD_SHIFT_##name = (shift),
+#define WORD_FORMAT_WIDTH_OF(name, shift, width) WORD_WIDTH_##name = (width),
+enum { WORD_FORMAT_FIELDS(WORD_FORMAT_SHIFT_OF) WORD_SHIFT_END };
+enum { WORD_FORMAT_FIELDS(WORD_FORMAT_WIDTH_OF) WORD_WIDTH_END };
+
+/* A field that doesn't fit in the word fails the build. */
+#define WORD_FORMAT_CHECK_FIELD(name, shift, width) typedef char word_format_field_fits_##name[((shift) + (width) <= WORD_FORMAT_BITS) ? 1 : -1];
+WORD_FORMAT_FIELDS(WORD_FORMAT_CHECK_FIELD)
+
+/**
+* @brief The mask of a field in the word.
+*/
+#define WORD_FIELD_MASK(name) (((1U << WORD_WIDTH_##name) - 1U) << WORD_SHIFT_##name)
+
+/**
+* @brief A value in its field, the bits that don't fit are dropped (a negative value keeps its two's complement bits).
+*/
+#define WORD_FIELD(name, value) (((unsigned int)(value) << WORD_SHIFT_##name) & WORD_FIELD_MASK(name))
+
+/**
+* @brief The value of a field of a word.
+*/
+#define WORD_FIELD_GET(name, word) (((word) & WORD_FIELD_MASK(name)) >> WORD_SHIFT_##name)
+
+#endif
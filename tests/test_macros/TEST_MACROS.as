@@ -0,0 +1,24 @@
+; Parameterised, nested and included macros.
+.include "macros_lib.as"
+.entry L1
+.extern PRINT
+mcr m_say label
+label: .string "label"
+endmcr
+mcr m_add_twice dst, src
+ add src, dst
+ add src, dst
+endmcr
+mcr m_reset dst
+ m_clear dst
+ m_add_twice dst, #3
+endmcr
+MAIN: mov #10, r1
+m_add_twice r1, r2
+m_reset r3
+m_push r1
+ jsr PRINT
+ prn r3
+ bne L1(#-1,r6)
+m_say MSG
+L1: stop
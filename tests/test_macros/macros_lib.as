@@ -0,0 +1,9 @@
+; Macros shared by the sources that include this file.
+mcr m_push reg
+ mov reg, STACK
+ inc STACK
+endmcr
+mcr m_clear x
+ clr x
+endmcr
+STACK: .data 0
@@ -0,0 +1,223 @@
+; Every error of the macros and the includes.
+.include "macros_lib.as"
+.include macros_lib.as
+.include "missing.as"
+.include "nested_lib.as"
+mcr m_self
+ inc r1
+m_self
+endmcr
+mcr m_bad mov, r1
+ prn #1
+endmcr
+mcr m_twice x, x
+ prn x
+endmcr
+mcr m_add dst, src
+ add src, dst
+endmcr
+mcr m_deep0
+ inc r2
+endmcr
+mcr m_deep1
+m_deep0
+endmcr
+mcr m_deep2
+m_deep1
+endmcr
+mcr m_deep3
+m_deep2
+endmcr
+mcr m_deep4
+m_deep3
+endmcr
+mcr m_deep5
+m_deep4
+endmcr
+mcr m_deep6
+m_deep5
+endmcr
+mcr m_deep7
+m_deep6
+endmcr
+mcr m_deep8
+m_deep7
+endmcr
+mcr m_deep9
+m_deep8
+endmcr
+mcr m_deep10
+m_deep9
+endmcr
+mcr m_deep11
+m_deep10
+endmcr
+mcr m_deep12
+m_deep11
+endmcr
+mcr m_deep13
+m_deep12
+endmcr
+mcr m_deep14
+m_deep13
+endmcr
+mcr m_deep15
+m_deep14
+endmcr
+mcr m_deep16
+m_deep15
+endmcr
+mcr m_deep17
+m_deep16
+endmcr
+mcr m_deep18
+m_deep17
+endmcr
+mcr m_deep19
+m_deep18
+endmcr
+mcr m_deep20
+m_deep19
+endmcr
+mcr m_deep21
+m_deep20
+endmcr
+mcr m_deep22
+m_deep21
+endmcr
+mcr m_deep23
+m_deep22
+endmcr
+mcr m_deep24
+m_deep23
+endmcr
+mcr m_deep25
+m_deep24
+endmcr
+mcr m_deep26
+m_deep25
+endmcr
+mcr m_deep27
+m_deep26
+endmcr
+mcr m_deep28
+m_deep27
+endmcr
+mcr m_deep29
+m_deep28
+endmcr
+mcr m_deep30
+m_deep29
+endmcr
+mcr m_deep31
+m_deep30
+endmcr
+mcr m_deep32
+m_deep31
+endmcr
+mcr m_deep33
+m_deep32
+endmcr
+mcr m_deep34
+m_deep33
+endmcr
+mcr m_deep35
+m_deep34
+endmcr
+mcr m_deep36
+m_deep35
+endmcr
+mcr m_deep37
+m_deep36
+endmcr
+mcr m_deep38
+m_deep37
+endmcr
+mcr m_deep39
+m_deep38
+endmcr
+mcr m_deep40
+m_deep39
+endmcr
+mcr m_deep41
+m_deep40
+endmcr
+mcr m_deep42
+m_deep41
+endmcr
+mcr m_deep43
+m_deep42
+endmcr
+mcr m_deep44
+m_deep43
+endmcr
+mcr m_deep45
+m_deep44
+endmcr
+mcr m_deep46
+m_deep45
+endmcr
+mcr m_deep47
+m_deep46
+endmcr
+mcr m_deep48
+m_deep47
+endmcr
+mcr m_deep49
+m_deep48
+endmcr
+mcr m_deep50
+m_deep49
+endmcr
+mcr m_deep51
+m_deep50
+endmcr
+mcr m_deep52
+m_deep51
+endmcr
+mcr m_deep53
+m_deep52
+endmcr
+mcr m_deep54
+m_deep53
+endmcr
+mcr m_deep55
+m_deep54
+endmcr
+mcr m_deep56
+m_deep55
+endmcr
+mcr m_deep57
+m_deep56
+endmcr
+mcr m_deep58
+m_deep57
+endmcr
+mcr m_deep59
+m_deep58
+endmcr
+mcr m_deep60
+m_deep59
+endmcr
+mcr m_deep61
+m_deep60
+endmcr
+mcr m_deep62
+m_deep61
+endmcr
+mcr m_deep63
+m_deep62
+endmcr
+mcr m_deep64
+m_deep63
+endmcr
+MAIN: mov #1, r1
+m_clear r1
+m_self
+m_bad
+m_twice 1, 2
+m_add r1
+m_add r1, r2, r3
+m_deep63
+m_deep64
+ stop
@@ -0,0 +1,3 @@
+mcr m_clear x
+ clr x
+endmcr
@@ -0,0 +1,2 @@
+; An included file can't include other files.
+.include "macros_lib.as"